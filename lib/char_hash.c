@@ -28,24 +28,68 @@
 #include "uniquestr.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <limits.h>
 #include <string.h>
-#include <math.h>
 
 #include "mem.h"
 
-typedef struct string_link_tag string_link_t;
+// String table
+//
+// Strings are kept in an open addressing table (linear probing) that grows
+// when it becomes too loaded. The table is split in shards, selected by the
+// upper bits of the hash, so growing only rehashes the strings of one shard.
+//
+// Every string is stored once, along with its hash and its length, in memory
+// taken from a bump arena owned by its shard. Strings are never freed.
 
-struct string_link_tag
+typedef struct string_entry_tag
 {
-    unsigned int hash;
-    const char *string;
-    string_link_t *next;
+    uint32_t hash;
+    uint32_t length;
+    char string[];
+} string_entry_t;
+
+typedef struct string_slot_tag
+{
+    uint32_t hash;
+    string_entry_t* entry;
+} string_slot_t;
+
+typedef struct string_table_tag
+{
+    uint32_t capacity; // always a power of two
+    string_slot_t slots[];
+} string_table_t;
+
+typedef struct arena_chunk_tag
+{
+    struct arena_chunk_tag* previous;
+    size_t size;
+    size_t used;
+    char data[];
+} arena_chunk_t;
+
+typedef struct string_shard_tag
+{
+    string_table_t* table;
+    uint32_t num_strings;
+
+    arena_chunk_t* arena;
+} string_shard_t;
+
+enum
+{
+    NUM_SHARDS_LOG2 = 6,
+    NUM_SHARDS = 1 << NUM_SHARDS_LOG2,
+    INITIAL_SHARD_CAPACITY = 256,
+    ARENA_CHUNK_SIZE = 16 * 1024,
+    // Strings larger than this get their own chunk
+    ARENA_LARGE_STRING = ARENA_CHUNK_SIZE / 8,
 };
 
-enum { HASH_LENGTH = 76003 };
+static string_shard_t shards[NUM_SHARDS];
 
-static string_link_t *hash_table[HASH_LENGTH];
 static unsigned long long int bytes_used = 0;
 
 unsigned long long int char_trie_used_memory(void)
@@ -53,113 +97,261 @@ unsigned long long int char_trie_used_memory(void)
     return bytes_used;
 }
 
-static unsigned int hash_string(const char *string)
+// FNV-1a with a final avalanche so both the upper bits (used for the
+// shard) and the lower bits (used for the slot) are well distributed
+static inline uint32_t hash_string(const char *string, uint32_t *length)
 {
-    unsigned int hash = 0;
-    const char *p;
+    uint32_t hash = 2166136261u;
+    const unsigned char *p;
+
+    for (p = (const unsigned char*)string; *p; p++)
+    {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+
+    *length = (uint32_t)(p - (const unsigned char*)string);
 
-    for (p = string; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
 
     return hash;
 }
 
-const char *uniquestr(const char *string)
+static inline uint32_t slot_index(uint32_t hash, uint32_t capacity)
 {
-    if (string == NULL)
-        return NULL;
+    return hash & (capacity - 1);
+}
+
+static string_table_t* new_table(uint32_t capacity)
+{
+    size_t size = sizeof(string_table_t) + capacity * sizeof(string_slot_t);
+    string_table_t* table = (string_table_t*)xcalloc(1, size);
+    table->capacity = capacity;
+
+    bytes_used += size;
 
-    unsigned int hash = hash_string(string);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
-    string_link_t *p, *p_prev = 0, *new_link;
+    return table;
+}
+
+static string_entry_t* new_entry(string_shard_t* shard,
+        const char* string, uint32_t hash, uint32_t length)
+{
+    size_t size = sizeof(string_entry_t) + length + 1;
+    // Keep entries aligned
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
 
-    for (p = hash_table[hash_index]; p; p_prev = p, p = p->next)
+    arena_chunk_t* chunk = shard->arena;
+    if (chunk == NULL
+            || chunk->used + size > chunk->size)
     {
-        if (p->hash == hash && !strcmp(p->string, string))
-        {
-            if (p != hash_table[hash_index])
-            {
-                p_prev->next = p->next;
-                p->next = hash_table[hash_index];
-                hash_table[hash_index] = p;
-            }
+        size_t chunk_size = ARENA_CHUNK_SIZE;
+        if (size > ARENA_LARGE_STRING)
+            chunk_size = size;
+
+        arena_chunk_t* new_chunk = (arena_chunk_t*)xmalloc(sizeof(arena_chunk_t) + chunk_size);
+        new_chunk->size = chunk_size;
+        new_chunk->used = 0;
+
+        bytes_used += sizeof(arena_chunk_t) + chunk_size;
 
-            return p->string;
+        if (size > ARENA_LARGE_STRING
+                && chunk != NULL)
+        {
+            // Keep using the current chunk for small strings
+            new_chunk->previous = chunk->previous;
+            chunk->previous = new_chunk;
+        }
+        else
+        {
+            new_chunk->previous = chunk;
+            shard->arena = new_chunk;
         }
+        chunk = new_chunk;
     }
 
-    bytes_used += sizeof(string_link_t) + strlen(string) + 1;
+    string_entry_t* entry = (string_entry_t*)(chunk->data + chunk->used);
+    chunk->used += size;
 
-    new_link = NEW(string_link_t);
-    new_link->string = xstrdup(string); 
-    new_link->hash = hash; 
-    new_link->next = hash_table[hash_index];
-    hash_table[hash_index] = new_link; 
+    entry->hash = hash;
+    entry->length = length;
+    memcpy(entry->string, string, length + 1);
 
-    return new_link->string;
+    return entry;
 }
 
-void uniquestr_stats(void)
+static inline string_entry_t* lookup_in_table(string_table_t* table,
+        const char* string, uint32_t hash, uint32_t length,
+        uint32_t *free_slot)
 {
-    unsigned long long bucket_length[HASH_LENGTH];
-    unsigned long long number_of_strings = 0;
-    unsigned long long number_of_bytes = 0;
+    uint32_t mask = table->capacity - 1;
+    uint32_t i = slot_index(hash, table->capacity);
 
-    int i, j;
-    for (i = 0; i < HASH_LENGTH; i++)
+    for (;;)
     {
-        string_link_t *p = hash_table[i];
-
-        j = 0;
-        while (p != NULL)
+        string_slot_t* slot = &table->slots[i];
+        string_entry_t* entry = slot->entry;
+        if (entry == NULL)
         {
-            // fprintf(stderr, "%d.%d |%s|\n", i, j, p->string);
-            number_of_strings++;
-            number_of_bytes += strlen(p->string) + 1; // +1 for NULL
-
-            p = p->next;
-            j++;
+            *free_slot = i;
+            return NULL;
         }
 
-        bucket_length[i] = j;
+        if (slot->hash == hash
+                && entry->length == length
+                && memcmp(entry->string, string, length) == 0)
+            return entry;
+
+        i = (i + 1) & mask;
     }
+}
 
-    unsigned long long max_bucket = 0;
-    unsigned long long min_bucket = ULLONG_MAX;
-    unsigned long long sum_buckets = 0;
-    unsigned long long num_empty_buckets = 0;
+static void insert_in_table(string_table_t* table, string_entry_t* entry, uint32_t free_slot)
+{
+    string_slot_t* slot = &table->slots[free_slot];
+    slot->hash = entry->hash;
+    slot->entry = entry;
+}
 
-    for (i = 0; i < HASH_LENGTH; i++)
+static void grow_table(string_shard_t* shard)
+{
+    string_table_t* old_table = shard->table;
+    string_table_t* table = new_table(old_table->capacity * 2);
+
+    uint32_t mask = table->capacity - 1;
+    uint32_t i;
+    for (i = 0; i < old_table->capacity; i++)
     {
-        if (bucket_length[i] >= max_bucket)
-            max_bucket = bucket_length[i];
-        if (bucket_length[i] <= min_bucket)
-            min_bucket = bucket_length[i];
+        string_entry_t* entry = old_table->slots[i].entry;
+        if (entry == NULL)
+            continue;
 
-        sum_buckets += bucket_length[i];
+        uint32_t j = slot_index(entry->hash, table->capacity);
+        while (table->slots[j].entry != NULL)
+            j = (j + 1) & mask;
 
-        num_empty_buckets += (bucket_length[i] == 0);
+        table->slots[j].hash = entry->hash;
+        table->slots[j].entry = entry;
     }
 
-    float avg_bucket = 0.0f;
-    avg_bucket = ((float)sum_buckets / (float)HASH_LENGTH);
+    shard->table = table;
+
+    bytes_used -= sizeof(string_table_t) + old_table->capacity * sizeof(string_slot_t);
+    xfree(old_table);
+}
+
+const char *uniquestr(const char *string)
+{
+    if (string == NULL)
+        return NULL;
+
+    uint32_t length = 0;
+    uint32_t hash = hash_string(string, &length);
+    string_shard_t* shard = &shards[hash >> (32 - NUM_SHARDS_LOG2)];
+
+    if (shard->table == NULL)
+        shard->table = new_table(INITIAL_SHARD_CAPACITY);
 
-    float stddev_bucket = 0.0f;
-    for (i = 0; i < HASH_LENGTH; i++)
+    uint32_t free_slot = 0;
+    string_entry_t* entry = lookup_in_table(shard->table, string, hash, length, &free_slot);
+    if (entry != NULL)
+        return entry->string;
+
+    // Keep load factor below 0.75
+    if ((shard->num_strings + 1) * 4 > shard->table->capacity * 3)
     {
-        stddev_bucket += fabsf(bucket_length[i] - avg_bucket);
+        grow_table(shard);
+        // Find a free slot in the new table
+        lookup_in_table(shard->table, string, hash, length, &free_slot);
     }
-    stddev_bucket = sqrtf(stddev_bucket / (float)(HASH_LENGTH - 1));
+
+    entry = new_entry(shard, string, hash, length);
+    insert_in_table(shard->table, entry, free_slot);
+    shard->num_strings++;
+
+    return entry->string;
+}
+
+void uniquestr_stats(void)
+{
+    unsigned long long number_of_strings = 0;
+    unsigned long long number_of_bytes = 0;
+    unsigned long long number_of_slots = 0;
+    unsigned long long arena_bytes = 0;
+    unsigned long long arena_bytes_used = 0;
+
+    unsigned long long sum_probe_length = 0;
+    unsigned long long max_probe_length = 0;
+
+    float min_load_factor = 1.0f;
+    float max_load_factor = 0.0f;
+
+    int i;
+    for (i = 0; i < NUM_SHARDS; i++)
+    {
+        string_shard_t* shard = &shards[i];
+
+        string_table_t* table = shard->table;
+        if (table != NULL)
+        {
+            number_of_slots += table->capacity;
+
+            uint32_t mask = table->capacity - 1;
+            uint32_t j;
+            for (j = 0; j < table->capacity; j++)
+            {
+                string_entry_t* entry = table->slots[j].entry;
+                if (entry == NULL)
+                    continue;
+
+                number_of_strings++;
+                number_of_bytes += entry->length + 1; // +1 for NULL
+
+                // Number of slots examined to find this string
+                unsigned long long probe_length
+                    = ((j - slot_index(entry->hash, table->capacity)) & mask) + 1;
+                sum_probe_length += probe_length;
+                if (probe_length > max_probe_length)
+                    max_probe_length = probe_length;
+            }
+
+            float load_factor = (float)shard->num_strings / (float)table->capacity;
+            if (load_factor < min_load_factor)
+                min_load_factor = load_factor;
+            if (load_factor > max_load_factor)
+                max_load_factor = load_factor;
+        }
+
+        arena_chunk_t* chunk;
+        for (chunk = shard->arena; chunk != NULL; chunk = chunk->previous)
+        {
+            arena_bytes += chunk->size;
+            arena_bytes_used += chunk->used;
+        }
+    }
+
+    float load_factor = 0.0f;
+    if (number_of_slots != 0)
+        load_factor = (float)number_of_strings / (float)number_of_slots;
+
+    float avg_probe_length = 0.0f;
+    if (number_of_strings != 0)
+        avg_probe_length = (float)sum_probe_length / (float)number_of_strings;
 
     fprintf(stderr, "String table statistics\n");
     fprintf(stderr, "=======================\n\n");
 
-    fprintf(stderr, "Size of hash: %d\n", HASH_LENGTH);
+    fprintf(stderr, "Number of shards: %d\n", NUM_SHARDS);
+    fprintf(stderr, "Number of slots: %llu\n", number_of_slots);
     fprintf(stderr, "Number of strings: %llu\n", number_of_strings);
     fprintf(stderr, "Number of bytes taken by the strings: %llu\n", number_of_bytes);
-    fprintf(stderr, "Number of empty buckets: %llu\n", num_empty_buckets);
-    fprintf(stderr, "Minimum bucket length: %llu\n", min_bucket);
-    fprintf(stderr, "Maximum bucket length: %llu\n", max_bucket);
-    fprintf(stderr, "Average bucket length: %.2f\n", avg_bucket);
-    fprintf(stderr, "StdDev  bucket length: %.2f\n", stddev_bucket);
+    fprintf(stderr, "Arena bytes (used / allocated): %llu / %llu\n", arena_bytes_used, arena_bytes);
+    fprintf(stderr, "Load factor: %.2f\n", load_factor);
+    fprintf(stderr, "Minimum shard load factor: %.2f\n", min_load_factor);
+    fprintf(stderr, "Maximum shard load factor: %.2f\n", max_load_factor);
+    fprintf(stderr, "Average probe length: %.2f\n", avg_probe_length);
+    fprintf(stderr, "Maximum probe length: %llu\n", max_probe_length);
 }
@@ -25,186 +25,161 @@
 --------------------------------------------------------------------*/
 
 
+
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "dhash_ptr.h"
 #include "mem.h"
 
+// Open addressing hash keyed by pointer. Keys are compared by address (they
+// are usually uniquestr) so the key is hashed, not the string it points to.
+//
+// Most of these tables (one per scope) hold just a handful of items, so the
+// first DHASH_PTR_SMALL_SIZE items are kept in the table itself and looked up
+// linearly. Once this is not enough a power of two array with linear probing
+// is used. Removals use backward shift deletion so no tombstones are needed.
+
 typedef
-struct bucket_ptr_tag
+struct dhash_ptr_item_tag
 {
     const char* key;
     dhash_ptr_info_t info;
-    struct bucket_ptr_tag* next;
-} bucket_ptr_t;
-
-enum { MAX_BUCKET_SIZE = 76003 };
-const static int prime_set[] = { 5, 11, 23, 53, 131, 317, 787, 1951, 4877, 12163, 30403, MAX_BUCKET_SIZE };
-const static int last_prime = (sizeof(prime_set) / sizeof(prime_set[0])) - 1;
-
-#ifdef __GNUC__
-  #if __GNUC__ == 4
-     #if __GNUC_MINOR__ >= 6
-       #define STATIC_INLINE static inline
-     #else
-       // This is a workaround for GCC 4.4 generating wrong code
-       #define STATIC_INLINE static
-     #endif
-  #else
-     #define STATIC_INLINE static inline
-  #endif
-#else
-   #define STATIC_INLINE static inline
-#endif
-
-STATIC_INLINE uint32_t Murmur3_32(const char* ptr);
+} dhash_ptr_item_t;
+
+enum { DHASH_PTR_SMALL_SIZE = 4 };
+enum { DHASH_PTR_MIN_CAPACITY = 16 };
 
 struct dhash_ptr_tag
 {
-    bucket_ptr_t **buckets;
-    int num_buckets_idx;
     int num_items;
+    // Zero while items are kept in small_items
+    int capacity;
+    union
+    {
+        dhash_ptr_item_t small_items[DHASH_PTR_SMALL_SIZE];
+        dhash_ptr_item_t* items;
+    };
 };
 
-dhash_ptr_t* dhash_ptr_new(int initial_size)
+static inline uint32_t hash_ptr(const char* key)
 {
-    if (initial_size < 0) abort();
-
-    dhash_ptr_t* result = NEW(dhash_ptr_t);
+    // Fibonacci hashing. Low bits of pointers are always zero due to
+    // alignment so keep the high part of the product
+    uint64_t h = (uint64_t)(uintptr_t)key * UINT64_C(0x9E3779B97F4A7C15);
+    return (uint32_t)(h >> 32);
+}
 
-    result->num_items = 0;
+static void dhash_ptr_allocate_items(dhash_ptr_t* dhash, int capacity)
+{
+    dhash->capacity = capacity;
+    dhash->items = NEW_VEC0(dhash_ptr_item_t, capacity);
+}
 
-    if (initial_size >= MAX_BUCKET_SIZE)
+static int dhash_ptr_capacity_for(int num_items)
+{
+    int capacity = DHASH_PTR_MIN_CAPACITY;
+    // Keep the load factor below 3/4
+    while ((capacity / 4) * 3 <= num_items)
     {
-        result->num_buckets_idx = last_prime;
+        capacity *= 2;
     }
-    else
+    return capacity;
+}
+
+dhash_ptr_t* dhash_ptr_new(int initial_size)
+{
+    if (initial_size < 0) abort();
+
+    dhash_ptr_t* result = NEW0(dhash_ptr_t);
+
+    // Small sizes are just a hint: start with the inline storage
+    if (initial_size > 2 * DHASH_PTR_SMALL_SIZE)
     {
-        // Round to next prime
-        result->num_buckets_idx = 0;
-        while (prime_set[result->num_buckets_idx] < initial_size)
-        {
-            result->num_buckets_idx++;
-        }
+        dhash_ptr_allocate_items(result, dhash_ptr_capacity_for(initial_size));
     }
 
-    result->buckets = NEW_VEC0(bucket_ptr_t*, prime_set[result->num_buckets_idx]);
-
     return result;
 }
 
-static void free_bucket_list(bucket_ptr_t* bucket)
+void dhash_ptr_destroy(dhash_ptr_t* dhash)
 {
-    if (bucket == NULL)
-        return;
-
-    free_bucket_list(bucket->next);
-    xfree(bucket);
+    if (dhash->capacity != 0)
+    {
+        DELETE(dhash->items);
+    }
+    DELETE(dhash);
 }
 
-void dhash_ptr_destroy(dhash_ptr_t* dhash)
+// Returns the slot of key or the empty slot where it should go
+static inline int dhash_ptr_find_slot(dhash_ptr_t* dhash, const char* key)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
+    uint32_t mask = dhash->capacity - 1;
+    uint32_t i = hash_ptr(key) & mask;
 
-    int i;
-    for (i = 0; i < num_buckets; i++)
+    for (;;)
     {
-        free_bucket_list(dhash->buckets[i]);
+        const char* current_key = dhash->items[i].key;
+        if (current_key == key
+                || current_key == NULL)
+            return i;
+        i = (i + 1) & mask;
     }
-
-    xfree(dhash->buckets);
-    xfree(dhash);
 }
 
 void* dhash_ptr_query(dhash_ptr_t* dhash, const char* key)
 {
     if (key == NULL) abort();
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
-
-    bucket_ptr_t* b = dhash->buckets[hash];
-    while (b != NULL)
+    if (dhash->capacity == 0)
     {
-        if (b->key == key)
+        int i;
+        for (i = 0; i < dhash->num_items; i++)
         {
-            return b->info;
+            if (dhash->small_items[i].key == key)
+                return dhash->small_items[i].info;
         }
-        b = b->next;
+        return NULL;
     }
 
-    return NULL;
+    // Note that info of empty slots is always NULL
+    return dhash->items[dhash_ptr_find_slot(dhash, key)].info;
 }
 
-
-static void dhash_ptr_do_insert(dhash_ptr_t* dhash, const char* key, dhash_ptr_info_t info)
+static void dhash_ptr_rehash(dhash_ptr_t* dhash, int new_capacity)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
-
-    bucket_ptr_t* b = dhash->buckets[hash];
+    dhash_ptr_item_t* old_items;
+    int num_old_items;
+    dhash_ptr_item_t saved_small_items[DHASH_PTR_SMALL_SIZE];
 
-    while (b != NULL)
+    if (dhash->capacity == 0)
     {
-        if (b->key == key)
-        {
-            // Update
-            b->info = info;
-            return;
-        }
-        b = b->next;
+        memcpy(saved_small_items, dhash->small_items, sizeof(saved_small_items));
+        old_items = saved_small_items;
+        num_old_items = dhash->num_items;
+    }
+    else
+    {
+        old_items = dhash->items;
+        num_old_items = dhash->capacity;
     }
 
-    // Insert
-    b = NEW(bucket_ptr_t);
-    b->key = key;
-    b->info = info;
-    b->next = dhash->buckets[hash];
-    dhash->buckets[hash] = b;
-
-    dhash->num_items++;
-}
-
-static void dhash_ptr_increase_rehash(dhash_ptr_t* dhash)
-{
-    // Do not rehash anymore
-    if (dhash->num_buckets_idx == last_prime)
-        return;
-
-    int num_old_buckets = prime_set[dhash->num_buckets_idx];
-    bucket_ptr_t **old_buckets = dhash->buckets;
-
-    dhash->num_buckets_idx++;
-    int num_new_buckets = prime_set[dhash->num_buckets_idx];
-    bucket_ptr_t **new_buckets = NEW_VEC0(bucket_ptr_t*, num_new_buckets);
+    char old_items_are_small = (dhash->capacity == 0);
+    dhash_ptr_allocate_items(dhash, new_capacity);
 
     int i;
-    for (i = 0; i < num_old_buckets; i++)
+    for (i = 0; i < num_old_items; i++)
     {
-        bucket_ptr_t* old_b = old_buckets[i];
-
-        while (old_b != NULL)
-        {
-            uint32_t new_hash = Murmur3_32(old_b->key) % num_new_buckets;
+        if (old_items[i].key == NULL)
+            continue;
 
-            bucket_ptr_t* new_b = NEW(bucket_ptr_t);
-            new_b->key = old_b->key;
-            new_b->info = old_b->info;
-            new_b->next = new_buckets[new_hash];
-            new_buckets[new_hash] = new_b;
-
-            old_b = old_b->next;
-        }
+        dhash->items[dhash_ptr_find_slot(dhash, old_items[i].key)] = old_items[i];
     }
 
-    for (i = 0; i < num_old_buckets; i++)
+    if (!old_items_are_small)
     {
-        free_bucket_list(old_buckets[i]);
+        DELETE(old_items);
     }
-    xfree(old_buckets);
-
-    dhash->buckets = new_buckets;
 }
 
 void dhash_ptr_insert(dhash_ptr_t* dhash, const char* key, dhash_ptr_info_t info)
@@ -212,112 +187,115 @@ void dhash_ptr_insert(dhash_ptr_t* dhash, const char* key, dhash_ptr_info_t info
     if (key == NULL) abort();
     if (info == NULL) abort();
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    if (((num_buckets * 3) / 4) < dhash->num_items)
+    if (dhash->capacity == 0)
+    {
+        int i;
+        for (i = 0; i < dhash->num_items; i++)
+        {
+            if (dhash->small_items[i].key == key)
+            {
+                // Update
+                dhash->small_items[i].info = info;
+                return;
+            }
+        }
+
+        if (dhash->num_items < DHASH_PTR_SMALL_SIZE)
+        {
+            dhash->small_items[dhash->num_items].key = key;
+            dhash->small_items[dhash->num_items].info = info;
+            dhash->num_items++;
+            return;
+        }
+
+        dhash_ptr_rehash(dhash, DHASH_PTR_MIN_CAPACITY);
+    }
+    else if ((dhash->capacity / 4) * 3 <= dhash->num_items)
     {
-        dhash_ptr_increase_rehash(dhash);
+        dhash_ptr_rehash(dhash, dhash->capacity * 2);
     }
 
-    dhash_ptr_do_insert(dhash, key, info);
+    dhash_ptr_item_t* item = &dhash->items[dhash_ptr_find_slot(dhash, key)];
+    if (item->key == NULL)
+    {
+        item->key = key;
+        dhash->num_items++;
+    }
+    item->info = info;
 }
 
 void dhash_ptr_remove(dhash_ptr_t* dhash, const char* key)
 {
     if (key == NULL) abort();
 
-    int num_buckets = prime_set[dhash->num_buckets_idx];
-    uint32_t hash = Murmur3_32(key) % num_buckets;
+    if (dhash->capacity == 0)
+    {
+        int i;
+        for (i = 0; i < dhash->num_items; i++)
+        {
+            if (dhash->small_items[i].key == key)
+            {
+                dhash->num_items--;
+                dhash->small_items[i] = dhash->small_items[dhash->num_items];
+                return;
+            }
+        }
+        // Not found
+        return;
+    }
 
-    bucket_ptr_t** b = &(dhash->buckets[hash]);
+    uint32_t mask = dhash->capacity - 1;
+    uint32_t i = dhash_ptr_find_slot(dhash, key);
+    if (dhash->items[i].key == NULL)
+    {
+        // Not found
+        return;
+    }
 
-    while ((*b) != NULL)
+    // Move back any later item of the same cluster that would not be found
+    // after emptying slot i
+    uint32_t j = i;
+    for (;;)
     {
-        if ((*b)->key == key)
+        j = (j + 1) & mask;
+        if (dhash->items[j].key == NULL)
+            break;
+
+        uint32_t home = hash_ptr(dhash->items[j].key) & mask;
+        // Item j can fill the hole if its home is not in (i, j] cyclically
+        char can_move = (i <= j)
+            ? (home <= i || home > j)
+            : (home <= i && home > j);
+        if (can_move)
         {
-            bucket_ptr_t* current = *b;
-            *b = (*b)->next;
-            xfree(current);
-            dhash->num_items--;
-            return;
+            dhash->items[i] = dhash->items[j];
+            i = j;
         }
-        b = &((*b)->next);
     }
 
-    // Not found
+    dhash->items[i].key = NULL;
+    dhash->items[i].info = NULL;
+    dhash->num_items--;
 }
 
 void dhash_ptr_walk(dhash_ptr_t* dhash, dhash_ptr_walk_fn walk_fn, void *walk_info)
 {
-    int num_buckets = prime_set[dhash->num_buckets_idx];
+    if (dhash->capacity == 0)
+    {
+        int i;
+        for (i = 0; i < dhash->num_items; i++)
+        {
+            walk_fn(dhash->small_items[i].key, dhash->small_items[i].info, walk_info);
+        }
+        return;
+    }
 
     int i;
-    for (i = 0; i < num_buckets; i++)
+    for (i = 0; i < dhash->capacity; i++)
     {
-        bucket_ptr_t* b = dhash->buckets[i];
-        while (b != NULL)
+        if (dhash->items[i].key != NULL)
         {
-            walk_fn(b->key, b->info, walk_info);
-            b = b->next;
+            walk_fn(dhash->items[i].key, dhash->items[i].info, walk_info);
         }
     }
 }
-
-// Hash function
-// Taken from wikipedia
-STATIC_INLINE uint32_t Murmur3_32(const char* ptr)
-{
-	static const uint32_t c1 = 0xcc9e2d51;
-	static const uint32_t c2 = 0x1b873593;
-	static const uint32_t r1 = 15;
-	static const uint32_t r2 = 13;
-	static const uint32_t m = 5;
-	static const uint32_t n = 0xe6546b64;
-
-    // Size of a pointer
-    uint32_t len = sizeof(ptr);
-    const char* key = (const char*)&ptr;
-
-	uint32_t hash = 0;
- 
-	uint32_t* keydata = (uint32_t*) key; //used to extract 32 bits at a time
-	int keydata_it = 0;
- 
-	while (len >= 4)
-	{
-		uint32_t k = keydata[keydata_it++];
-		len -= 4;
- 
-		k *= c1;
-		k = (k << r1) | (k >> (32-r1));
-		k *= c2;
- 
-		hash ^= k;
-		hash = ((hash << r2) | (hash >> (32-r2)) * m) + n;
-	}
- 
-	const uint8_t * tail = (const uint8_t*)(keydata + keydata_it*4);
-	uint32_t k1 = 0;
- 
-	switch(len & 3) {
-	case 3:
-		k1 ^= tail[2] << 16;
-	case 2:
-		k1 ^= tail[1] << 8;
-	case 1:
-		k1 ^= tail[0];
- 
-		k1 *= c1;
-		k1 = (k1 << r1) | (k1 >> (32-r1));
-		k1 *= c2;
-		hash ^= k1;
-	}
- 
-	hash ^= len;
-	hash ^= (hash >> 16);
-	hash *= 0x85ebca6b;
-	hash ^= (hash >> 13);
-	hash *= 0xc2b2ae35;
-	hash ^= (hash >> 16);
- 
-	return hash;
-}
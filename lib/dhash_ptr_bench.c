@@ -0,0 +1,264 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+// Throughput benchmark of dhash_ptr
+//
+// Compares lookups and insertions of dhash_ptr against the separate chaining
+// scheme it used to have (prime number of buckets and one malloc per item).
+// Build it with 'make lib/dhash_ptr_bench' and run it without arguments
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "dhash_ptr.h"
+#include "mem.h"
+
+// Reference implementation: separate chaining
+typedef
+struct chained_bucket_tag
+{
+    const char* key;
+    void* info;
+    struct chained_bucket_tag* next;
+} chained_bucket_t;
+
+typedef
+struct chained_hash_tag
+{
+    chained_bucket_t **buckets;
+    int num_buckets_idx;
+    int num_items;
+} chained_hash_t;
+
+static const int prime_set[] = { 5, 11, 23, 53, 131, 317, 787, 1951, 4877, 12163, 30403, 76003 };
+static const int last_prime = (sizeof(prime_set) / sizeof(prime_set[0])) - 1;
+
+static uint32_t chained_hash_ptr(const char* key)
+{
+    // Finalizer of Murmur3 on the pointer value
+    uint32_t h = (uint32_t)(uintptr_t)key ^ (uint32_t)((uintptr_t)key >> 32);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+static chained_hash_t* chained_new(void)
+{
+    chained_hash_t* result = NEW0(chained_hash_t);
+    result->buckets = NEW_VEC0(chained_bucket_t*, prime_set[0]);
+    return result;
+}
+
+static void chained_destroy(chained_hash_t* h)
+{
+    int i;
+    for (i = 0; i < prime_set[h->num_buckets_idx]; i++)
+    {
+        chained_bucket_t* b = h->buckets[i];
+        while (b != NULL)
+        {
+            chained_bucket_t* next = b->next;
+            DELETE(b);
+            b = next;
+        }
+    }
+    DELETE(h->buckets);
+    DELETE(h);
+}
+
+static void* chained_query(chained_hash_t* h, const char* key)
+{
+    chained_bucket_t* b = h->buckets[chained_hash_ptr(key) % prime_set[h->num_buckets_idx]];
+    while (b != NULL)
+    {
+        if (b->key == key)
+            return b->info;
+        b = b->next;
+    }
+    return NULL;
+}
+
+static void chained_insert(chained_hash_t* h, const char* key, void* info)
+{
+    if (h->num_buckets_idx != last_prime
+            && ((prime_set[h->num_buckets_idx] * 3) / 4) < h->num_items)
+    {
+        int num_old_buckets = prime_set[h->num_buckets_idx];
+        chained_bucket_t** old_buckets = h->buckets;
+        h->num_buckets_idx++;
+        h->buckets = NEW_VEC0(chained_bucket_t*, prime_set[h->num_buckets_idx]);
+
+        int i;
+        for (i = 0; i < num_old_buckets; i++)
+        {
+            chained_bucket_t* b = old_buckets[i];
+            while (b != NULL)
+            {
+                chained_bucket_t* next = b->next;
+                uint32_t idx = chained_hash_ptr(b->key) % prime_set[h->num_buckets_idx];
+                b->next = h->buckets[idx];
+                h->buckets[idx] = b;
+                b = next;
+            }
+        }
+        DELETE(old_buckets);
+    }
+
+    uint32_t idx = chained_hash_ptr(key) % prime_set[h->num_buckets_idx];
+    chained_bucket_t* b = h->buckets[idx];
+    while (b != NULL)
+    {
+        if (b->key == key)
+        {
+            b->info = info;
+            return;
+        }
+        b = b->next;
+    }
+
+    b = NEW(chained_bucket_t);
+    b->key = key;
+    b->info = info;
+    b->next = h->buckets[idx];
+    h->buckets[idx] = b;
+    h->num_items++;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Fills num_tables tables of table_size keys each and then looks up every
+// key (and as many missing keys) num_lookups times
+static void run_benchmark(int num_tables, int table_size, int num_lookups)
+{
+    int num_keys = num_tables * table_size;
+    // Keys are addresses, as uniquestr would give
+    char* key_storage = NEW_VEC(char, 2 * num_keys * 8);
+    const char** keys = NEW_VEC(const char*, 2 * num_keys);
+    int i, j, k;
+    for (i = 0; i < 2 * num_keys; i++)
+    {
+        keys[i] = &key_storage[i * 8];
+    }
+    // Shuffle them so they are not inserted in address order
+    srand(42);
+    for (i = 2 * num_keys - 1; i > 0; i--)
+    {
+        j = rand() % (i + 1);
+        const char* t = keys[i];
+        keys[i] = keys[j];
+        keys[j] = t;
+    }
+
+    double t0, t_insert, t_query;
+    long found = 0;
+
+    // Chained
+    chained_hash_t** chained = NEW_VEC(chained_hash_t*, num_tables);
+    t0 = now();
+    for (i = 0; i < num_tables; i++)
+    {
+        chained[i] = chained_new();
+        for (j = 0; j < table_size; j++)
+            chained_insert(chained[i], keys[i * table_size + j], (void*)keys[i * table_size + j]);
+    }
+    t_insert = now() - t0;
+    t0 = now();
+    for (k = 0; k < num_lookups; k++)
+        for (i = 0; i < num_tables; i++)
+            for (j = 0; j < table_size; j++)
+            {
+                found += (chained_query(chained[i], keys[i * table_size + j]) != NULL);
+                found += (chained_query(chained[i], keys[num_keys + i * table_size + j]) != NULL);
+            }
+    t_query = now() - t0;
+    fprintf(stdout, "%8d x %6d | chained      | insert %8.2f Mops/s | query %8.2f Mops/s\n",
+            num_tables, table_size,
+            num_keys / t_insert / 1e6,
+            2.0 * num_keys * num_lookups / t_query / 1e6);
+    for (i = 0; i < num_tables; i++)
+        chained_destroy(chained[i]);
+    DELETE(chained);
+
+    // dhash_ptr
+    dhash_ptr_t** open = NEW_VEC(dhash_ptr_t*, num_tables);
+    t0 = now();
+    for (i = 0; i < num_tables; i++)
+    {
+        open[i] = dhash_ptr_new(5);
+        for (j = 0; j < table_size; j++)
+            dhash_ptr_insert(open[i], keys[i * table_size + j], (void*)keys[i * table_size + j]);
+    }
+    t_insert = now() - t0;
+    t0 = now();
+    for (k = 0; k < num_lookups; k++)
+        for (i = 0; i < num_tables; i++)
+            for (j = 0; j < table_size; j++)
+            {
+                found += (dhash_ptr_query(open[i], keys[i * table_size + j]) != NULL);
+                found += (dhash_ptr_query(open[i], keys[num_keys + i * table_size + j]) != NULL);
+            }
+    t_query = now() - t0;
+    fprintf(stdout, "%8d x %6d | dhash_ptr    | insert %8.2f Mops/s | query %8.2f Mops/s\n",
+            num_tables, table_size,
+            num_keys / t_insert / 1e6,
+            2.0 * num_keys * num_lookups / t_query / 1e6);
+    for (i = 0; i < num_tables; i++)
+        dhash_ptr_destroy(open[i]);
+    DELETE(open);
+
+    if (found != 2L * num_keys * num_lookups)
+    {
+        fprintf(stderr, "Wrong number of keys found: %ld\n", found);
+        exit(EXIT_FAILURE);
+    }
+
+    DELETE(keys);
+    DELETE(key_storage);
+}
+
+int main(void)
+{
+    // Many tiny tables, like block scopes, and a few big ones, like
+    // namespace scopes
+    run_benchmark(200000, 2, 20);
+    run_benchmark(100000, 4, 20);
+    run_benchmark(20000, 32, 20);
+    run_benchmark(1000, 1000, 10);
+    run_benchmark(4, 250000, 5);
+
+    return 0;
+}
@@ -29,6 +29,9 @@
 #include <stdio.h>
 #include <signal.h>
 #include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 #include "mem.h"
 
@@ -46,11 +49,15 @@
     } \
     while (0)
 
+size_t xmalloc_allocated_bytes = 0;
+
 void *xmalloc(size_t size)
 {
     if (size == 0)
         return NULL;
 
+    xmalloc_allocated_bytes += size;
+
     void* ptr = malloc(size);
     if (ptr == NULL)
     {
@@ -74,6 +81,8 @@ void *xcalloc(size_t nmemb, size_t size)
             || size == 0)
         return NULL;
 
+    xmalloc_allocated_bytes += nmemb * size;
+
     void* ptr = calloc(nmemb, size);
     if (ptr == NULL)
     {
@@ -94,6 +103,15 @@ void *xrealloc(void *ptr, size_t size)
     }
     else
     {
+        // Only count what the block grows
+        size_t old_size = 0;
+#if defined(__GLIBC__)
+        if (ptr != NULL)
+            old_size = malloc_usable_size(ptr);
+#endif
+        if (size > old_size)
+            xmalloc_allocated_bytes += size - old_size;
+
         void *res = realloc(ptr, size);
         if (res == NULL)
         {
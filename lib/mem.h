@@ -59,6 +59,10 @@ char *xstrdup(const char *s) MEM_WARN_UNUSED MEM_MALLOC_RETURN;
 // Guaranteed to call free
 void c_free(void *ptr);
 
+// Bytes requested so far through xmalloc, xcalloc and xrealloc, where
+// xrealloc only adds what a block grows. Memory released is not subtracted
+extern size_t xmalloc_allocated_bytes;
+
 #ifdef __cplusplus
 }
 #endif
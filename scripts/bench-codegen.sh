@@ -0,0 +1,99 @@
+#!/usr/bin/env bash
+
+# Measures codegen throughput on a generated C file with many functions.
+#
+# usage: bench-codegen.sh [--baseline=<build-dir>] <plaincxx> <config-dir> [number-of-functions] [extra flags]
+#
+# With --baseline the same file is also compiled by the plaincxx of another
+# build directory (e.g. one built before a change) and both throughputs are
+# compared. Every compiler is run BENCH_RUNS times (3 by default) and the best
+# throughput is kept.
+
+BASELINE_DIR=
+case "$1" in
+    --baseline=*)
+        BASELINE_DIR=${1#--baseline=}
+        shift
+        ;;
+esac
+
+PLAINCXX=$1
+CONFIG_DIR=$2
+NUM_FUNCTIONS=${3:-20000}
+shift $(( $# < 3 ? $# : 3 ))
+
+RUNS=${BENCH_RUNS:-3}
+
+if [ -z "${PLAINCXX}" -o -z "${CONFIG_DIR}" ];
+then
+    echo "usage: $0 [--baseline=<build-dir>] <plaincxx> <config-dir> [number-of-functions] [extra flags]" 1>&2
+    exit 1
+fi
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf ${WORKDIR}" EXIT
+
+INPUT=${WORKDIR}/bench.c
+OUTPUT=${WORKDIR}/bench-out.c
+
+{
+    echo "struct point { int x; int y; double w[4]; };"
+    for i in $(seq 1 ${NUM_FUNCTIONS});
+    do
+        cat <<EOC
+static int f${i}(struct point *p, int n)
+{
+    int i, s = ${i};
+    for (i = 0; i < n; i++)
+    {
+        if (p[i].x > p[i].y)
+            s += p[i].x * ${i} - (p[i].y >> 2);
+        else
+            s -= (int)(p[i].w[i % 4] / 2.5);
+    }
+    return s;
+}
+EOC
+    done
+} > ${INPUT}
+
+# Prints the profile of the codegen of one run
+run_compiler()
+{
+    "$1" --profile=mcc --config-dir="$2" -y --profile-phases \
+        -o ${OUTPUT} ${INPUT} "${@:3}" 2>&1 | grep -E "^(Phase|Profile)|codegen|MB/s"
+}
+
+# Prints the best codegen throughput (MB/s) of several runs
+best_throughput()
+{
+    local best=0
+    local run
+    for run in $(seq 1 ${RUNS});
+    do
+        local current=$(run_compiler "$@" | awk '/MB\/s/ { print $(NF-1); exit }')
+        best=$(awk -v a="${best}" -v b="${current:-0}" 'BEGIN { print (b > a) ? b : a }')
+    done
+    echo ${best}
+}
+
+if [ -z "${BASELINE_DIR}" ];
+then
+    run_compiler ${PLAINCXX} ${CONFIG_DIR} "$@"
+    echo "Input: $(wc -c < ${INPUT}) bytes, output: $(wc -c < ${OUTPUT}) bytes"
+    exit 0
+fi
+
+BEFORE=$(best_throughput ${BASELINE_DIR}/src/driver/plaincxx ${BASELINE_DIR}/config "$@")
+cp ${OUTPUT} ${WORKDIR}/baseline-out.c
+AFTER=$(best_throughput ${PLAINCXX} ${CONFIG_DIR} "$@")
+
+echo "Input: $(wc -c < ${INPUT}) bytes, output: $(wc -c < ${OUTPUT}) bytes, best of ${RUNS} runs"
+echo "Baseline: ${BEFORE} MB/s"
+echo "Current:  ${AFTER} MB/s"
+awk -v a="${BEFORE}" -v b="${AFTER}" 'BEGIN { if (a > 0) printf "Speedup:  %.2fx\n", b / a }'
+
+if ! cmp -s ${WORKDIR}/baseline-out.c ${OUTPUT};
+then
+    echo "warning: the output differs from the one of the baseline" 1>&2
+fi
@@ -132,6 +132,10 @@ typedef struct translation_unit_tag
 
     // Opaque pointer used when running compiler phases
     void *dto;
+
+    // Entry of the result cache (--result-cache-dir) or NULL if the results
+    // of this translation unit are not cached
+    const char* result_cache_entry;
 } translation_unit_t;
 
 struct compilation_configuration_tag;
@@ -182,6 +186,8 @@ typedef struct debug_options_tag
     char show_template_packs;
     char vectorization_verbose;
     char stats_string_table;
+    char codegen_jobs_fail;
+    char fortran_split_after_codegen;
 } debug_options_t;
 
 extern debug_options_t debug_options;
@@ -279,6 +285,12 @@ typedef struct compilation_process_tag
 
     // Flags
     char parallel_process; // enables features allowing parallel compilation
+    int num_jobs; // maximum number of translation units compiled concurrently
+    int num_native_jobs; // maximum number of native compilations running in background
+    int num_codegen_jobs; // maximum number of processes prettyprinting a file
+    int codegen_stats; // if not zero, number of top contributors to the prettyprinted files reported
+    char profile_phases; // record time, memory and nodes used by every compiler phase
+    const char* profile_phases_trace; // if not NULL, trace file of the profiled phases
 } compilation_process_t;
 
 typedef struct compilation_configuration_conditional_flags
@@ -396,6 +408,10 @@ typedef struct compilation_configuration_tag
     const char* preprocessor_name;
     const char** preprocessor_options;
     char preprocessor_uses_stdout;
+    // Parse C/C++ while the preprocessor writes to a pipe
+    char preprocessor_stream;
+    // Directory of the cache of generated sources and objects
+    const char* result_cache_dir;
 
     // Fortran preprocessor
     const char* fortran_preprocessor_name;
@@ -514,6 +530,9 @@ typedef struct compilation_configuration_tag
     // Enable explicit instantiation
     char explicit_instantiation;
 
+    // Defer the initializers of static data members of class templates
+    char lazy_instantiation;
+
     // Disable 'sizeof' computation
     char disable_sizeof;
 
@@ -123,6 +123,13 @@ void temporal_files_cleanup(void)
     temporal_file_list = NULL;
 }
 
+void temporal_files_detach(void)
+{
+    // The files in the list are owned by the parent process
+    // so they are just dropped here
+    temporal_file_list = NULL;
+}
+
 static char name_is_in_temporal_files(const char* name)
 {
     temporal_file_list_t it = temporal_file_list;
@@ -345,7 +352,10 @@ int execute_program(const char* program_name, const char** arguments)
 }
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
-static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+// If stdout_pipe is not NULL the standard output of the program is
+// redirected to the write end of that pipe
+static pid_t spawn_program_unix(const char* program_name, const char** arguments,
+        const char* stdout_f, const char* stderr_f, int* stdout_pipe)
 {
     if (program_name == NULL)
         program_name = "";
@@ -388,7 +398,8 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
     // This routine is UNIX-only
     pid_t spawned_process;
     if (stdout_f == NULL
-            && stderr_f == NULL)
+            && stderr_f == NULL
+            && stdout_pipe == NULL)
     {
         // If no work previous to execvp is requested, vfork is fine
         spawned_process = vfork();
@@ -404,6 +415,17 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
     }
     else if (spawned_process == 0) // I'm the spawned process
     {
+        if (stdout_pipe != NULL)
+        {
+            close(stdout_pipe[0]);
+            if (dup2(stdout_pipe[1], 1) < 0)
+            {
+                fatal_error("error: could not redirect standard output to a pipe (%s)",
+                        strerror(errno));
+            }
+            close(stdout_pipe[1]);
+        }
+
         // Redirect output files as needed
         if (stdout_f != NULL)
         {
@@ -449,30 +471,163 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
         // Execvp should not return
         fatal_error("error: execution of subprocess '%s' failed (%s)", program_name, strerror(errno));
     }
-    else // I'm the parent
+
+    // I'm the parent
+    return spawned_process;
+}
+
+static int exit_status_of_program_unix(const char* program_name, int status)
+{
+    if (WIFEXITED(status))
+    {
+        return (WEXITSTATUS(status));
+    }
+    else if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
+                program_name, WTERMSIG(status));
+
+        return 1;
+    }
+    else
     {
-        // Wait for my son
-        int status;
-        wait(&status);
-        if (WIFEXITED(status))
+        internal_error(
+                "Subprocess '%s' ended but neither by normal exit nor signal", 
+                program_name);
+    }
+}
+
+// Children reaped by wait_any_of_programs_async while it was waiting for
+// other ones. Their status is kept for whoever waits for them later
+typedef struct reaped_child_tag
+{
+    pid_t pid;
+    int status;
+} reaped_child_t;
+
+static int num_reaped_children = 0;
+static reaped_child_t* reaped_children = NULL;
+
+static char take_reaped_child(pid_t pid, int* status)
+{
+    int i;
+    for (i = 0; i < num_reaped_children; i++)
+    {
+        if (reaped_children[i].pid == pid)
         {
-            return (WEXITSTATUS(status));
+            *status = reaped_children[i].status;
+            reaped_children[i] = reaped_children[num_reaped_children - 1];
+            num_reaped_children--;
+            return 1;
         }
-        else if (WIFSIGNALED(status))
+    }
+    return 0;
+}
+
+static void wait_child_unix(pid_t pid, const char* program_name, int* status)
+{
+    if (take_reaped_child(pid, status))
+        return;
+
+    while (waitpid(pid, status, 0) < 0)
+    {
+        if (errno != EINTR)
         {
-            fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
-                    program_name, WTERMSIG(status));
+            fatal_error("error: waiting for subprocess '%s' failed (%s)", program_name, strerror(errno));
+        }
+    }
+}
 
-            return 1;
+static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+{
+    pid_t spawned_process = spawn_program_unix(program_name, arguments, stdout_f, stderr_f,
+            /* stdout_pipe */ NULL);
+
+    // Wait for my son. Other children may be running asynchronously so do
+    // not wait any of them
+    int status;
+    wait_child_unix(spawned_process, program_name, &status);
+
+    return exit_status_of_program_unix(program_name, status);
+}
+
+int execute_program_async(const char* program_name, const char** arguments)
+{
+    return spawn_program_unix(program_name, arguments, /* stdout_f */ NULL, /* stderr_f */ NULL,
+            /* stdout_pipe */ NULL);
+}
+
+int execute_program_to_pipe(const char* program_name, const char** arguments, int* stdout_fd)
+{
+    int stdout_pipe[2];
+    if (pipe(stdout_pipe) < 0)
+    {
+        fatal_error("error: could not create a pipe to execute subprocess '%s' (%s)",
+                program_name, strerror(errno));
+    }
+
+    pid_t spawned_process = spawn_program_unix(program_name, arguments,
+            /* stdout_f */ NULL, /* stderr_f */ NULL, stdout_pipe);
+
+    // Only the child writes in the pipe, otherwise we would never see its end
+    close(stdout_pipe[1]);
+    *stdout_fd = stdout_pipe[0];
+
+    return spawned_process;
+}
+
+int wait_program_async(int pid, const char* program_name)
+{
+    int status;
+    wait_child_unix(pid, program_name, &status);
+
+    return exit_status_of_program_unix(program_name, status);
+}
+
+int wait_any_of_programs_async(const int* pids, int num_pids, int* status)
+{
+    int i;
+    for (i = 0; i < num_pids; i++)
+    {
+        // Unused slots are not positive
+        if (pids[i] > 0
+                && take_reaped_child(pids[i], status))
+            return i;
+    }
+
+    // waitpid cannot wait for a set of processes, so wait for any child and
+    // keep the status of those that are not in the set for whoever waits for
+    // them through wait_child_unix
+    for (;;)
+    {
+        int child_status;
+        pid_t finished_process = waitpid(-1, &child_status, 0);
+        if (finished_process < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            fatal_error("error: waiting for subprocesses failed (%s)", strerror(errno));
         }
-        else
+
+        for (i = 0; i < num_pids; i++)
         {
-            internal_error(
-                    "Subprocess '%s' ended but neither by normal exit nor signal", 
-                    program_name);
+            if (pids[i] == finished_process)
+            {
+                *status = child_status;
+                return i;
+            }
         }
+
+        reaped_child_t reaped_child = { finished_process, child_status };
+        P_LIST_ADD(reaped_children, num_reaped_children, reaped_child);
     }
 }
+
+int exit_status_of_program_async(const char* program_name, int status)
+{
+    return exit_status_of_program_unix(program_name, status);
+}
 #else
 
 static char* quote_string(const char *c)
@@ -997,3 +1152,43 @@ const char* find_file_in_directories(
 
     return path_found;
 }
+
+// FNV-1a
+uint64_t fnv_hash_data(uint64_t h, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+uint64_t fnv_hash_string(uint64_t h, const char* str)
+{
+    if (str == NULL)
+        str = "";
+    // Include the ending NUL so consecutive strings cannot be confused
+    return fnv_hash_data(h, str, strlen(str) + 1);
+}
+
+uint64_t fnv_hash_file(uint64_t h, const char* filename)
+{
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+    {
+        fatal_error("error: cannot open file '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        h = fnv_hash_data(h, buffer, n);
+    }
+    fclose(f);
+
+    return h;
+}
@@ -31,6 +31,7 @@
 #define CXX_DRIVERUTILS_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/time.h>
 #include <time.h>
 #include "cxx-process.h"
@@ -77,12 +78,36 @@ temporal_file_t new_temporal_file_extension(const char* extension);
 // file is closed and erased.
 void temporal_files_cleanup(void);
 
+// Forgets every temporal file registered so far without removing it. A
+// child process of the driver uses this so it does not remove files that
+// belong to its parent when it finishes
+void temporal_files_detach(void);
+
 const char* get_extension_filename(const char* filename);
 
 int execute_program(const char* program_name, const char** arguments);
 int execute_program_flags(const char* program_name, const char** arguments, 
         const char *stdout_f, const char *stderr_f);
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Starts a program but does not wait for it to end. Returns the identifier
+// of the spawned process
+int execute_program_async(const char* program_name, const char** arguments);
+// Waits for any of the first num_pids processes in pids to end, ignoring the
+// ones that are not positive. Other child processes ending meanwhile are
+// reaped too, but their status is kept for wait_program_async. Returns the
+// index of the process that ended and stores its wait status in *status
+int wait_any_of_programs_async(const int* pids, int num_pids, int* status);
+// Returns the exit status of a program given the wait status returned by
+// wait_any_of_programs_async
+int exit_status_of_program_async(const char* program_name, int status);
+// Starts a program whose standard output can be read from *stdout_fd while
+// it runs. Returns the identifier of the spawned process
+int execute_program_to_pipe(const char* program_name, const char** arguments, int* stdout_fd);
+// Waits for the given child process to end and returns its exit status
+int wait_program_async(int pid, const char* program_name);
+#endif
+
 // char** routines
 int count_null_ended_array(void** v);
 void remove_string_from_null_ended_string_array(const char** string_arr, const char* to_remove);
@@ -122,6 +147,13 @@ void mark_dir_for_cleanup(const char* name);
 void mark_file_as_temporary(const char* name);
 void mark_dir_as_temporary(const char* name);
 
+// Hashing of data, strings and contents of files used to key the
+// persistent caches. Start with FNV_HASH_INITIAL
+#define FNV_HASH_INITIAL 0xcbf29ce484222325ULL
+uint64_t fnv_hash_data(uint64_t h, const void* data, size_t size);
+uint64_t fnv_hash_string(uint64_t h, const char* str);
+uint64_t fnv_hash_file(uint64_t h, const char* filename);
+
 // Find the path where the application runs
 const char* find_home(const char* progname);
 
@@ -44,6 +44,7 @@
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
 #include <signal.h>
+#include <sys/wait.h>
 #endif
 
 #ifdef HAVE_MALLINFO
@@ -79,6 +80,7 @@
 #include "cxx-configfile.h"
 #include "cxx-profile.h"
 #include "cxx-multifile.h"
+#include "cxx-result-cache.h"
 #include "cxx-nodecl.h"
 #include "cxx-nodecl-checker.h"
 #include "cxx-limits.h"
@@ -208,6 +210,9 @@
 "                           file and quits\n" \
 "  --instantiate            Instantiate explicitly templates. This is\n" \
 "                           an unsupported experimental feature\n" \
+"  --lazy-instantiation     Instantiate the initializers of static\n" \
+"                           data members of class templates only\n" \
+"                           when they are used\n" \
 "  --pp[=on]                Preprocess files\n"\
 "                           This is the default for files ending with\n"\
 "                           C/C++: .c, .cc, .C, .cp, .cpp, .cxx, .c++\n"\
@@ -217,6 +222,13 @@
 "                           C/C++: .i, .ii\n"\
 "                           Fortran: .f, .f77, .f90, .f95\n"\
 "  --pp-stdout              Preprocessor uses stdout for output\n" \
+"  --pp-stream              Parse C/C++ files while they are being\n" \
+"                           preprocessed, reading the output of the\n" \
+"                           preprocessor from a pipe\n" \
+"  --result-cache-dir=<dir> Keeps the generated source and object of\n" \
+"                           every C/C++ file in <dir> and reuses them\n" \
+"                           when the preprocessed file, the command\n" \
+"                           line and the profile have not changed\n" \
 "  --fpp                    An alias for --pp=on\n"\
 "  --fpp=<name>             Preprocessor <name> will be used for\n" \
 "                           preprocessing Fortran source\n" \
@@ -314,6 +326,27 @@
 "                           allows parallel compilation of the same\n" \
 "                           source codes without reusing intermediate\n" \
 "                           filenames\n" \
+"  --jobs=<n>               Compile up to <n> translation units\n" \
+"                           concurrently, each one in its own\n" \
+"                           process. Fortran files are always\n" \
+"                           compiled sequentially\n" \
+"  --native-jobs=<n>        Run up to <n> native compilations in\n" \
+"                           background while the next files are\n" \
+"                           processed. Fortran files are always\n" \
+"                           natively compiled in foreground\n" \
+"  --codegen-jobs=<n>       Prettyprint independent function\n" \
+"                           definitions of a file using up to <n>\n" \
+"                           processes. The output is the same as\n" \
+"                           the one of a sequential prettyprint\n" \
+"  --codegen-stats[=<n>]    Print the <n> (10 by default) nodecl\n" \
+"                           kinds and source loci that emit the\n" \
+"                           most bytes of every prettyprinted\n" \
+"                           file, and the time they take\n" \
+"  --profile-phases[=<file>]\n" \
+"                           Print the time, memory and nodes\n" \
+"                           used by every compiler phase. If\n" \
+"                           <file> is given, also write them\n" \
+"                           there as a Chrome trace (JSON)\n" \
 "  --Xcompiler OPTION       Equivalent to --Wn,OPTION\n" \
 "\n" \
 "Compatibility parameters:\n" \
@@ -376,6 +409,8 @@ typedef enum
     OPTION_UNDEFINED = 1024,
     // Keep the following options sorted (but leave OPTION_UNDEFINED as is)
     OPTION_ALWAYS_PREPROCESS,
+    OPTION_CODEGEN_JOBS,
+    OPTION_CODEGEN_STATS,
     OPTION_CONFIG_DIR,
     OPTION_CONFIG_FILE,
     OPTION_DEBUG_FLAG,
@@ -413,6 +448,8 @@ typedef enum
     OPTION_HELP_TARGET_OPTIONS,
     OPTION_IFORT_COMPATIBILITY,
     OPTION_INSTANTIATE_TEMPLATES,
+    OPTION_JOBS,
+    OPTION_LAZY_INSTANTIATION,
     OPTION_LINE_MARKERS,
     OPTION_LINKER_NAME,
     OPTION_LIST_ENVIRONMENTS,
@@ -421,6 +458,7 @@ typedef enum
     OPTION_LIST_VECTOR_FLAVORS,
     OPTION_MODULE_OUT_PATTERN,
     OPTION_NATIVE_COMPILER_NAME,
+    OPTION_NATIVE_JOBS,
     OPTION_NO_OPENMP,
     OPTION_NO_WHOLE_FILE,
     OPTION_OPENCL_OPTIONS,
@@ -429,10 +467,13 @@ typedef enum
     OPTION_PARALLEL,
     OPTION_PASS_THROUGH,
     OPTION_PREPROCESSOR_NAME,
+    OPTION_PREPROCESSOR_STREAM,
     OPTION_PREPROCESSOR_USES_STDOUT,
     OPTION_PRINT_CONFIG_DIR,
     OPTION_PRINT_CONFIG_FILE,
     OPTION_PROFILE,
+    OPTION_PROFILE_PHASES,
+    OPTION_RESULT_CACHE_DIR,
     OPTION_SEARCH_INCLUDES,
     OPTION_SEARCH_MODULES,
     OPTION_SET_ENVIRONMENT,
@@ -478,6 +519,8 @@ struct command_line_long_options command_line_long_options[] =
     {"variable", CLP_REQUIRED_ARGUMENT, OPTION_EXTERNAL_VAR},
     {"typecheck", CLP_NO_ARGUMENT, OPTION_TYPECHECK},
     {"pp-stdout", CLP_NO_ARGUMENT, OPTION_PREPROCESSOR_USES_STDOUT},
+    {"pp-stream", CLP_NO_ARGUMENT, OPTION_PREPROCESSOR_STREAM},
+    {"result-cache-dir", CLP_REQUIRED_ARGUMENT, OPTION_RESULT_CACHE_DIR},
     {"disable-gxx-traits", CLP_NO_ARGUMENT, OPTION_DISABLE_GXX_TRAITS},
     {"pass-through", CLP_NO_ARGUMENT, OPTION_PASS_THROUGH}, 
     {"disable-sizeof", CLP_NO_ARGUMENT, OPTION_DISABLE_SIZEOF},
@@ -492,6 +535,7 @@ struct command_line_long_options command_line_long_options[] =
     {"opencl-build-opts",  CLP_REQUIRED_ARGUMENT, OPTION_OPENCL_OPTIONS},
     {"do-not-unload-phases", CLP_NO_ARGUMENT, OPTION_DO_NOT_UNLOAD_PHASES},
     {"instantiate", CLP_NO_ARGUMENT, OPTION_INSTANTIATE_TEMPLATES},
+    {"lazy-instantiation", CLP_NO_ARGUMENT, OPTION_LAZY_INSTANTIATION},
     {"pp", CLP_OPTIONAL_ARGUMENT, OPTION_ALWAYS_PREPROCESS},
     {"fpp", CLP_OPTIONAL_ARGUMENT, OPTION_FORTRAN_PREPROCESSOR},
     {"width", CLP_REQUIRED_ARGUMENT, OPTION_FORTRAN_COLUMN_WIDTH},
@@ -530,6 +574,11 @@ struct command_line_long_options command_line_long_options[] =
     {"ifort-compat", CLP_NO_ARGUMENT, OPTION_IFORT_COMPATIBILITY },
     {"line-markers", CLP_NO_ARGUMENT, OPTION_LINE_MARKERS },
     {"parallel", CLP_NO_ARGUMENT, OPTION_PARALLEL },
+    {"jobs", CLP_REQUIRED_ARGUMENT, OPTION_JOBS },
+    {"native-jobs", CLP_REQUIRED_ARGUMENT, OPTION_NATIVE_JOBS },
+    {"codegen-jobs", CLP_REQUIRED_ARGUMENT, OPTION_CODEGEN_JOBS },
+    {"codegen-stats", CLP_OPTIONAL_ARGUMENT, OPTION_CODEGEN_STATS },
+    {"profile-phases", CLP_OPTIONAL_ARGUMENT, OPTION_PROFILE_PHASES },
     {"Xcompiler", CLP_REQUIRED_ARGUMENT, OPTION_XCOMPILER },
     // sentinel
     {NULL, 0, 0}
@@ -559,6 +608,9 @@ static void load_configuration(void);
 static void finalize_committed_configuration(compilation_configuration_t*);
 static void commit_configuration(void);
 static void compile_every_translation_unit(void);
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+static void wait_pending_native_compilations(void);
+#endif
 
 static void compiler_phases_execution(
         compilation_configuration_t* config,
@@ -569,10 +621,15 @@ static void compiler_phases_pre_execution(
         translation_unit_t* translation_unit,
         const char* parsed_filename);
 static const char* preprocess_translation_unit(translation_unit_t* translation_unit, const char* input_filename);
-static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+static FILE* preprocess_translation_unit_to_stream(const char* input_filename, int* preprocessor_pid);
+#endif
+static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename,
+        int preprocessor_pid, int preprocessor_output_fd);
 static void initialize_semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
 static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
-static const char* codegen_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
+static const char* codegen_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename,
+        const char* cached_source);
 static void native_compilation(translation_unit_t* translation_unit, 
         const char* prettyprinted_filename, char remove_input);
 
@@ -586,6 +643,7 @@ static void terminating_signal_handler(int sig);
 static char check_tree(AST a);
 
 static void embed_files(void);
+static void embed_files_of_translation_unit(compilation_file_process_t* file_process);
 static void link_objects(void);
 
 static void add_to_parameter_list_str(const char*** existing_options, const char* str);
@@ -696,6 +754,11 @@ int main(int argc, char* argv[])
                 timing_elapsed(&timing_global));
     }
 
+    if (compilation_process.profile_phases)
+    {
+        compiler_phases_profile_report(compilation_process.profile_phases_trace);
+    }
+
     if (debug_options.print_memory_report)
     {
         print_memory_report();
@@ -1356,6 +1419,16 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->preprocessor_uses_stdout = 1;
                         break;
                     }
+                case OPTION_PREPROCESSOR_STREAM :
+                    {
+                        CURRENT_CONFIGURATION->preprocessor_stream = 1;
+                        break;
+                    }
+                case OPTION_RESULT_CACHE_DIR :
+                    {
+                        CURRENT_CONFIGURATION->result_cache_dir = uniquestr(parameter_info.argument);
+                        break;
+                    }
                 case OPTION_DISABLE_GXX_TRAITS:
                     {
                         CURRENT_CONFIGURATION->disable_gxx_type_traits = 1;
@@ -1526,6 +1599,11 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->explicit_instantiation = 1;
                         break;
                     }
+                case OPTION_LAZY_INSTANTIATION:
+                    {
+                        CURRENT_CONFIGURATION->lazy_instantiation = 1;
+                        break;
+                    }
                 case OPTION_ALWAYS_PREPROCESS:
                     {
                         if (parameter_info.argument == NULL
@@ -1676,6 +1754,71 @@ int parse_arguments(int argc, const char* argv[],
                         compilation_process.parallel_process = 1;
                         break;
                     }
+                case OPTION_JOBS:
+                    {
+                        int num_jobs = atoi(parameter_info.argument);
+                        if (num_jobs < 1)
+                        {
+                            fprintf(stderr, "%s: invalid number of jobs '%s'. Using 1\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            num_jobs = 1;
+                        }
+                        compilation_process.num_jobs = num_jobs;
+                        break;
+                    }
+                case OPTION_NATIVE_JOBS:
+                    {
+                        int num_native_jobs = atoi(parameter_info.argument);
+                        if (num_native_jobs < 0)
+                        {
+                            fprintf(stderr, "%s: invalid number of native jobs '%s'. Using 0\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            num_native_jobs = 0;
+                        }
+                        compilation_process.num_native_jobs = num_native_jobs;
+                        break;
+                    }
+                case OPTION_CODEGEN_JOBS:
+                    {
+                        int num_codegen_jobs = atoi(parameter_info.argument);
+                        if (num_codegen_jobs < 1)
+                        {
+                            fprintf(stderr, "%s: invalid number of codegen jobs '%s'. Using 1\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            num_codegen_jobs = 1;
+                        }
+                        compilation_process.num_codegen_jobs = num_codegen_jobs;
+                        break;
+                    }
+                case OPTION_CODEGEN_STATS:
+                    {
+                        int codegen_stats = 10;
+                        if (parameter_info.argument != NULL)
+                        {
+                            codegen_stats = atoi(parameter_info.argument);
+                            if (codegen_stats < 1)
+                            {
+                                fprintf(stderr, "%s: invalid number of codegen stats entries '%s'. Using 10\n",
+                                        compilation_process.exec_basename,
+                                        parameter_info.argument);
+                                codegen_stats = 10;
+                            }
+                        }
+                        compilation_process.codegen_stats = codegen_stats;
+                        break;
+                    }
+                case OPTION_PROFILE_PHASES:
+                    {
+                        compilation_process.profile_phases = 1;
+                        if (parameter_info.argument != NULL)
+                        {
+                            compilation_process.profile_phases_trace = uniquestr(parameter_info.argument);
+                        }
+                        break;
+                    }
                 case OPTION_XCOMPILER:
                     {
                         const char * parameter[] = { uniquestr(parameter_info.argument) };
@@ -2991,6 +3134,10 @@ static void register_upc_pragmae(compilation_configuration_t* configuration)
     register_new_directive(configuration, "distributed", "", /* is_construct */ 0, /* bound_to_single_stmt */ 0);
 }
 
+// States if some enclosing invocation of compile_every_translation_unit_aux_
+// still has translation units to compile after the current one
+static char more_translation_units_pending = 0;
+
 static void compile_every_translation_unit_aux_(int num_translation_units,
         compilation_file_process_t** translation_units)
 {
@@ -3072,11 +3219,49 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
 #ifndef FORTRAN_NEW_SCANNER
         char preprocessed = 0;
 #endif
+        // Only when streaming the output of the preprocessor
+        FILE* preprocessed_stream = NULL;
+        int preprocessor_pid = -1;
+        int preprocessor_output_fd = -1;
+
         // If the file is not preprocessed or we've ben told to preprocess it
-        if (((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
-                    || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
-                    && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED))
-                && !CURRENT_CONFIGURATION->pass_through)
+        char must_be_preprocessed =
+            ((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
+              || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
+             && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED))
+            && !CURRENT_CONFIGURATION->pass_through;
+
+        // The result cache needs the whole preprocessed file before parsing
+        char use_result_cache = (CURRENT_CONFIGURATION->result_cache_dir != NULL
+                && !CURRENT_CONFIGURATION->do_not_parse
+                && !CURRENT_CONFIGURATION->do_not_prettyprint
+                && !CURRENT_CONFIGURATION->pass_through
+                && !debug_options.do_not_codegen
+                && !file_not_processed
+                && (IS_C_LANGUAGE || IS_CXX_LANGUAGE));
+
+        char stream_preprocessor = (must_be_preprocessed
+                && CURRENT_CONFIGURATION->preprocessor_stream
+                && !use_result_cache
+                && !CURRENT_CONFIGURATION->do_not_parse
+                && !file_not_processed
+                && (IS_C_LANGUAGE || IS_CXX_LANGUAGE));
+
+        if (stream_preprocessor)
+        {
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+            // The preprocessor runs while the file is parsed
+            preprocessed_stream = preprocess_translation_unit_to_stream(
+                    translation_unit->input_filename,
+                    &preprocessor_pid);
+            // Keeps the pipe open even if the scanner closes the stream
+            preprocessor_output_fd = dup(fileno(preprocessed_stream));
+            parsed_filename = uniquestr("<preprocessor output>");
+#else
+            internal_error("Not yet implemented in windows", 0);
+#endif
+        }
+        else if (must_be_preprocessed)
         {
 #ifndef FORTRAN_NEW_SCANNER
             preprocessed = 1;
@@ -3152,10 +3337,29 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
         }
 #endif
 
+        // If the result cache has the generated source there is nothing else
+        // to do with this file until it is written
+        const char* cached_source = NULL;
+        if (use_result_cache)
+        {
+            translation_unit->result_cache_entry = result_cache_entry_directory(parsed_filename);
+            if (translation_unit->result_cache_entry != NULL)
+                cached_source = result_cache_get_source(translation_unit->result_cache_entry);
+
+            if (cached_source != NULL
+                    && CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "File '%s' has not changed, reusing result cache entry '%s'\n",
+                        translation_unit->input_filename,
+                        translation_unit->result_cache_entry);
+            }
+        }
+
         if (!CURRENT_CONFIGURATION->do_not_parse)
         {
             if (!CURRENT_CONFIGURATION->pass_through
-                    && !file_not_processed)
+                    && !file_not_processed
+                    && cached_source == NULL)
             {
                 // * Do this before open for scan since we might to internally parse some sources
                 mcxx_flex_debug = mc99_flex_debug = debug_options.debug_lexer;
@@ -3173,19 +3377,33 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 initialize_semantic_analysis(translation_unit, parsed_filename);
 
                 // * Open file
-                CXX_LANGUAGE()
+                if (preprocessed_stream != NULL)
                 {
-                    if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                    CXX_LANGUAGE()
                     {
-                        fatal_error("Could not open file '%s'", parsed_filename);
+                        mcxx_open_stream_for_scanning(preprocessed_stream, parsed_filename, translation_unit->input_filename);
+                    }
+                    C_LANGUAGE()
+                    {
+                        mc99_open_stream_for_scanning(preprocessed_stream, parsed_filename, translation_unit->input_filename);
                     }
                 }
-
-                C_LANGUAGE()
+                else
                 {
-                    if (mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                    CXX_LANGUAGE()
                     {
-                        fatal_error("Could not open file '%s'", parsed_filename);
+                        if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", parsed_filename);
+                        }
+                    }
+
+                    C_LANGUAGE()
+                    {
+                        if (mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", parsed_filename);
+                        }
                     }
                 }
 
@@ -3198,7 +3416,8 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 }
 
                 // * Parse file
-                parse_translation_unit(translation_unit, parsed_filename);
+                parse_translation_unit(translation_unit, parsed_filename,
+                        preprocessor_pid, preprocessor_output_fd);
                 // The scanner automatically closes the file
 
                 if (debug_options.print_parse_tree)
@@ -3269,25 +3488,34 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                     && !debug_options.do_not_codegen)
             {
                 prettyprinted_filename
-                    = codegen_translation_unit(translation_unit, parsed_filename);
+                    = codegen_translation_unit(translation_unit, parsed_filename, cached_source);
             }
 
-            timing_t timing_free_tree;
-            if (CURRENT_CONFIGURATION->verbose)
+            // If nothing else is going to be compiled in this process there
+            // is no point in walking the whole tree to return it node by node
+            // to the AST arena: it will be released at once when we exit
+            if (more_translation_units_pending
+                    || (i + 1) < num_translation_units
+                    || file_process->num_secondary_translation_units != 0
+                    || debug_options.print_memory_report)
             {
-                DEBUG_CODE()
+                timing_t timing_free_tree;
+                if (CURRENT_CONFIGURATION->verbose)
                 {
-                    fprintf(stderr, "Freeing nodecl tree\n");
+                    DEBUG_CODE()
+                    {
+                        fprintf(stderr, "Freeing nodecl tree\n");
+                    }
                 }
-            }
-            timing_start(&timing_free_tree);
-            nodecl_free(translation_unit->nodecl);
-            timing_end(&timing_free_tree);
-            if (CURRENT_CONFIGURATION->verbose)
-            {
-                DEBUG_CODE()
+                timing_start(&timing_free_tree);
+                nodecl_free(translation_unit->nodecl);
+                timing_end(&timing_free_tree);
+                if (CURRENT_CONFIGURATION->verbose)
                 {
-                    fprintf(stderr, "Nodecl tree freed in %.2f seconds\n", timing_elapsed(&timing_free_tree));
+                    DEBUG_CODE()
+                    {
+                        fprintf(stderr, "Nodecl tree freed in %.2f seconds\n", timing_elapsed(&timing_free_tree));
+                    }
                 }
             }
 
@@ -3299,9 +3527,13 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                     fprintf(stderr, "\nThere are secondary translation units for '%s'. Processing.\n",
                             translation_unit->input_filename);
                 }
+                char saved_more_translation_units_pending = more_translation_units_pending;
+                more_translation_units_pending = more_translation_units_pending
+                    || (i + 1) < num_translation_units;
                 compile_every_translation_unit_aux_(
                         file_process->num_secondary_translation_units,
                         file_process->secondary_translation_units);
+                more_translation_units_pending = saved_more_translation_units_pending;
 
                 if (CURRENT_CONFIGURATION->verbose)
                 {
@@ -3372,142 +3604,595 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
 #undef return
 }
 
-static void compile_every_translation_unit(void)
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Parallel compilation of translation units
+//
+// Every primary translation unit is compiled (up to native compilation and
+// embedding of its secondary translation units) in a child process. The
+// driver keeps a lot of global state so we do not attempt to share anything
+// with the children: once a child ends it just reports, through a results
+// file, the information that the parent needs for linking.
+static char translation_unit_can_be_compiled_in_parallel(compilation_file_process_t* file_process)
 {
-    compile_every_translation_unit_aux_(compilation_process.num_translation_units,
-            compilation_process.translation_units);
+    translation_unit_t* translation_unit = file_process->translation_unit;
+
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+    // Fortran files may depend on the modules generated by previous files
+    return (current_extension->source_language != SOURCE_LANGUAGE_FORTRAN
+            && file_process->compilation_configuration->source_language != SOURCE_LANGUAGE_FORTRAN
+            // Output is sent to stdout
+            && (translation_unit->output_filename == NULL
+                || strcmp(translation_unit->output_filename, "-") != 0));
 }
 
-static void compiler_phases_pre_execution(
-        compilation_configuration_t* config,
-        translation_unit_t* translation_unit,
-        const char* parsed_filename UNUSED_PARAMETER)
+static char translation_units_can_be_compiled_in_parallel(void)
 {
-    timing_t time_phases;
-    timing_start(&time_phases);
+    if (compilation_process.num_jobs <= 1)
+        return 0;
 
-    start_compiler_phase_pre_execution(config, translation_unit);
+    int num_compilable_files = 0;
+    int i;
+    for (i = 0; i < compilation_process.num_translation_units; i++)
+    {
+        compilation_file_process_t* file_process = compilation_process.translation_units[i];
+        if (file_process->already_compiled)
+            continue;
 
-    timing_end(&time_phases);
+        const char* extension = get_extension_filename(file_process->translation_unit->input_filename);
+        struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+        if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA)
+            continue;
 
-    if (CURRENT_CONFIGURATION->verbose)
-    {
-        fprintf(stderr, "Early compiler phases pipeline executed in %.2f seconds\n", timing_elapsed(&time_phases));
+        if (!translation_unit_can_be_compiled_in_parallel(file_process))
+        {
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "File '%s' cannot be compiled in parallel. Compiling all files sequentially\n",
+                        file_process->translation_unit->input_filename);
+            }
+            return 0;
+        }
+
+        num_compilable_files++;
     }
+
+    return (num_compilable_files > 1);
 }
 
-static void compiler_phases_execution(
-        compilation_configuration_t* config,
-        translation_unit_t* translation_unit, 
-        const char* parsed_filename UNUSED_PARAMETER)
+static int configuration_index(compilation_configuration_t* configuration)
 {
-    timing_t time_phases;
-    timing_start(&time_phases);
+    int i;
+    for (i = 0; i < compilation_process.num_configurations; i++)
+    {
+        if (compilation_process.configuration_set[i] == configuration)
+            return i;
+    }
 
-    start_compiler_phase_execution(config, translation_unit);
+    return -1;
+}
 
-    timing_end(&time_phases);
+static compilation_configuration_t* configuration_from_index(int index)
+{
+    if (index < 0)
+        return compilation_process.command_line_configuration;
 
-    if (CURRENT_CONFIGURATION->verbose)
+    ERROR_CONDITION(index >= compilation_process.num_configurations,
+            "Invalid configuration index %d", index);
+    return compilation_process.configuration_set[index];
+}
+
+static int primary_translation_unit_index(translation_unit_t* translation_unit)
+{
+    int i;
+    for (i = 0; i < compilation_process.num_translation_units; i++)
     {
-        fprintf(stderr, "Compiler phases pipeline executed in %.2f seconds\n", timing_elapsed(&time_phases));
+        if (compilation_process.translation_units[i]->translation_unit == translation_unit)
+            return i;
     }
+
+    return -1;
 }
 
-static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename)
+static void write_result_string(FILE* results_file, const char* str)
 {
-    timing_t timing_parsing;
+    fprintf(results_file, "%zu\n%s\n", strlen(str), str);
+}
 
-    if (CURRENT_CONFIGURATION->verbose)
-    {
-        fprintf(stderr, "Parsing file '%s' ('%s')\n", 
-                translation_unit->input_filename, parsed_filename);
-    }
+static const char* read_result_string(FILE* results_file)
+{
+    size_t length = 0;
+    if (fscanf(results_file, "%zu", &length) != 1
+            || fgetc(results_file) != '\n')
+        return NULL;
 
-    timing_start(&timing_parsing);
+    char str[length + 1];
+    if (fread(str, sizeof(char), length, results_file) != length)
+        return NULL;
+    str[length] = '\0';
 
-    AST parsed_tree = NULL;
+    return uniquestr(str);
+}
 
-    int parse_result = 0;
-    CXX_LANGUAGE()
+// Compiles the translation unit 'index' in the current (child) process and
+// writes in 'results_filename' what the parent needs to know about it. This
+// function does not return
+static void compile_translation_unit_in_child_process(int index,
+        int* num_linker_commands,
+        const char* results_filename)
+{
+    // Temporal files registered so far belong to the parent
+    temporal_files_detach();
+
+    // Make sure intermediate files of this process do not clash with
+    // those of other children
+    compilation_process.parallel_process = 1;
+
+    compilation_file_process_t* file_process = compilation_process.translation_units[index];
+    compile_every_translation_unit_aux_(1, &file_process);
+    wait_pending_native_compilations();
+
+    if (!CURRENT_CONFIGURATION->do_not_compile)
     {
-        parse_result = mcxxparse(&parsed_tree);
+        embed_files_of_translation_unit(file_process);
     }
 
-    C_LANGUAGE()
+    FILE* results_file = fopen(results_filename, "w");
+    if (results_file == NULL)
     {
-        parse_result = mc99parse(&parsed_tree);
+        fatal_error("Cannot create results file '%s' (%s)\n", results_filename, strerror(errno));
     }
 
-    FORTRAN_LANGUAGE()
+    if (file_process->translation_unit->output_filename != NULL)
     {
-        parse_result = mf03parse(&parsed_tree);
+        fprintf(results_file, "output\n");
+        write_result_string(results_file, file_process->translation_unit->output_filename);
     }
 
-    if (parse_result != 0)
+    // Report the linker commands that the compiler phases added while
+    // compiling this file
+    int i;
+    for (i = -1; i < compilation_process.num_configurations; i++)
     {
-        fatal_error("Compilation failed for file '%s'\n", translation_unit->input_filename);
-    }
+        compilation_configuration_t* configuration = configuration_from_index(i);
+        if (i < 0
+                && configuration_index(configuration) >= 0)
+            continue;
 
-    // Store the parsed tree as the unique child of AST_TRANSLATION_UNIT
-    // initialized in function initialize_semantic_analysis
-    ast_set_child(translation_unit->parsed_tree, 0, parsed_tree);
+        int j;
+        for (j = num_linker_commands[i + 1]; j < configuration->num_args_linker_command; j++)
+        {
+            parameter_linker_command_t* linker_command = configuration->linker_command[j];
 
-    // The filename can be used in the future (e.g. in tl-nanos.cpp)
-    ast_set_locus(translation_unit->parsed_tree, make_locus(translation_unit->input_filename, 0, 0));
-    
-    timing_end(&timing_parsing);
+            int translation_unit_index = -1;
+            const char* argument = linker_command->argument;
+            if (linker_command->translation_unit != NULL)
+            {
+                translation_unit_index = primary_translation_unit_index(linker_command->translation_unit);
+                if (translation_unit_index < 0)
+                {
+                    // Not known by the parent, so pass the file directly
+                    translation_unit_t* translation_unit = linker_command->translation_unit;
+                    const char* extension = get_extension_filename(translation_unit->input_filename);
+                    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
 
-    if (CURRENT_CONFIGURATION->verbose)
-    {
-        fprintf(stderr, "File '%s' ('%s') parsed in %.2f seconds\n", 
-                translation_unit->input_filename,
-                parsed_filename,
-                timing_elapsed(&timing_parsing));
+                    if (BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_LINK))
+                        continue;
+
+                    if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
+                            || translation_unit->output_filename == NULL)
+                        argument = translation_unit->input_filename;
+                    else
+                        argument = translation_unit->output_filename;
+                }
+            }
+
+            if (argument == NULL)
+                argument = "";
+
+            fprintf(results_file, "linker %d %d\n", i, translation_unit_index);
+            write_result_string(results_file, argument);
+        }
     }
 
-}
+    fclose(results_file);
 
-static AST get_translation_unit_node(void)
-{
-    return ASTMake1(AST_TRANSLATION_UNIT, NULL, make_locus("", 0, 0), NULL);
+    if (compilation_process.profile_phases)
+    {
+        // Every process writes its own trace file
+        const char* trace_filename = NULL;
+        if (compilation_process.profile_phases_trace != NULL)
+        {
+            uniquestr_sprintf(&trace_filename, "%s.%d",
+                    compilation_process.profile_phases_trace, (int)getpid());
+        }
+        compiler_phases_profile_report(trace_filename);
+    }
+
+    exit(compilation_process.execution_result);
 }
 
-static void initialize_semantic_analysis(translation_unit_t* translation_unit, 
-        const char* parsed_filename UNUSED_PARAMETER)
+static void merge_results_of_child_process(int index, const char* results_filename)
 {
-    translation_unit->parsed_tree = get_translation_unit_node();
-    if (IS_C_LANGUAGE
-            || IS_CXX_LANGUAGE)
-    {
-        c_initialize_translation_unit_scope(translation_unit);
-    }
-    else if (IS_FORTRAN_LANGUAGE)
+    FILE* results_file = fopen(results_filename, "r");
+    if (results_file == NULL)
     {
-        fortran_initialize_translation_unit_scope(translation_unit);
+        fatal_error("Cannot open results file '%s' (%s)\n", results_filename, strerror(errno));
     }
-    else
+
+    compilation_file_process_t* file_process = compilation_process.translation_units[index];
+
+    char kind[16];
+    while (fscanf(results_file, "%15s", kind) == 1)
     {
-        internal_error("Invalid language", 0);
+        if (strcmp(kind, "output") == 0)
+        {
+            fgetc(results_file);
+            const char* output_filename = read_result_string(results_file);
+            ERROR_CONDITION(output_filename == NULL, "Malformed results file '%s'", results_filename);
+
+            file_process->translation_unit->output_filename = output_filename;
+        }
+        else if (strcmp(kind, "linker") == 0)
+        {
+            int config_index = -1, translation_unit_index = -1;
+            if (fscanf(results_file, "%d %d", &config_index, &translation_unit_index) != 2)
+            {
+                internal_error("Malformed results file '%s'", results_filename);
+            }
+            fgetc(results_file);
+            const char* argument = read_result_string(results_file);
+            ERROR_CONDITION(argument == NULL, "Malformed results file '%s'", results_filename);
+
+            translation_unit_t* translation_unit = NULL;
+            if (translation_unit_index >= 0)
+            {
+                ERROR_CONDITION(translation_unit_index >= compilation_process.num_translation_units,
+                        "Invalid translation unit index %d", translation_unit_index);
+                translation_unit = compilation_process.translation_units[translation_unit_index]->translation_unit;
+            }
+
+            add_to_linker_command_configuration(argument, translation_unit,
+                    configuration_from_index(config_index));
+        }
+        else
+        {
+            internal_error("Malformed results file '%s'", results_filename);
+        }
     }
+
+    fclose(results_file);
+
+    file_process->already_compiled = 1;
 }
 
-static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename)
+static void compile_every_translation_unit_in_parallel(void)
 {
-    timing_t timing_semantic;
+    int num_translation_units = compilation_process.num_translation_units;
 
-    timing_start(&timing_semantic);
-    nodecl_t nodecl;
-    if (IS_C_LANGUAGE
-            || IS_CXX_LANGUAGE)
+    int child_pids[num_translation_units];
+    const char* results_filenames[num_translation_units];
+    memset(child_pids, 0, sizeof(child_pids));
+    memset(results_filenames, 0, sizeof(results_filenames));
+
+    // Snapshot of the linker commands so children only report new ones.
+    // Entry 0 is for the command line configuration
+    int num_linker_commands[compilation_process.num_configurations + 1];
+    int i;
+    for (i = -1; i < compilation_process.num_configurations; i++)
     {
-        nodecl = build_scope_translation_unit(translation_unit);
+        num_linker_commands[i + 1] = configuration_from_index(i)->num_args_linker_command;
     }
-    else if (IS_FORTRAN_LANGUAGE)
+
+    if (CURRENT_CONFIGURATION->verbose)
     {
-        nodecl = build_scope_fortran_translation_unit(translation_unit);
+        fprintf(stderr, "Compiling translation units using up to %d jobs\n",
+                compilation_process.num_jobs);
     }
-    else
+
+    // Make sure nothing buffered is output twice by the children
+    fflush(stdout);
+    fflush(stderr);
+
+    timing_t timing_parallel;
+    timing_start(&timing_parallel);
+
+    int next_translation_unit = 0;
+    int num_running = 0;
+    char failed = 0;
+    while (num_running > 0
+            || (!failed && next_translation_unit < num_translation_units))
+    {
+        // Spawn as many children as allowed
+        while (!failed
+                && num_running < compilation_process.num_jobs
+                && next_translation_unit < num_translation_units)
+        {
+            int current = next_translation_unit;
+            next_translation_unit++;
+
+            compilation_file_process_t* file_process = compilation_process.translation_units[current];
+            if (file_process->already_compiled)
+                continue;
+
+            const char* extension = get_extension_filename(file_process->translation_unit->input_filename);
+            struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+            if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA)
+            {
+                file_process->already_compiled = 1;
+                continue;
+            }
+
+            results_filenames[current] = new_temporal_file()->name;
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                fatal_error("error: could not fork to compile file '%s' (%s)",
+                        file_process->translation_unit->input_filename,
+                        strerror(errno));
+            }
+            else if (pid == 0)
+            {
+                compile_translation_unit_in_child_process(current,
+                        num_linker_commands,
+                        results_filenames[current]);
+            }
+
+            child_pids[current] = pid;
+            num_running++;
+        }
+
+        if (num_running == 0)
+            continue;
+
+        int status = 0;
+        int finished = wait_any_of_programs_async(child_pids, num_translation_units, &status);
+
+        child_pids[finished] = 0;
+        num_running--;
+
+        if (WIFEXITED(status)
+                && WEXITSTATUS(status) == 0)
+            continue;
+
+        if (WIFSIGNALED(status))
+        {
+            fprintf(stderr, "Compilation of file '%s' was ended with signal %d\n",
+                    compilation_process.translation_units[finished]->translation_unit->input_filename,
+                    WTERMSIG(status));
+        }
+
+        // Do not start new files but let the running ones finish
+        failed = 1;
+    }
+
+    if (failed)
+    {
+        // Children have already reported the error
+        exit(EXIT_FAILURE);
+    }
+
+    // Merge in the original order so linking is the same as a sequential
+    // compilation
+    for (i = 0; i < num_translation_units; i++)
+    {
+        if (results_filenames[i] != NULL)
+        {
+            merge_results_of_child_process(i, results_filenames[i]);
+        }
+    }
+
+    timing_end(&timing_parallel);
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "All translation units compiled in %.2f seconds\n",
+                timing_elapsed(&timing_parallel));
+    }
+}
+#endif
+
+static void compile_every_translation_unit(void)
+{
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (translation_units_can_be_compiled_in_parallel())
+    {
+        compile_every_translation_unit_in_parallel();
+        return;
+    }
+#endif
+
+    compile_every_translation_unit_aux_(compilation_process.num_translation_units,
+            compilation_process.translation_units);
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // Objects must be ready before embedding and linking
+    wait_pending_native_compilations();
+#endif
+}
+
+static void compiler_phases_pre_execution(
+        compilation_configuration_t* config,
+        translation_unit_t* translation_unit,
+        const char* parsed_filename UNUSED_PARAMETER)
+{
+    timing_t time_phases;
+    timing_start(&time_phases);
+
+    start_compiler_phase_pre_execution(config, translation_unit);
+
+    timing_end(&time_phases);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Early compiler phases pipeline executed in %.2f seconds\n", timing_elapsed(&time_phases));
+    }
+}
+
+static void compiler_phases_execution(
+        compilation_configuration_t* config,
+        translation_unit_t* translation_unit, 
+        const char* parsed_filename UNUSED_PARAMETER)
+{
+    timing_t time_phases;
+    timing_start(&time_phases);
+
+    start_compiler_phase_execution(config, translation_unit);
+
+    timing_end(&time_phases);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Compiler phases pipeline executed in %.2f seconds\n", timing_elapsed(&time_phases));
+    }
+}
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Waits for a preprocessor whose output has been streamed to the scanner.
+// The parser may stop reading early, so the rest of the output is discarded
+// to not block the preprocessor on a full pipe
+static int wait_streaming_preprocessor(int preprocessor_pid, int preprocessor_output_fd)
+{
+    char buffer[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(preprocessor_output_fd, buffer, sizeof(buffer))) != 0)
+    {
+        if (bytes_read < 0
+                && errno != EINTR)
+            break;
+    }
+    close(preprocessor_output_fd);
+
+    return wait_program_async(preprocessor_pid, CURRENT_CONFIGURATION->preprocessor_name);
+}
+#endif
+
+// preprocessor_pid is not negative if the file is being preprocessed while
+// parsed, then preprocessor_output_fd is its output
+static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename,
+        int preprocessor_pid, int preprocessor_output_fd)
+{
+    timing_t timing_parsing;
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Parsing file '%s' ('%s')\n", 
+                translation_unit->input_filename, parsed_filename);
+    }
+
+    timing_start(&timing_parsing);
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // Hold the parse diagnostics until the preprocessor has ended
+    if (preprocessor_pid >= 0)
+        diagnostic_context_push_buffered();
+#else
+    ERROR_CONDITION(preprocessor_pid >= 0, "Streaming the preprocessor is not supported", 0);
+#endif
+
+    AST parsed_tree = NULL;
+
+    int parse_result = 0;
+    CXX_LANGUAGE()
+    {
+        parse_result = mcxxparse(&parsed_tree);
+    }
+
+    C_LANGUAGE()
+    {
+        parse_result = mc99parse(&parsed_tree);
+    }
+
+    FORTRAN_LANGUAGE()
+    {
+        parse_result = mf03parse(&parsed_tree);
+    }
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (preprocessor_pid >= 0)
+    {
+        // A failure of the preprocessor explains the parse errors, so
+        // report it first
+        int result_preprocess = wait_streaming_preprocessor(preprocessor_pid,
+                preprocessor_output_fd);
+        if (result_preprocess != 0)
+        {
+            fprintf(stderr, "Preprocessing failed. Returned code %d\n",
+                    result_preprocess);
+            diagnostic_context_pop_and_commit();
+            fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
+        }
+        diagnostic_context_pop_and_commit();
+    }
+#endif
+
+    if (parse_result != 0)
+    {
+        fatal_error("Compilation failed for file '%s'\n", translation_unit->input_filename);
+    }
+
+    // Store the parsed tree as the unique child of AST_TRANSLATION_UNIT
+    // initialized in function initialize_semantic_analysis
+    ast_set_child(translation_unit->parsed_tree, 0, parsed_tree);
+
+    // The filename can be used in the future (e.g. in tl-nanos.cpp)
+    ast_set_locus(translation_unit->parsed_tree, make_locus(translation_unit->input_filename, 0, 0));
+    
+    timing_end(&timing_parsing);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "File '%s' ('%s') parsed in %.2f seconds\n", 
+                translation_unit->input_filename,
+                parsed_filename,
+                timing_elapsed(&timing_parsing));
+    }
+
+}
+
+static AST get_translation_unit_node(void)
+{
+    return ASTMake1(AST_TRANSLATION_UNIT, NULL, make_locus("", 0, 0), NULL);
+}
+
+static void initialize_semantic_analysis(translation_unit_t* translation_unit, 
+        const char* parsed_filename UNUSED_PARAMETER)
+{
+    translation_unit->parsed_tree = get_translation_unit_node();
+    if (IS_C_LANGUAGE
+            || IS_CXX_LANGUAGE)
+    {
+        c_initialize_translation_unit_scope(translation_unit);
+        overload_cache_clear();
+        deduction_cache_clear();
+    }
+    else if (IS_FORTRAN_LANGUAGE)
+    {
+        fortran_initialize_translation_unit_scope(translation_unit);
+    }
+    else
+    {
+        internal_error("Invalid language", 0);
+    }
+}
+
+static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename)
+{
+    timing_t timing_semantic;
+
+    timing_start(&timing_semantic);
+    nodecl_t nodecl;
+    if (IS_C_LANGUAGE
+            || IS_CXX_LANGUAGE)
+    {
+        nodecl = build_scope_translation_unit(translation_unit);
+    }
+    else if (IS_FORTRAN_LANGUAGE)
+    {
+        nodecl = build_scope_fortran_translation_unit(translation_unit);
+    }
+    else
     {
         internal_error("%s: invalid language kind\n", 
                 parsed_filename);
@@ -3579,7 +4264,8 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
 }
 
 static const char* codegen_translation_unit(translation_unit_t* translation_unit, 
-        const char* parsed_filename UNUSED_PARAMETER)
+        const char* parsed_filename UNUSED_PARAMETER,
+        const char* cached_source)
 {
     if (CURRENT_CONFIGURATION->do_not_prettyprint)
     {
@@ -3684,22 +4370,28 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
     // This will be used by a native compiler
     prettyprint_set_not_internal_output();
 
-    if (IS_C_LANGUAGE
+    if (cached_source != NULL)
+    {
+        result_cache_restore_source(cached_source, prettyprint_file);
+    }
+    else if (IS_C_LANGUAGE
             || IS_CXX_LANGUAGE)
     {
-        run_codegen_phase(prettyprint_file, translation_unit, output_filename);
+        run_codegen_phase(prettyprint_file, translation_unit, output_filename, 0);
     }
     else if (IS_FORTRAN_LANGUAGE)
     {
-        if (CURRENT_CONFIGURATION->output_column_width != 0)
+        if (CURRENT_CONFIGURATION->output_column_width != 0
+                && debug_options.fortran_split_after_codegen)
         {
+            // Split the whole output once codegen has finished
             temporal_file_t raw_prettyprint = new_temporal_file();
             FILE *raw_prettyprint_file = fopen(raw_prettyprint->name, "w");
             if (raw_prettyprint_file == NULL)
             {
                 fatal_error("Cannot create temporal file '%s' %s\n", raw_prettyprint->name, strerror(errno));
             }
-            run_codegen_phase(raw_prettyprint_file, translation_unit, output_filename);
+            run_codegen_phase(raw_prettyprint_file, translation_unit, output_filename, 0);
             fclose(raw_prettyprint_file);
 
             raw_prettyprint_file = fopen(raw_prettyprint->name, "r");
@@ -3712,7 +4404,9 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
         }
         else
         {
-            run_codegen_phase(prettyprint_file, translation_unit, output_filename);
+            // Lines longer than output_column_width are split by codegen
+            run_codegen_phase(prettyprint_file, translation_unit, output_filename,
+                    CURRENT_CONFIGURATION->output_column_width);
         }
     }
     else
@@ -3731,6 +4425,31 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
         fclose(prettyprint_file);
     }
 
+    if (translation_unit->result_cache_entry != NULL)
+    {
+        if (CURRENT_FILE_PROCESS->num_secondary_translation_units != 0)
+        {
+            // The files created by the compiler phases would be missing
+            translation_unit->result_cache_entry = NULL;
+        }
+        else if (diagnostics_get_warn_count() != 0
+                || diagnostics_get_info_count() != 0)
+        {
+            // They would not be emitted again when reusing the entry
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "File '%s' was diagnosed, not storing it in the result cache\n",
+                        translation_unit->input_filename);
+            }
+            translation_unit->result_cache_entry = NULL;
+        }
+        else if (cached_source == NULL
+                && prettyprint_file != stdout)
+        {
+            result_cache_store_source(translation_unit->result_cache_entry, output_filename);
+        }
+    }
+
     return output_filename;
 }
 
@@ -3925,33 +4644,24 @@ static void warn_preprocessor_flags(
     }
 }
 
-static const char* preprocess_single_file(const char* input_filename, const char* output_filename)
+// Number of entries needed by add_preprocessor_common_options plus the
+// input, -o output and the ending NULL
+static int get_num_preprocessor_parameters(void)
 {
     int num_arguments = count_null_ended_array((void**)CURRENT_CONFIGURATION->preprocessor_options);
 
-    char uses_stdout = CURRENT_CONFIGURATION->preprocessor_uses_stdout;
-
-    int num_parameters = num_arguments;
-
-    if (!uses_stdout)
-    {
-        // input -o output
-        num_parameters += 3;
-    }
-    else
-    {
-        // input
-        num_parameters += 1;
-    }
-
     // Guarding macros -D_MCC/-D_MCXX/-D_MF03 and -D_MERCURIUM
-    num_parameters += 2;
-
+    // input -o output
     // NULL
-    num_parameters += 1;
+    return num_arguments + 2 + 3 + 1;
+}
 
-    const char* preprocessor_options[num_parameters];
-    memset(preprocessor_options, 0, sizeof(preprocessor_options));
+// Adds the options of the configuration and the guarding macros. Returns
+// the number of options added
+static int add_preprocessor_common_options(const char* input_filename,
+        const char** preprocessor_options)
+{
+    int num_arguments = count_null_ended_array((void**)CURRENT_CONFIGURATION->preprocessor_options);
 
     int i;
     for (i = 0; i < num_arguments; i++)
@@ -3982,6 +4692,18 @@ static const char* preprocess_single_file(const char* input_filename, const char
     preprocessor_options[i] = "-D_MERCURIUM";
     i++;
 
+    return i;
+}
+
+static const char* preprocess_single_file(const char* input_filename, const char* output_filename)
+{
+    char uses_stdout = CURRENT_CONFIGURATION->preprocessor_uses_stdout;
+
+    const char* preprocessor_options[get_num_preprocessor_parameters()];
+    memset(preprocessor_options, 0, sizeof(preprocessor_options));
+
+    int i = add_preprocessor_common_options(input_filename, preprocessor_options);
+
     const char *preprocessed_filename = NULL;
 
     if (!CURRENT_CONFIGURATION->do_not_parse)
@@ -4052,6 +4774,42 @@ static const char* preprocess_translation_unit(translation_unit_t* translation_u
     return preprocess_single_file(input_filename, translation_unit->output_filename);
 }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Starts the preprocessor and returns a stream with its output, that can be
+// read while it is running. The preprocessor must be waited for using
+// *preprocessor_pid once the stream has been read
+static FILE* preprocess_translation_unit_to_stream(const char* input_filename,
+        int* preprocessor_pid)
+{
+    const char* preprocessor_options[get_num_preprocessor_parameters()];
+    memset(preprocessor_options, 0, sizeof(preprocessor_options));
+
+    int i = add_preprocessor_common_options(input_filename, preprocessor_options);
+
+    if (!CURRENT_CONFIGURATION->preprocessor_uses_stdout)
+    {
+        preprocessor_options[i] = uniquestr("-o"); 
+        i++;
+        preprocessor_options[i] = uniquestr("-");
+        i++;
+    }
+    preprocessor_options[i] = input_filename;
+    i++;
+
+    int stdout_fd = -1;
+    *preprocessor_pid = execute_program_to_pipe(CURRENT_CONFIGURATION->preprocessor_name,
+            preprocessor_options, &stdout_fd);
+
+    FILE* preprocessed_stream = fdopen(stdout_fd, "r");
+    if (preprocessed_stream == NULL)
+    {
+        fatal_error("error: cannot read the output of the preprocessor (%s)", strerror(errno));
+    }
+
+    return preprocessed_stream;
+}
+#endif
+
 // This one is meant to be used outside the driver. Some phases may need it
 const char* preprocess_file(const char* input_filename)
 {
@@ -4156,6 +4914,123 @@ static const char* fortran_prescan_file(translation_unit_t* translation_unit, co
 }
 #endif
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Native compilations running in background
+typedef struct pending_native_compilation_tag
+{
+    int process_id;
+    const char* input_filename;
+    const char* prettyprinted_filename;
+    const char* output_object_filename;
+    const char* result_cache_entry;
+    timing_t timing_compilation;
+} pending_native_compilation_t;
+
+static int num_pending_native_compilations = 0;
+static pending_native_compilation_t* pending_native_compilations = NULL;
+static const char* failed_native_compilation = NULL;
+
+static char native_compilation_can_be_asynchronous(void)
+{
+    return (compilation_process.num_native_jobs > 0
+            // Modules must be available for the next files
+            && CURRENT_CONFIGURATION->source_language != SOURCE_LANGUAGE_FORTRAN
+            && !debug_options.binary_check);
+}
+
+static void wait_one_pending_native_compilation(void)
+{
+    ERROR_CONDITION(num_pending_native_compilations == 0,
+            "There are no pending native compilations", 0);
+
+    int pids[num_pending_native_compilations];
+    int i;
+    for (i = 0; i < num_pending_native_compilations; i++)
+    {
+        pids[i] = pending_native_compilations[i].process_id;
+    }
+
+    int status = 0;
+    i = wait_any_of_programs_async(pids, num_pending_native_compilations, &status);
+
+    pending_native_compilation_t finished = pending_native_compilations[i];
+    pending_native_compilations[i] = pending_native_compilations[num_pending_native_compilations - 1];
+    num_pending_native_compilations--;
+
+    timing_end(&finished.timing_compilation);
+
+    int exit_status = exit_status_of_program_async(finished.input_filename, status);
+    if (exit_status != 0)
+    {
+        // Keep the first one, like a sequential compilation would do
+        if (failed_native_compilation == NULL)
+            failed_native_compilation = finished.input_filename;
+    }
+    else
+    {
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n",
+                    finished.input_filename,
+                    finished.prettyprinted_filename,
+                    timing_elapsed(&finished.timing_compilation));
+        }
+
+        if (finished.result_cache_entry != NULL)
+        {
+            result_cache_store_object(finished.result_cache_entry, finished.output_object_filename);
+        }
+    }
+}
+
+static void wait_pending_native_compilations(void)
+{
+    while (num_pending_native_compilations > 0)
+    {
+        wait_one_pending_native_compilation();
+    }
+
+    if (failed_native_compilation != NULL)
+    {
+        fatal_error("Native compilation failed for file '%s'", failed_native_compilation);
+    }
+}
+
+static void start_native_compilation_async(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        const char* output_object_filename,
+        const char** native_compilation_args)
+{
+    if (pending_native_compilations == NULL)
+    {
+        pending_native_compilations = NEW_VEC0(pending_native_compilation_t,
+                compilation_process.num_native_jobs);
+    }
+
+    // Do not go beyond the allowed number of background compilations
+    while (num_pending_native_compilations == compilation_process.num_native_jobs)
+    {
+        wait_one_pending_native_compilation();
+    }
+
+    if (failed_native_compilation != NULL)
+    {
+        // Do not start anything else if something failed
+        wait_pending_native_compilations();
+    }
+
+    pending_native_compilation_t* pending = &pending_native_compilations[num_pending_native_compilations];
+    pending->input_filename = translation_unit->input_filename;
+    pending->prettyprinted_filename = prettyprinted_filename;
+    pending->output_object_filename = output_object_filename;
+    pending->result_cache_entry = translation_unit->result_cache_entry;
+    timing_start(&pending->timing_compilation);
+    pending->process_id = execute_program_async(CURRENT_CONFIGURATION->native_compiler_name,
+            native_compilation_args);
+    num_pending_native_compilations++;
+}
+#endif
+
 static void native_compilation(translation_unit_t* translation_unit, 
         const char* prettyprinted_filename, 
         char remove_input)
@@ -4199,6 +5074,24 @@ static void native_compilation(translation_unit_t* translation_unit,
         output_object_filename = translation_unit->output_filename;
     }
 
+    if (translation_unit->result_cache_entry != NULL)
+    {
+        const char* cached_object = result_cache_get_object(translation_unit->result_cache_entry);
+        if (cached_object != NULL)
+        {
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "Reusing object of result cache entry '%s' as '%s'\n",
+                        translation_unit->result_cache_entry, output_object_filename);
+            }
+            if (copy_file(cached_object, output_object_filename) != 0)
+            {
+                fatal_error("Cannot copy cached object '%s' into '%s'", cached_object, output_object_filename);
+            }
+            return;
+        }
+    }
+
     int num_args_compiler = count_null_ended_array((void**)CURRENT_CONFIGURATION->native_compiler_options);
 
     int num_arguments = num_args_compiler;
@@ -4319,6 +5212,15 @@ static void native_compilation(translation_unit_t* translation_unit,
                 prettyprinted_filename, output_object_filename);
     }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (native_compilation_can_be_asynchronous())
+    {
+        start_native_compilation_async(translation_unit, prettyprinted_filename,
+                output_object_filename, native_compilation_args);
+        return;
+    }
+#endif
+
     timing_t timing_compilation;
     timing_start(&timing_compilation);
 
@@ -4333,6 +5235,11 @@ static void native_compilation(translation_unit_t* translation_unit,
     }
     timing_end(&timing_compilation);
 
+    if (translation_unit->result_cache_entry != NULL)
+    {
+        result_cache_store_object(translation_unit->result_cache_entry, output_object_filename);
+    }
+
     if (CURRENT_CONFIGURATION->verbose)
     {
         fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n", 
@@ -4398,154 +5305,162 @@ static void native_compilation(translation_unit_t* translation_unit,
     }
 }
 
-static void embed_files(void)
+static void embed_files_of_translation_unit(compilation_file_process_t* file_process)
 {
-    if (CURRENT_CONFIGURATION->do_not_compile)
+    int num_secondary_translation_units = 
+        file_process->num_secondary_translation_units;
+    compilation_file_process_t** secondary_translation_units = 
+        file_process->secondary_translation_units;
+
+    if (num_secondary_translation_units == 0)
         return;
 
-    char there_are_secondary_files = 0;
-    int i;
-    for (i = 0; i < compilation_process.num_translation_units; i++)
-    {
-        if (compilation_process.translation_units[i]->num_secondary_translation_units != 0)
-        {
-            there_are_secondary_files = 1;
-        }
-    }
+    translation_unit_t* translation_unit = file_process->translation_unit;
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
 
-    if (!there_are_secondary_files)
+    // We do not have to embed linker data
+    if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
+            // Or languages that we know that cannot be embedded
+            || ((current_extension->source_kind & SOURCE_KIND_DO_NOT_EMBED) == SOURCE_KIND_DO_NOT_EMBED))
+    {
         return;
+    }
+    const char *output_filename = translation_unit->output_filename;
 
-    for (i = 0; i < compilation_process.num_translation_units; i++)
+    if (CURRENT_CONFIGURATION->verbose)
     {
-        int num_secondary_translation_units = 
-            compilation_process.translation_units[i]->num_secondary_translation_units;
-        compilation_file_process_t** secondary_translation_units = 
-            compilation_process.translation_units[i]->secondary_translation_units;
+        fprintf(stderr, "Embedding secondary files into '%s'\n", output_filename);
+    }
 
-        translation_unit_t* translation_unit = compilation_process.translation_units[i]->translation_unit;
-        const char* extension = get_extension_filename(translation_unit->input_filename);
-        struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+#define MAX_EMBED_MODES 8
+    int num_embed_modes_seen = 0;
+    int embed_modes[MAX_EMBED_MODES] = { 0 };
+    void *embed_mode_data[MAX_EMBED_MODES] = { 0 };
+
+    int j;
+    for (j = 0; j < num_secondary_translation_units; j++)
+    {
+        compilation_file_process_t* secondary_compilation_file = secondary_translation_units[j];
+        compilation_configuration_t* secondary_configuration = secondary_compilation_file->compilation_configuration;
 
-        // We do not have to embed linker data
+        // If a .o file is introduced by a phase, then it will not have an
+        // output filename because we usually compute these very late in
+        // the linking step and we will end using the same name.
+        extension = get_extension_filename(secondary_compilation_file->translation_unit->input_filename);
+        current_extension = fileextensions_lookup(extension, strlen(extension));
         if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
-                // Or languages that we know that cannot be embedded
-                || ((current_extension->source_kind & SOURCE_KIND_DO_NOT_EMBED) == SOURCE_KIND_DO_NOT_EMBED))
+                && secondary_compilation_file->translation_unit->output_filename == NULL)
         {
-            continue;
+            secondary_compilation_file->translation_unit->output_filename =
+                secondary_compilation_file->translation_unit->input_filename;
         }
-        const char *output_filename = translation_unit->output_filename;
 
-        if (CURRENT_CONFIGURATION->verbose)
+        target_options_map_t* target_options = get_target_options(secondary_configuration, CURRENT_CONFIGURATION->configuration_name);
+
+        if (target_options == NULL)
         {
-            fprintf(stderr, "Embedding secondary files into '%s'\n", output_filename);
+            fatal_error("During embedding, there are no target options defined from profile '%s' to profile '%s' in the configuration\n",
+                    secondary_configuration->configuration_name,
+                    CURRENT_CONFIGURATION->configuration_name);
         }
 
-#define MAX_EMBED_MODES 8
-        int num_embed_modes_seen = 0;
-        int embed_modes[MAX_EMBED_MODES] = { 0 };
-        void *embed_mode_data[MAX_EMBED_MODES] = { 0 };
-
-        int j;
-        for (j = 0; j < num_secondary_translation_units; j++)
-        {
-            compilation_file_process_t* secondary_compilation_file = secondary_translation_units[j];
-            compilation_configuration_t* secondary_configuration = secondary_compilation_file->compilation_configuration;
-
-            // If a .o file is introduced by a phase, then it will not have an
-            // output filename because we usually compute these very late in
-            // the linking step and we will end using the same name.
-            extension = get_extension_filename(secondary_compilation_file->translation_unit->input_filename);
-            current_extension = fileextensions_lookup(extension, strlen(extension));
-            if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
-                    && secondary_compilation_file->translation_unit->output_filename == NULL)
-            {
-                secondary_compilation_file->translation_unit->output_filename =
-                    secondary_compilation_file->translation_unit->input_filename;
-            }
+        if (!target_options->do_embedding)
+        {
+            // Do nothing if we are told not to embed
+            continue;
+        }
 
-            target_options_map_t* target_options = get_target_options(secondary_configuration, CURRENT_CONFIGURATION->configuration_name);
+        // Remember the embed mode to run the collective embed procedure later
+        ERROR_CONDITION(num_embed_modes_seen == MAX_EMBED_MODES, "Too many embed modes. Max is %d", MAX_EMBED_MODES);
+        int k; 
+        char found = 0;
 
-            if (target_options == NULL)
-            {
-                fatal_error("During embedding, there are no target options defined from profile '%s' to profile '%s' in the configuration\n",
-                        secondary_configuration->configuration_name,
-                        CURRENT_CONFIGURATION->configuration_name);
-            }
+        void **embed_data = NULL;
 
-            if (!target_options->do_embedding)
+        for (k = 0;  k < num_embed_modes_seen && !found; k++)
+        {
+            if (embed_modes[k] == target_options->embedding_mode)
             {
-                // Do nothing if we are told not to embed
-                continue;
+                found = 1;
+                break;
             }
+        }
+        if (!found)
+        {
+            embed_modes[num_embed_modes_seen] = target_options->embedding_mode;
+            embed_data = &(embed_mode_data[num_embed_modes_seen]);
+            num_embed_modes_seen++;
+        }
+        else
+        {
+            embed_data = &(embed_mode_data[k]);
+        }
 
-            // Remember the embed mode to run the collective embed procedure later
-            ERROR_CONDITION(num_embed_modes_seen == MAX_EMBED_MODES, "Too many embed modes. Max is %d", MAX_EMBED_MODES);
-            int k; 
-            char found = 0;
-
-            void **embed_data = NULL;
-
-            for (k = 0;  k < num_embed_modes_seen && !found; k++)
-            {
-                if (embed_modes[k] == target_options->embedding_mode)
+        // Single embed
+        switch (target_options->embedding_mode)
+        {
+            case EMBEDDING_MODE_BFD:
                 {
-                    found = 1;
+                    multifile_embed_bfd_single(embed_data, secondary_compilation_file);
                     break;
                 }
-            }
-            if (!found)
-            {
-                embed_modes[num_embed_modes_seen] = target_options->embedding_mode;
-                embed_data = &(embed_mode_data[num_embed_modes_seen]);
-                num_embed_modes_seen++;
-            }
-            else
-            {
-                embed_data = &(embed_mode_data[k]);
-            }
+            case EMBEDDING_MODE_PARTIAL_LINKING:
+                {
+                    multifile_embed_partial_linking_single(
+                            embed_data, secondary_compilation_file, output_filename);
+                    break;
+                }
+            default:
+                internal_error("Unknown embedding mode", 0);
+        }
 
-            // Single embed
-            switch (target_options->embedding_mode)
-            {
-                case EMBEDDING_MODE_BFD:
-                    {
-                        multifile_embed_bfd_single(embed_data, secondary_compilation_file);
-                        break;
-                    }
-                case EMBEDDING_MODE_PARTIAL_LINKING:
-                    {
-                        multifile_embed_partial_linking_single(
-                                embed_data, secondary_compilation_file, output_filename);
-                        break;
-                    }
-                default:
-                    internal_error("Unknown embedding mode", 0);
-            }
+    }
 
+    // Collective embed
+    for (j = 0; j < num_embed_modes_seen; j++)
+    {
+        switch (embed_modes[j])
+        {
+            case EMBEDDING_MODE_BFD:
+                {
+                    multifile_embed_bfd_collective(&(embed_mode_data[j]), output_filename);
+                    break;
+                }
+            case EMBEDDING_MODE_PARTIAL_LINKING:
+                {
+                    // We don't need to do anything, secondary translation units
+                    // are already embedded in the output linker object
+                    break;
+                }
+            default:
+                internal_error("Unknown embedding mode", 0);
         }
+    }
+}
+
+static void embed_files(void)
+{
+    if (CURRENT_CONFIGURATION->do_not_compile)
+        return;
 
-        // Collective embed
-        for (j = 0; j < num_embed_modes_seen; j++)
+    char there_are_secondary_files = 0;
+    int i;
+    for (i = 0; i < compilation_process.num_translation_units; i++)
+    {
+        if (compilation_process.translation_units[i]->num_secondary_translation_units != 0)
         {
-            switch (embed_modes[j])
-            {
-                case EMBEDDING_MODE_BFD:
-                    {
-                        multifile_embed_bfd_collective(&(embed_mode_data[j]), output_filename);
-                        break;
-                    }
-                case EMBEDDING_MODE_PARTIAL_LINKING:
-                    {
-                        // We don't need to do anything, secondary translation units
-                        // are already embedded in the output linker object
-                        break;
-                    }
-                default:
-                    internal_error("Unknown embedding mode", 0);
-            }
+            there_are_secondary_files = 1;
         }
     }
+
+    if (!there_are_secondary_files)
+        return;
+
+    for (i = 0; i < compilation_process.num_translation_units; i++)
+    {
+        embed_files_of_translation_unit(compilation_process.translation_units[i]);
+    }
 }
 
 static void link_files(const char** file_list, int num_files,
@@ -5310,6 +6225,12 @@ static void print_memory_report(void)
     fprintf(stderr, "Size of a type (bytes): %zd\n",
             get_type_t_size());
 
+    fprintf(stderr, "\n");
+    name_lookup_cache_stats();
+    overload_cache_stats();
+    deduction_cache_stats();
+    template_specialization_index_stats();
+
     // -- AST
     fprintf(stderr, "\n");
     fprintf(stderr, "Abstract Syntax Tree(s) breakdown\n");
@@ -5339,6 +6260,7 @@ static void print_memory_report(void)
 
     fprintf(stderr, " - AST node size (bytes): %d\n", ast_node_size());
     fprintf(stderr, " - Total number of AST nodes: %d\n", num_nodes);
+    ast_arena_stats();
 
     for (i = 0; i < MCXX_MAX_AST_CHILDREN + 1; i++)
     {
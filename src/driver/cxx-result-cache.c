@@ -0,0 +1,475 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+#include "cxx-result-cache.h"
+#include "cxx-driver-utils.h"
+#include "cxx-driver-build-info.h"
+#include "cxx-compilerphases.hpp"
+#include "cxx-utils.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// Increase this when the layout of the cache entries changes
+enum { CURRENT_RESULT_CACHE_VERSION = 2 };
+
+// The full key of an entry. Its hash only names the entry directory, the key
+// itself is stored in the entry and compared when looking it up
+typedef struct result_cache_key_tag
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} result_cache_key_t;
+
+static void key_add_data(result_cache_key_t* key, const void* data, size_t size)
+{
+    if (key->size + size > key->capacity)
+    {
+        key->capacity = 2 * (key->size + size) + 256;
+        key->data = NEW_REALLOC(char, key->data, key->capacity);
+    }
+    memcpy(key->data + key->size, data, size);
+    key->size += size;
+}
+
+static void key_add_string(result_cache_key_t* key, const char* str)
+{
+    if (str == NULL)
+        str = "";
+    // Include the ending NUL so consecutive strings cannot be confused
+    key_add_data(key, str, strlen(str) + 1);
+}
+
+static void key_add_int(result_cache_key_t* key, long long value)
+{
+    key_add_data(key, &value, sizeof(value));
+}
+
+static void key_add_file(result_cache_key_t* key, const char* filename)
+{
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+    {
+        fatal_error("error: cannot open file '%s' (%s)\n", filename, strerror(errno));
+    }
+
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        key_add_data(key, buffer, n);
+    }
+    fclose(f);
+
+    // Separate from whatever comes next
+    key_add_int(key, -1);
+}
+
+static void key_add_null_ended_array(result_cache_key_t* key, const char** array)
+{
+    int i;
+    for (i = 0; array != NULL && array[i] != NULL; i++)
+    {
+        key_add_string(key, array[i]);
+    }
+    // Separate from whatever comes next
+    key_add_int(key, i);
+}
+
+// The identity of a file: where it actually is, its size and when it was last
+// modified, so upgrading it in place invalidates the entries
+static void key_add_file_identity(result_cache_key_t* key, const char* path)
+{
+    char* real_path = NULL;
+    struct stat buf;
+    if (path == NULL
+            || (real_path = realpath(path, NULL)) == NULL
+            || stat(real_path, &buf) != 0)
+    {
+        // Not found, the name is all we know
+        key_add_int(key, -1);
+    }
+    else
+    {
+        key_add_string(key, real_path);
+        key_add_int(key, buf.st_size);
+        key_add_int(key, buf.st_mtime);
+    }
+
+    free(real_path);
+}
+
+static void key_add_program(result_cache_key_t* key, const char* program_name)
+{
+    key_add_string(key, program_name);
+
+    const char* path = NULL;
+    if (strchr(program_name, '/') != NULL)
+    {
+        path = program_name;
+    }
+    else
+    {
+        const char* path_env = getenv("PATH");
+        char* path_list = xstrdup(path_env != NULL ? path_env : "");
+
+        char* current_dir;
+        for (current_dir = strtok(path_list, ":");
+                current_dir != NULL && path == NULL;
+                current_dir = strtok(NULL, ":"))
+        {
+            const char* candidate = strappend(strappend(current_dir, "/"), program_name);
+            if (access(candidate, X_OK) == 0)
+                path = candidate;
+        }
+
+        DELETE(path_list);
+    }
+
+    key_add_file_identity(key, path);
+}
+
+static void key_add_phase_library(result_cache_key_t* key, const char* library_name)
+{
+    key_add_string(key, library_name);
+    key_add_file_identity(key, compiler_phase_get_library_path(library_name));
+}
+
+// Everything that determines the output of the compiler phases and of the
+// native compiler, but the input itself
+static void add_configuration_key(result_cache_key_t* key)
+{
+    key_add_string(key, MCXX_BUILD_VERSION);
+    key_add_int(key, CURRENT_RESULT_CACHE_VERSION);
+
+    // This compiler
+    key_add_program(key, strappend(strappend(compilation_process.home_directory, "/"),
+                compilation_process.exec_basename));
+
+    // Flags of the command line
+    key_add_int(key, compilation_process.original_argc);
+    int i;
+    for (i = 0; i < compilation_process.original_argc; i++)
+    {
+        key_add_string(key, compilation_process.original_argv[i]);
+    }
+
+    // The profile and the profiles it inherits from. Lines are evaluated
+    // using flags whose value depend on the command line, so the
+    // configuration files where they come from are enough
+    const char* added_files[64];
+    int num_added_files = 0;
+
+    compilation_configuration_t* configuration;
+    for (configuration = CURRENT_CONFIGURATION;
+            configuration != NULL;
+            configuration = configuration->base_configuration)
+    {
+        key_add_string(key, configuration->configuration_name);
+
+        for (i = 0; i < configuration->num_configuration_lines; i++)
+        {
+            struct compilation_configuration_line* line = configuration->configuration_lines[i];
+            key_add_string(key, line->name);
+            key_add_string(key, line->index);
+            key_add_string(key, line->value);
+
+            if (line->filename == NULL)
+                continue;
+
+            char already_added = 0;
+            int j;
+            for (j = 0; j < num_added_files && !already_added; j++)
+            {
+                already_added = (strcmp(added_files[j], line->filename) == 0);
+            }
+
+            if (!already_added
+                    && num_added_files < (int)(sizeof(added_files) / sizeof(added_files[0]))
+                    && access(line->filename, R_OK) == 0)
+            {
+                key_add_file(key, line->filename);
+                added_files[num_added_files] = line->filename;
+                num_added_files++;
+            }
+        }
+    }
+
+    // The set of compiler phases, the libraries implementing them and their
+    // parameters. Codegen is loaded later unless the profile sets it
+    for (i = 0; i < CURRENT_CONFIGURATION->num_compiler_phases; i++)
+    {
+        compiler_phase_loader_t* phase_loader = CURRENT_CONFIGURATION->phase_loader[i];
+        if (phase_loader->func == compiler_special_phase_set_dto)
+            key_add_string(key, phase_loader->data);
+        else
+            key_add_phase_library(key, phase_loader->data);
+    }
+    key_add_phase_library(key, "libcodegen-cxx.so");
+    for (i = 0; i < CURRENT_CONFIGURATION->num_external_vars; i++)
+    {
+        key_add_string(key, CURRENT_CONFIGURATION->external_vars[i]->name);
+        key_add_string(key, CURRENT_CONFIGURATION->external_vars[i]->value);
+    }
+
+    // The native compiler
+    key_add_program(key, CURRENT_CONFIGURATION->native_compiler_name);
+    key_add_null_ended_array(key, CURRENT_CONFIGURATION->native_compiler_options);
+}
+
+// Nonzero if filename contains exactly size bytes of data
+static char file_has_contents(const char* filename, const char* data, size_t size)
+{
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+        return 0;
+
+    char same = 1;
+    char buffer[65536];
+    size_t offset = 0;
+    size_t n;
+    while (same
+            && (n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        same = (offset + n <= size
+                && memcmp(buffer, data + offset, n) == 0);
+        offset += n;
+    }
+    fclose(f);
+
+    return same && offset == size;
+}
+
+// Nonzero if both files have the same contents
+static char files_have_same_contents(const char* filename_1, const char* filename_2)
+{
+    FILE* f1 = fopen(filename_1, "rb");
+    if (f1 == NULL)
+        return 0;
+    FILE* f2 = fopen(filename_2, "rb");
+    if (f2 == NULL)
+    {
+        fclose(f1);
+        return 0;
+    }
+
+    char same = 1;
+    char buffer_1[65536], buffer_2[65536];
+    size_t n1, n2;
+    do
+    {
+        n1 = fread(buffer_1, 1, sizeof(buffer_1), f1);
+        n2 = fread(buffer_2, 1, sizeof(buffer_2), f2);
+        same = (n1 == n2 && memcmp(buffer_1, buffer_2, n1) == 0);
+    } while (same && n1 > 0);
+
+    fclose(f1);
+    fclose(f2);
+
+    return same;
+}
+
+static const char* get_entry_file(const char* entry_directory, const char* name)
+{
+    return strappend(strappend(entry_directory, "/"), name);
+}
+
+static const char* get_existing_entry_file(const char* entry_directory, const char* name)
+{
+    const char* filename = get_entry_file(entry_directory, name);
+    if (access(filename, R_OK) != 0)
+        return NULL;
+    return filename;
+}
+
+const char* result_cache_get_source(const char* entry_directory)
+{
+    return get_existing_entry_file(entry_directory, "source");
+}
+
+const char* result_cache_get_object(const char* entry_directory)
+{
+    return get_existing_entry_file(entry_directory, "object");
+}
+
+void result_cache_restore_source(const char* cached_source, FILE* output)
+{
+    FILE* f = fopen(cached_source, "r");
+    if (f == NULL)
+    {
+        fatal_error("Cannot open cached file '%s' (%s)", cached_source, strerror(errno));
+    }
+
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        if (fwrite(buffer, 1, n, output) != n)
+        {
+            fatal_error("Error while writing cached file '%s' (%s)", cached_source, strerror(errno));
+        }
+    }
+    fclose(f);
+}
+
+// This may be called once the configuration of the entry is not the current
+// one anymore, so everything is derived from the entry directory
+static char store_file(const char* entry_directory, const char* name, const char* filename)
+{
+    const char* last_separator = strrchr(entry_directory, '/');
+    ERROR_CONDITION(last_separator == NULL, "Invalid result cache entry '%s'", entry_directory);
+
+    char cache_dir[last_separator - entry_directory + 1];
+    memcpy(cache_dir, entry_directory, last_separator - entry_directory);
+    cache_dir[last_separator - entry_directory] = '\0';
+
+    if (cache_dir[0] != '\0'
+            && mkdir(cache_dir, 0777) != 0
+            && errno != EEXIST)
+    {
+        fprintf(stderr, "warning: cannot create result cache directory '%s' (%s)\n",
+                cache_dir, strerror(errno));
+        return 0;
+    }
+    if (mkdir(entry_directory, 0777) != 0
+            && errno != EEXIST)
+    {
+        fprintf(stderr, "warning: cannot create result cache entry '%s' (%s)\n",
+                entry_directory, strerror(errno));
+        return 0;
+    }
+
+    // Copy to a private file and rename it at the end, so concurrent
+    // compilations never see a partially written file
+    const char* entry_file = get_entry_file(entry_directory, name);
+
+    const char* temporary_file = NULL;
+    uniquestr_sprintf(&temporary_file, "%s.%d.tmp", entry_file, (int)getpid());
+
+    if (copy_file(filename, temporary_file) != 0
+            || rename(temporary_file, entry_file) != 0)
+    {
+        fprintf(stderr, "warning: cannot store '%s' in result cache entry '%s' (%s)\n",
+                filename, entry_directory, strerror(errno));
+        unlink(temporary_file);
+        return 0;
+    }
+    return 1;
+}
+
+// Like store_file but writing the key. The entry directory already exists
+static char store_key(const char* entry_directory, const result_cache_key_t* key)
+{
+    const char* key_file = get_entry_file(entry_directory, "key");
+
+    const char* temporary_file = NULL;
+    uniquestr_sprintf(&temporary_file, "%s.%d.tmp", key_file, (int)getpid());
+
+    FILE* f = fopen(temporary_file, "wb");
+    char ok = (f != NULL);
+    if (ok)
+    {
+        ok = (fwrite(key->data, 1, key->size, f) == key->size);
+        ok = (fclose(f) == 0) && ok;
+    }
+
+    if (!ok
+            || rename(temporary_file, key_file) != 0)
+    {
+        fprintf(stderr, "warning: cannot store the key of result cache entry '%s' (%s)\n",
+                entry_directory, strerror(errno));
+        unlink(temporary_file);
+        return 0;
+    }
+    return 1;
+}
+
+const char* result_cache_entry_directory(const char* preprocessed_filename)
+{
+    result_cache_key_t key;
+    memset(&key, 0, sizeof(key));
+
+    add_configuration_key(&key);
+
+    uint64_t h = FNV_HASH_INITIAL;
+    h = fnv_hash_data(h, key.data, key.size);
+    h = fnv_hash_file(h, preprocessed_filename);
+
+    const char* cache_dir = CURRENT_CONFIGURATION->result_cache_dir;
+
+    char c[strlen(cache_dir) + 32];
+    snprintf(c, sizeof(c), "%s/%016llx", cache_dir, (unsigned long long)h);
+    c[sizeof(c) - 1] = '\0';
+
+    const char* entry_directory = uniquestr(c);
+
+    const char* key_file = get_entry_file(entry_directory, "key");
+    const char* input_file = get_entry_file(entry_directory, "input");
+
+    if (access(key_file, R_OK) == 0)
+    {
+        // An existing entry must have been created for this very key and
+        // input, otherwise a different one with the same hash owns it
+        if (!file_has_contents(key_file, key.data, key.size)
+                || !files_have_same_contents(input_file, preprocessed_filename))
+        {
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "Result cache entry '%s' belongs to a different input, not caching\n",
+                        entry_directory);
+            }
+            entry_directory = NULL;
+        }
+    }
+    // New entry, claim it. The input goes first so a key is never seen
+    // without its input
+    else if (!store_file(entry_directory, "input", preprocessed_filename)
+            || !store_key(entry_directory, &key))
+    {
+        entry_directory = NULL;
+    }
+
+    DELETE(key.data);
+
+    return entry_directory;
+}
+
+void result_cache_store_source(const char* entry_directory, const char* source_filename)
+{
+    store_file(entry_directory, "source", source_filename);
+}
+
+void result_cache_store_object(const char* entry_directory, const char* object_filename)
+{
+    store_file(entry_directory, "object", object_filename);
+}
@@ -0,0 +1,64 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+#ifndef CXX_RESULT_CACHE_H
+#define CXX_RESULT_CACHE_H
+
+#include "cxx-macros.h"
+#include <stdio.h>
+
+MCXX_BEGIN_DECLS
+
+// Persistent cache of the results of compiling a file (--result-cache-dir).
+// Every entry is a directory keyed by the preprocessed file, the command
+// line, the profile (including the configuration files it comes from, the
+// compiler phases and their parameters) and the native compiler. It keeps
+// the generated source and the object of the native compiler. Directories are
+// named after a hash of the key but the entry stores the full key, including
+// the preprocessed file, which is compared when looking it up
+
+// Returns the entry directory for the given preprocessed file, creating it
+// if it does not exist yet. Returns NULL if the entry cannot be used, e.g.
+// because it belongs to a different key with the same hash
+const char* result_cache_entry_directory(const char* preprocessed_filename);
+
+// Return the cached generated source or object of an entry, or NULL if the
+// entry does not have them yet
+const char* result_cache_get_source(const char* entry_directory);
+const char* result_cache_get_object(const char* entry_directory);
+
+// Write the cached generated source to output
+void result_cache_restore_source(const char* cached_source, FILE* output);
+
+// Store the generated source or the object into an entry
+void result_cache_store_source(const char* entry_directory, const char* source_filename);
+void result_cache_store_object(const char* entry_directory, const char* object_filename);
+
+MCXX_END_DECLS
+
+#endif // CXX_RESULT_CACHE_H
@@ -34,6 +34,14 @@
 
 MCXX_BEGIN_DECLS
 
+enum
+{
+    // Most nodes have at most two children so they are kept in the node
+    AST_INLINE_CHILDREN = 2,
+    AST_NUM_AMBIG_BITS = 32 - 11 - MCXX_MAX_AST_CHILDREN - 1,
+    AST_MAX_AMBIGUITIES = (1 << AST_NUM_AMBIG_BITS) - 1,
+};
+
 // Definition of the type
 typedef
 struct AST_tag
@@ -45,30 +53,119 @@ struct AST_tag
     unsigned int bitmap_sons:MCXX_MAX_AST_CHILDREN;
 
     // Number of ambiguities of this node
-    int num_ambig;
+    unsigned int num_ambig:AST_NUM_AMBIG_BITS;
 
-    // Parent node
-    struct AST_tag* parent;
+    // The tree rooted here has a cached structural hash. If a node has it,
+    // all its children have it too. The hashes themselves are kept aside
+    // (see ast_get_structural_hash) since few nodes ever get one
+    unsigned int has_structural_hash:1;
 
-    // Node locus
-    const locus_t* locus;
+    // Node locus, see locus_from_index
+    unsigned int locus_index;
 
     // Textual information linked to the node
     // normally the symbol or the literal
     const char* text;
 
+    // Parent node
+    struct AST_tag* parent;
+
+    // This is used by nodecl trees
+    struct nodecl_expr_info_tag* expr_info;
+
     union
     {
-        // The children of this tree (except for AST_AMBIGUITY)
+        // The children of this tree (except for AST_AMBIGUITY) when there
+        // are at most AST_INLINE_CHILDREN of them
+        struct AST_tag* inline_children[AST_INLINE_CHILDREN];
+        // Otherwise they are here
         struct AST_tag** children;
         // When type == AST_AMBIGUITY, all intepretations are here
         struct AST_tag** ambig;
     };
-
-    // This is used by nodecl trees
-    struct nodecl_expr_info_tag* expr_info;
 } AST_node_t;
 
+// AST nodes and children arrays are carved out of big chunks of memory.
+// Released objects are kept in free lists, one per size class, and reused
+// by later allocations. Chunks are never returned to the system.
+typedef
+struct ast_arena_tag
+{
+    // Unused part of the current chunk
+    char* current;
+    char* end;
+
+    // Free list 0 is for nodes, free list n for arrays of n children
+    void* free_list[MCXX_MAX_AST_CHILDREN + 1];
+
+    // Used by memory report
+    size_t bytes_in_use;
+    size_t bytes_reserved;
+
+    // Number of nodes ever allocated and released. Like the rest of the
+    // arena they are not synchronized: nodes are only created by one thread
+    size_t num_nodes_allocated;
+    size_t num_nodes_released;
+} ast_arena_t;
+
+LIBMCXX_EXTERN ast_arena_t ast_arena;
+
+// Slow path of ast_arena_allocate
+LIBMCXX_EXTERN void* ast_arena_allocate_in_new_chunk(size_t size);
+
+static inline void* ast_arena_allocate(int size_class, size_t size)
+{
+    void* result = ast_arena.free_list[size_class];
+    ast_arena.bytes_in_use += size;
+    if (result != NULL)
+    {
+        ast_arena.free_list[size_class] = *(void**)result;
+        return result;
+    }
+
+    if (__builtin_expect((size_t)(ast_arena.end - ast_arena.current) < size, 0))
+        return ast_arena_allocate_in_new_chunk(size);
+
+    result = ast_arena.current;
+    ast_arena.current += size;
+    return result;
+}
+
+static inline void ast_arena_release(void* p, int size_class, size_t size)
+{
+    *(void**)p = ast_arena.free_list[size_class];
+    ast_arena.free_list[size_class] = p;
+    ast_arena.bytes_in_use -= size;
+}
+
+static inline AST ast_allocate_node(void)
+{
+    ast_arena.num_nodes_allocated++;
+    return (AST)ast_arena_allocate(0, sizeof(AST_node_t));
+}
+
+static inline void ast_release_node(AST a)
+{
+    ast_arena.num_nodes_released++;
+    ast_arena_release(a, 0, sizeof(AST_node_t));
+}
+
+static inline AST* ast_allocate_children(int num_children)
+{
+    if (num_children == 0)
+        return NULL;
+
+    return (AST*)ast_arena_allocate(num_children, num_children * sizeof(AST));
+}
+
+static inline void ast_release_children(AST* children, int num_children)
+{
+    if (children == NULL)
+        return;
+
+    ast_arena_release(children, num_children, num_children * sizeof(AST));
+}
+
 
 static inline node_t ast_get_kind(const_AST a)
 {
@@ -100,8 +197,20 @@ static inline void ast_set_text(AST a, const char* str)
     a->text = str;
 }
 
+static inline void ast_invalidate_structural_hash(AST a)
+{
+    // Nodes without a cached hash cannot have ancestors with one
+    while (a != NULL
+            && a->has_structural_hash)
+    {
+        ast_forget_structural_hash(a);
+        a = a->parent;
+    }
+}
+
 static inline void ast_set_kind(AST a, node_t node_type)
 {
+    ast_invalidate_structural_hash(a);
     a->node_type = node_type;
 }
 
@@ -135,11 +244,22 @@ ALWAYS_INLINE static inline char ast_has_son(const_AST a, int son)
     return (((1 << son) & a->bitmap_sons) != 0);
 }
 
+static inline int ast_count_bitmap(unsigned int bitmap);
+
+// Returns where the children of a non-ambiguous node are stored
+ALWAYS_INLINE static inline AST* ast_children_storage(AST a)
+{
+    if (ast_count_bitmap(a->bitmap_sons) <= AST_INLINE_CHILDREN)
+        return a->inline_children;
+    else
+        return a->children;
+}
+
 ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 {
     if (ast_has_son(a, num_child))
     {
-        return a->children[ast_son_num_to_son_index(a, num_child)];
+        return ast_children_storage((AST)a)[ast_son_num_to_son_index(a, num_child)];
     }
     else
     {
@@ -173,17 +293,19 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
         AST child0, AST child1, AST child2, AST child3, 
         const locus_t* location, const char *text)
 {
-    AST result = NEW(AST_node_t);
+    AST result = ast_allocate_node();
     // ERROR_CONDITION(result & 0x1 != 0, "Invalid pointer for AST", 0);
 
     result->node_type = type;
+    result->num_ambig = 0;
 
     int num_children = 0;
     unsigned int bitmap_sons = 0;
 
     result->bitmap_sons = bitmap_sons;
     result->parent = NULL;
-    result->locus = location;
+    result->locus_index = locus_get_index(location);
+    result->has_structural_hash = 0;
 
     result->text = text;
 
@@ -195,13 +317,18 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
     num_children = ast_count_bitmap(bitmap_sons);
 
     result->bitmap_sons = bitmap_sons;
-    result->children = NEW_VEC(AST, num_children);
+    AST* children = result->inline_children;
+    if (num_children > AST_INLINE_CHILDREN)
+    {
+        result->children = ast_allocate_children(num_children);
+        children = result->children;
+    }
 
     int idx = 0;
 #define ADD_SON(n) \
     if (child##n != NULL) \
     { \
-        result->children[idx] = child##n; \
+        children[idx] = child##n; \
         child##n->parent = result; \
         idx++; \
     }
@@ -220,11 +347,18 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
 // This function works both for shrinking or widening
 static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
 {
-    // Reallocate childrens
-    // Save the old children array
-    AST* old_children = a->children;
+    // Save the old children
+    AST old_children[MCXX_MAX_AST_CHILDREN];
     // And the old children bitmap
     unsigned int old_bitmap = a->bitmap_sons;
+    int old_num_children = ast_count_bitmap(old_bitmap);
+
+    AST* old_storage = ast_children_storage(a);
+    int i;
+    for (i = 0; i < old_num_children; i++)
+    {
+        old_children[i] = old_storage[i];
+    }
 
     // Enable or disable this new son depending on it being null
     if (new_child != NULL)
@@ -236,10 +370,18 @@ static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
         a->bitmap_sons = (a->bitmap_sons & (~(1 << num_child)));
     }
 
-    a->children = NEW_VEC(AST, ast_count_bitmap(a->bitmap_sons));
+    int num_children = ast_count_bitmap(a->bitmap_sons);
+    if (old_num_children > AST_INLINE_CHILDREN)
+    {
+        ast_release_children(old_storage, old_num_children);
+    }
+    if (num_children > AST_INLINE_CHILDREN)
+    {
+        a->children = ast_allocate_children(num_children);
+    }
+    AST* storage = ast_children_storage(a);
 
     // Now for every old son, update the new children
-    int i;
     for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
     {
         // Note that when shrinking the node ast_has_son
@@ -249,24 +391,21 @@ static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
             if (i == num_child)
             {
                 // The new son
-                a->children[ast_son_num_to_son_index(a, i)] = new_child;
+                storage[ast_son_num_to_son_index(a, i)] = new_child;
             }
             else
             {
                 // Old sons that are updated their position
-                a->children[ast_son_num_to_son_index(a, i)] = 
+                storage[ast_son_num_to_son_index(a, i)] = 
                     old_children[ast_bitmap_to_index(old_bitmap, i)];
             }
         }
     }
-
-    // Now DELETE the old children (if any)
-    if (old_children != NULL)
-        DELETE(old_children);
 }
 
 static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
 {
+    ast_invalidate_structural_hash(a);
     if (new_child == NULL)
     {
         if (ast_has_son(a, num_child))
@@ -279,7 +418,7 @@ static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
     {
         if (ast_has_son(a, num_child))
         {
-            a->children[ast_son_num_to_son_index(a, num_child)] = new_child;
+            ast_children_storage(a)[ast_son_num_to_son_index(a, num_child)] = new_child;
         }
         else
         {
@@ -411,6 +550,8 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         {
             int original_son0 = son0->num_ambig;
 
+            ERROR_CONDITION(original_son0 + son1->num_ambig > AST_MAX_AMBIGUITIES,
+                    "Too many ambiguities", 0);
             son0->num_ambig += son1->num_ambig;
             son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
 
@@ -424,6 +565,8 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         }
         else
         {
+            ERROR_CONDITION(son0->num_ambig == AST_MAX_AMBIGUITIES,
+                    "Too many ambiguities", 0);
             son0->num_ambig++;
             son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
             son0->ambig[son0->num_ambig-1] = son1;
@@ -433,6 +576,8 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
     }
     else if (ASTKind(son1) == AST_AMBIGUITY)
     {
+        ERROR_CONDITION(son1->num_ambig == AST_MAX_AMBIGUITIES,
+                "Too many ambiguities", 0);
         son1->num_ambig++;
         son1->ambig = NEW_REALLOC(AST, son1->ambig, son1->num_ambig);
         son1->ambig[son1->num_ambig-1] = son0;
@@ -447,7 +592,7 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         result->ambig = NEW_VEC(AST, result->num_ambig);
         result->ambig[0] = son0;
         result->ambig[1] = son1;
-        result->locus = son0->locus;
+        result->locus_index = son0->locus_index;
 
         return result;
     }
@@ -455,7 +600,10 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
 
 static inline void ast_replace(AST dest, const_AST src)
 {
+    ast_invalidate_structural_hash(dest);
     *dest = *src;
+    // The hash of src is not shared
+    dest->has_structural_hash = 0;
 }
 
 static inline void ast_free(AST a)
@@ -489,11 +637,23 @@ static inline void ast_free(AST a)
         }
     }
 
+    if (a->has_structural_hash)
+    {
+        ast_forget_structural_hash(a);
+    }
+
     DELETE(a->expr_info);
-    DELETE(a->children);
+    if (ast_get_kind(a) == AST_AMBIGUITY)
+    {
+        DELETE(a->ambig);
+    }
+    else if (ast_count_bitmap(a->bitmap_sons) > AST_INLINE_CHILDREN)
+    {
+        ast_release_children(a->children, ast_count_bitmap(a->bitmap_sons));
+    }
     // Clear the node for safety
     // __builtin_memset(a, 0, sizeof(*a));
-    DELETE(a);
+    ast_release_node(a);
 }
 
 static inline void ast_replace_with_ambiguity(AST a, int n)
@@ -530,7 +690,7 @@ static inline const locus_t* ast_get_locus(const_AST a)
     if (a == NULL)
         return NULL;
     else if (ASTKind(a) != AST_NODE_LIST)
-        return a->locus;
+        return locus_from_index(a->locus_index);
     else
         return ast_get_locus(
                 ASTSon1(ast_list_head(a))
@@ -541,7 +701,7 @@ static inline void ast_set_locus(AST a, const locus_t* locus)
 {
     ERROR_CONDITION(ASTKind(a) == AST_NODE_LIST,
             "list nodes do not have locus", 0);
-    a->locus = locus;
+    a->locus_index = locus_get_index(locus);
 }
 
 static inline const char *ast_get_filename(const_AST a)
@@ -561,6 +721,7 @@ static inline struct nodecl_expr_info_tag* ast_get_expr_info(const_AST a)
 
 static inline void ast_set_expr_info(AST a, struct nodecl_expr_info_tag* expr_info)
 {
+    ast_invalidate_structural_hash(a);
     a->expr_info = expr_info;
 }
 
@@ -43,9 +43,33 @@
 #include "cxx-lexer.h"
 #include "cxx-utils.h"
 #include "cxx-typeutils.h"
+#include "dhash_ptr.h"
 
 #include "cxx-nodecl-decls.h"
 
+ast_arena_t ast_arena;
+
+enum { AST_ARENA_CHUNK_SIZE = 512 * 1024 };
+
+void* ast_arena_allocate_in_new_chunk(size_t size)
+{
+    // The remainder of the current chunk, if any, is wasted. It is always
+    // smaller than a node so this is not a big deal
+    ast_arena.current = NEW_VEC(char, AST_ARENA_CHUNK_SIZE);
+    ast_arena.end = ast_arena.current + AST_ARENA_CHUNK_SIZE;
+    ast_arena.bytes_reserved += AST_ARENA_CHUNK_SIZE;
+
+    void* result = ast_arena.current;
+    ast_arena.current += size;
+    return result;
+}
+
+void ast_arena_stats(void)
+{
+    fprintf(stderr, " - AST arena reserved (bytes): %zu\n", ast_arena.bytes_reserved);
+    fprintf(stderr, " - AST arena in use (bytes): %zu\n", ast_arena.bytes_in_use);
+}
+
 /**
   Checks that nodes are really doubly-linked.
 
@@ -214,11 +238,38 @@ char ast_check_list_tree(const_AST a)
 }
 #endif
 
+// Cached structural hashes. Only the nodes of trees compared by the
+// analyses get one, so they are not worth a field in every node
+static dhash_ptr_t* structural_hashes = NULL;
+
+unsigned int ast_get_structural_hash(const_AST a)
+{
+    if (!a->has_structural_hash)
+        return 0;
+    return (unsigned int)(uintptr_t)dhash_ptr_query(structural_hashes, (const char*)a);
+}
+
+void ast_set_structural_hash(AST a, unsigned int hash)
+{
+    ERROR_CONDITION(hash == 0, "Invalid structural hash", 0);
+    if (structural_hashes == NULL)
+        structural_hashes = dhash_ptr_new(5);
+    dhash_ptr_insert(structural_hashes, (const char*)a, (dhash_ptr_info_t)(uintptr_t)hash);
+    a->has_structural_hash = 1;
+}
+
+void ast_forget_structural_hash(AST a)
+{
+    dhash_ptr_remove(structural_hashes, (const char*)a);
+    a->has_structural_hash = 0;
+}
+
 static void ast_copy_one_node(AST dest, AST orig)
 {
     *dest = *orig;
     dest->bitmap_sons = 0;
     dest->children = 0;
+    dest->has_structural_hash = 0;
 }
 
 AST ast_duplicate_one_node(AST orig)
@@ -234,7 +285,7 @@ AST ast_copy(const_AST a)
     if (a == NULL)
         return NULL;
 
-    AST result = NEW0(AST_node_t);
+    AST result = ast_allocate_node();
 
     ast_copy_one_node(result, (AST)a);
 
@@ -254,7 +305,8 @@ AST ast_copy(const_AST a)
         result->bitmap_sons = a->bitmap_sons;
         int num_children = ast_count_bitmap(result->bitmap_sons);
 
-        result->children = NEW_VEC(AST, num_children);
+        if (num_children > AST_INLINE_CHILDREN)
+            result->children = ast_allocate_children(num_children);
 
         for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
         {
@@ -186,11 +186,19 @@ static inline void ast_replace_with_ambiguity(AST a, int num);
 // for proper navigation inside the interpretation of an ambiguity
 static inline void ast_fix_parents_inside_intepretation(AST node);
 
+// Structural hash cached by nodecl_structural_hash, 0 if there is none.
+// Modifying a node invalidates it in the node and all its ancestors
+LIBMCXX_EXTERN unsigned int ast_get_structural_hash(const_AST a);
+LIBMCXX_EXTERN void ast_set_structural_hash(AST a, unsigned int hash);
+LIBMCXX_EXTERN void ast_forget_structural_hash(AST a);
+static inline void ast_invalidate_structural_hash(AST a);
+
 static inline struct nodecl_expr_info_tag* ast_get_expr_info(const_AST a);
 static inline void ast_set_expr_info(AST a, struct nodecl_expr_info_tag*);
 
 // Used by memory report
 static inline int ast_node_size(void);
+LIBMCXX_EXTERN void ast_arena_stats(void);
 
 /*
  * Macros
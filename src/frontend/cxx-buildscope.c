@@ -569,6 +569,10 @@ static void build_scope_translation_unit_post(
         {
             instantiation_instantiate_pending_functions(nodecl_output);
         }
+        if (CURRENT_CONFIGURATION->lazy_instantiation)
+        {
+            instantiation_instantiate_deferred_members();
+        }
     }
     C_LANGUAGE()
     {
@@ -1466,9 +1470,7 @@ static void check_nodecl_using_directive(nodecl_t nodecl_name,
     ERROR_CONDITION(entry->related_decl_context->current_scope->kind != NAMESPACE_SCOPE,
             "Error, related scope is not namespace scope", 0);
 
-    P_LIST_ADD_ONCE(namespace_scope->use_namespace,
-            namespace_scope->num_used_namespaces,
-            entry);
+    scope_add_used_namespace(namespace_scope, entry);
 
     nodecl_t cxx_using_namespace =
         nodecl_make_cxx_using_namespace(
@@ -15774,8 +15776,7 @@ static void build_scope_namespace_definition(AST a,
                 // An inline namespace is an associated namespace of the current namespace
                 scope_t* namespace_scope = decl_context->current_scope;
 
-                P_LIST_ADD_ONCE(namespace_scope->use_namespace, namespace_scope->num_used_namespaces,
-                        entry);
+                scope_add_used_namespace(namespace_scope, entry);
             }
         }
 
@@ -15831,8 +15832,7 @@ static void build_scope_namespace_definition(AST a,
             scope_t* namespace_scope = decl_context->current_scope;
 
             // Anonymous namespace is implemented as an associated namespace of the current scope
-            P_LIST_ADD_ONCE(namespace_scope->use_namespace, namespace_scope->num_used_namespaces,
-                    entry);
+            scope_add_used_namespace(namespace_scope, entry);
         }
 
         if (ASTSon1(a) != NULL)
@@ -101,8 +101,7 @@ static int diagnose_to_stderr_count(diagnostic_context_stderr_t* ctx UNUSED_PARA
     switch (severity)
     {
         case DS_INFO:
-            // We do not count these currently
-            return 0;
+            return ctx->_base.num_info;
             break;
         case DS_WARNING:
             return ctx->_base.num_warning;
@@ -408,6 +407,11 @@ int diagnostics_get_warn_count(void)
     return (current_diagnostic_context->get_count)(current_diagnostic_context, DS_WARNING);
 }
 
+int diagnostics_get_info_count(void)
+{
+    return (current_diagnostic_context->get_count)(current_diagnostic_context, DS_INFO);
+}
+
 //
 // Generic interface
 //
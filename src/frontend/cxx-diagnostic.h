@@ -38,6 +38,7 @@ typedef struct diagnostic_context_tag diagnostic_context_t;
 void diagnostics_reset(void);
 int diagnostics_get_error_count(void);
 int diagnostics_get_warn_count(void);
+int diagnostics_get_info_count(void);
 
 void error_printf_at(const locus_t*, const char* format, ...) CHECK_PRINTF(2,3);
 void warn_printf_at(const locus_t*, const char* format, ...)  CHECK_PRINTF(2,3);
@@ -8222,6 +8222,12 @@ static void cxx_compute_name_from_entry_list(
 
     if (entry->kind == SK_VARIABLE)
     {
+        if (!check_expr_flags.is_non_executable)
+        {
+            // This is an odr-use of a static data member with a deferred initializer
+            instantiate_static_data_member_if_needed(entry, nodecl_get_locus(nodecl_name));
+        }
+
         nodecl_t nodecl_access_to_symbol = nodecl_make_symbol(entry, nodecl_get_locus(nodecl_name));
 
         nodecl_set_type(nodecl_access_to_symbol, lvalue_ref(entry->type_information));
@@ -17822,6 +17828,11 @@ static void check_nodecl_member_access(
                 }
                 else
                 {
+                    if (!check_expr_flags.is_non_executable)
+                    {
+                        instantiate_static_data_member_if_needed(entry, locus);
+                    }
+
                     // Make sure the type of this static data member is complete
                     if (is_class_type_or_array_thereof(type_of_class_member_access))
                     {
@@ -25393,6 +25404,9 @@ static const_value_t* compute_value_of_symbol(
     }
     if (symbol->kind == SK_VARIABLE)
     {
+        // The value may still be a deferred initializer
+        instantiate_static_data_member_if_needed(symbol, locus);
+
         if (symbol_entity_specs_get_is_constexpr(symbol))
         {
             ERROR_CONDITION(nodecl_is_null(symbol->value), "Expecting a value here", 0);
@@ -25670,6 +25684,8 @@ static const_value_t* compute_glvalue_of_symbol(scope_entry_t* entry)
     }
     else 
     {
+        instantiate_static_data_member_if_needed(entry, entry->locus);
+
         if (!nodecl_is_null(entry->value)
                 && nodecl_is_constant(entry->value))
         {
@@ -237,6 +237,113 @@ static void instantiate_nontemplate_member_class_of_template_class(
         const decl_context_t* decl_context UNUSED_PARAMETER,
         const locus_t* locus);
 
+static void instantiate_data_member_initializer(scope_entry_t* new_member,
+        scope_entry_t* member_of_template,
+        const decl_context_t* context_of_being_instantiated,
+        instantiation_symbol_map_t* instantiation_symbol_map)
+{
+    nodecl_t new_expr = instantiate_expression(member_of_template->value,
+            context_of_being_instantiated,
+            instantiation_symbol_map, /* pack_index */ -1);
+
+    // Update the value of the new instantiated member
+    new_member->value = new_expr;
+
+    if (nodecl_get_kind(new_expr) == NODECL_CXX_INITIALIZER
+            || nodecl_get_kind(new_expr) == NODECL_CXX_EQUAL_INITIALIZER
+            || nodecl_get_kind(new_expr) == NODECL_CXX_PARENTHESIZED_INITIALIZER
+            || nodecl_get_kind(new_expr) == NODECL_CXX_BRACED_INITIALIZER)
+    {
+        check_nodecl_initialization(
+                new_expr,
+                context_of_being_instantiated,
+                new_member,
+                get_unqualified_type(new_member->type_information),
+                &new_member->value,
+                /* is_auto */ 0,
+                /* is_decltype_auto */ 0);
+    }
+    else
+    {
+        // No need to check anything
+    }
+}
+
+// Static data members whose in-class initializer has not been instantiated
+// yet (only used with --lazy-instantiation)
+static scope_entry_t** deferred_static_data_members;
+static int num_deferred_static_data_members;
+static int size_deferred_static_data_members;
+
+static char static_data_member_initializer_can_be_deferred(scope_entry_t* new_member)
+{
+    // The type of an auto static data member is only known after its
+    // initializer has been checked
+    return CURRENT_CONFIGURATION->lazy_instantiation
+        && symbol_entity_specs_get_is_static(new_member)
+        && !type_is_derived_from_auto(new_member->type_information)
+        && !is_decltype_auto_type(new_member->type_information);
+}
+
+static void defer_static_data_member_initializer(scope_entry_t* new_member,
+        scope_entry_t* member_of_template)
+{
+    DEBUG_CODE()
+    {
+        fprintf(stderr, "INSTANTIATION: Deferring initializer of static data member '%s'\n",
+                new_member->symbol_name);
+    }
+
+    // The value is still the one of the template, it will be instantiated
+    // when the member is used (see instantiate_static_data_member_if_needed)
+    new_member->value = nodecl_null();
+    symbol_entity_specs_set_is_instantiable(new_member, 1);
+    symbol_entity_specs_set_emission_template(new_member, member_of_template);
+
+    if (num_deferred_static_data_members == size_deferred_static_data_members)
+    {
+        size_deferred_static_data_members = 2 * size_deferred_static_data_members + 16;
+        deferred_static_data_members = NEW_REALLOC(scope_entry_t*,
+                deferred_static_data_members,
+                size_deferred_static_data_members);
+    }
+    deferred_static_data_members[num_deferred_static_data_members] = new_member;
+    num_deferred_static_data_members++;
+}
+
+void instantiate_static_data_member_if_needed(scope_entry_t* entry,
+        const locus_t* locus)
+{
+    if (entry == NULL
+            || entry->kind != SK_VARIABLE
+            || !symbol_entity_specs_get_is_member(entry)
+            || !symbol_entity_specs_get_is_instantiable(entry))
+        return;
+
+    scope_entry_t* member_of_template = symbol_entity_specs_get_emission_template(entry);
+    ERROR_CONDITION(member_of_template == NULL, "Deferred static data member lacks emission template", 0);
+
+    DEBUG_CODE()
+    {
+        fprintf(stderr, "INSTANTIATION: Instantiating initializer of static data member '%s' at '%s'\n",
+                get_qualified_symbol_name(entry, entry->decl_context),
+                locus_to_str(locus));
+    }
+
+    // Clear these first, an ill-formed initializer may refer to the member itself
+    symbol_entity_specs_set_is_instantiable(entry, 0);
+    symbol_entity_specs_set_emission_template(entry, NULL);
+
+    instantiation_symbol_map_t* instantiation_symbol_map =
+        symbol_entity_specs_get_instantiation_symbol_map(
+                named_type_get_symbol(symbol_entity_specs_get_class_type(entry)));
+
+    instantiate_data_member_initializer(entry,
+            member_of_template,
+            entry->decl_context,
+            instantiation_symbol_map);
+}
+
 static void instantiate_member(type_t* selected_template UNUSED_PARAMETER, 
         type_t* being_instantiated, 
         scope_entry_t* member_of_template, 
@@ -348,30 +455,16 @@ static void instantiate_member(type_t* selected_template UNUSED_PARAMETER,
                 if (!nodecl_is_null(member_of_template->value)
                         && symbol_entity_specs_get_is_defined_inside_class_specifier(member_of_template))
                 {
-                    nodecl_t new_expr = instantiate_expression(member_of_template->value,
-                            context_of_being_instantiated,
-                            instantiation_symbol_map, /* pack_index */ -1);
-
-                    // Update the value of the new instantiated member
-                    new_member->value = new_expr;
-
-                    if (nodecl_get_kind(new_expr) == NODECL_CXX_INITIALIZER
-                            || nodecl_get_kind(new_expr) == NODECL_CXX_EQUAL_INITIALIZER
-                            || nodecl_get_kind(new_expr) == NODECL_CXX_PARENTHESIZED_INITIALIZER
-                            || nodecl_get_kind(new_expr) == NODECL_CXX_BRACED_INITIALIZER)
+                    if (static_data_member_initializer_can_be_deferred(new_member))
                     {
-                        check_nodecl_initialization(
-                                new_expr,
-                                context_of_being_instantiated,
-                                new_member,
-                                get_unqualified_type(new_member->type_information),
-                                &new_member->value,
-                                /* is_auto */ 0,
-                                /* is_decltype_auto */ 0);
+                        defer_static_data_member_initializer(new_member, member_of_template);
                     }
                     else
                     {
-                        // No need to check anything
+                        instantiate_data_member_initializer(new_member,
+                                member_of_template,
+                                context_of_being_instantiated,
+                                instantiation_symbol_map);
                     }
                 }
 
@@ -2226,6 +2319,66 @@ void instantiation_init(void)
     nodecl_instantiation_units = nodecl_null();
     symbols_to_instantiate = NULL;
     num_symbols_to_instantiate = 0;
+
+    DELETE(deferred_static_data_members);
+    deferred_static_data_members = NULL;
+    num_deferred_static_data_members = 0;
+    size_deferred_static_data_members = 0;
+}
+
+void instantiation_instantiate_deferred_members(void)
+{
+    // Instantiating an initializer may defer further members
+    int i;
+    for (i = 0; i < num_deferred_static_data_members; i++)
+    {
+        scope_entry_t* entry = deferred_static_data_members[i];
+
+        // A constexpr declaration cannot be emitted without its initializer.
+        // Unused const members are emitted as mere declarations
+        if (symbol_entity_specs_get_is_constexpr(entry))
+        {
+            instantiate_static_data_member_if_needed(entry, entry->locus);
+        }
+    }
+
+    DEBUG_CODE()
+    {
+        int num_not_instantiated = 0;
+        for (i = 0; i < num_deferred_static_data_members; i++)
+        {
+            if (symbol_entity_specs_get_is_instantiable(deferred_static_data_members[i]))
+                num_not_instantiated++;
+        }
+        fprintf(stderr, "INSTANTIATION: %d of %d deferred static data member initializers were never instantiated\n",
+                num_not_instantiated,
+                num_deferred_static_data_members);
+    }
+}
+
+void instantiate_member_if_needed(scope_entry_t* entry,
+        const locus_t* locus)
+{
+    if (entry == NULL
+            || !symbol_entity_specs_get_is_member(entry))
+        return;
+
+    if (entry->kind == SK_VARIABLE)
+    {
+        instantiate_static_data_member_if_needed(entry, locus);
+    }
+    else if (entry->kind == SK_CLASS)
+    {
+        class_type_complete_if_needed(entry, entry->decl_context, locus);
+    }
+    else if (entry->kind == SK_FUNCTION)
+    {
+        if (nodecl_is_null(symbol_entity_specs_get_function_code(entry))
+                && function_may_be_instantiated(entry))
+        {
+            instantiate_template_function(entry, locus);
+        }
+    }
 }
 
 static void instantiate_every_symbol(scope_entry_t* entry,
@@ -57,6 +57,14 @@ LIBMCXX_EXTERN void instantiation_instantiate_pending_functions(nodecl_t* nodecl
 LIBMCXX_EXTERN void instantiation_add_symbol_to_instantiate(scope_entry_t* entry,
         const locus_t* locus);
 
+LIBMCXX_EXTERN void instantiation_instantiate_deferred_members(void);
+
+LIBMCXX_EXTERN void instantiate_static_data_member_if_needed(scope_entry_t* entry,
+        const locus_t* locus);
+
+LIBMCXX_EXTERN void instantiate_member_if_needed(scope_entry_t* entry,
+        const locus_t* locus);
+
 LIBMCXX_EXTERN char function_may_be_instantiated(scope_entry_t* entry);
 LIBMCXX_EXTERN void instantiate_template_function(scope_entry_t* entry, const locus_t* locus);
 
@@ -76,6 +76,9 @@ LIBMCXX_EXTERN void update_parser_location(const char* current_text, parser_loca
 LIBMCXX_EXTERN int mcxx_open_file_for_scanning(const char* scanned_filename, const char* input_filename);
 LIBMCXX_EXTERN int mc99_open_file_for_scanning(const char* scanned_filename, const char* input_filename);
 
+LIBMCXX_EXTERN int mcxx_open_stream_for_scanning(FILE* stream, const char* scanned_filename, const char* input_filename);
+LIBMCXX_EXTERN int mc99_open_stream_for_scanning(FILE* stream, const char* scanned_filename, const char* input_filename);
+
 LIBMCXX_EXTERN int mcxx_prepare_string_for_scanning(const char* str);
 LIBMCXX_EXTERN int mc99_prepare_string_for_scanning(const char* str);
 
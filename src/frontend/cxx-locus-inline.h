@@ -33,8 +33,23 @@ struct locus_tag
 {
     const char* filename;
     unsigned int line, col;
+    // Position in locus_table
+    unsigned int index;
 };
 
+// Index 0 is reserved for the NULL locus
+extern const locus_t** locus_table;
+
+static inline unsigned int locus_get_index(const locus_t* l)
+{
+    return l == NULL ? 0 : l->index;
+}
+
+static inline const locus_t* locus_from_index(unsigned int index)
+{
+    return locus_table[index];
+}
+
 static inline const char* locus_to_str(const locus_t* l)
 {
     const char* result = NULL;
@@ -95,6 +95,30 @@ static locus_t* pool_locus_alloc(void)
     return result;
 }
 
+static const locus_t* null_locus_table[1] = { NULL };
+const locus_t** locus_table = null_locus_table;
+static unsigned int locus_table_size = 1;
+static unsigned int locus_table_capacity = 0;
+
+static void locus_table_add(locus_t* locus)
+{
+    if (locus_table_capacity == 0)
+    {
+        locus_table_capacity = POOL_SIZE;
+        locus_table = NEW_VEC(const locus_t*, locus_table_capacity);
+        locus_table[0] = NULL;
+    }
+    else if (locus_table_size == locus_table_capacity)
+    {
+        locus_table_capacity *= 2;
+        locus_table = NEW_REALLOC(const locus_t*, locus_table, locus_table_capacity);
+    }
+
+    locus->index = locus_table_size;
+    locus_table[locus_table_size] = locus;
+    locus_table_size++;
+}
+
 const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col)
 {
     if (filename == NULL)
@@ -142,6 +166,7 @@ const locus_t* make_locus(const char* filename, unsigned int line, unsigned int
     items[n].locus->filename = uniquestr(filename);
     items[n].locus->line = line;
     items[n].locus->col = col;
+    locus_table_add(items[n].locus);
 
     bucket->num++;
 
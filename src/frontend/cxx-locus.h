@@ -40,6 +40,11 @@ static inline const char* locus_get_filename(const locus_t*);
 static inline unsigned int locus_get_line(const locus_t*);
 static inline unsigned int locus_get_column(const locus_t*);
 
+// Every locus has a unique 32-bit index that can be used in place of the
+// pointer. The index of NULL is 0
+static inline unsigned int locus_get_index(const locus_t*);
+static inline const locus_t* locus_from_index(unsigned int index);
+
 #include "cxx-locus-inline.h"
 
 MCXX_END_DECLS
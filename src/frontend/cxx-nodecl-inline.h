@@ -108,7 +108,8 @@ static inline nodecl_expr_info_t* nodecl_expr_get_expression_info(AST expr)
     return p;
 }
 
-#define NODECL_EXPR_SET_PTR(type, what, field_name) \
+// Fields that take part in the structural hash must invalidate it
+#define NODECL_EXPR_SET_PTR(type, what, field_name, is_structural) \
 static inline void nodecl_expr_set_##what(AST expr, type * datum) \
 { \
     nodecl_expr_info_t* expr_info; \
@@ -122,23 +123,28 @@ static inline void nodecl_expr_set_##what(AST expr, type * datum) \
     { \
      expr_info = nodecl_expr_get_expression_info(expr); \
     } \
+    if (is_structural \
+            && expr_info->field_name != datum) \
+    { \
+        ast_invalidate_structural_hash(expr); \
+    } \
     expr_info->field_name = datum; \
 }
 
 // static void nodecl_expr_set_symbol(AST expr, scope_entry_t* entry)
-NODECL_EXPR_SET_PTR(scope_entry_t, symbol, symbol)
+NODECL_EXPR_SET_PTR(scope_entry_t, symbol, symbol, /* is_structural */ 1)
 
 // static void nodecl_expr_set_type(AST expr, type_t* t)
-NODECL_EXPR_SET_PTR(type_t, type, type_info)
+NODECL_EXPR_SET_PTR(type_t, type, type_info, /* is_structural */ 0)
 
 // static void nodecl_expr_set_constant(AST expr, const_value_t* const_val)
-NODECL_EXPR_SET_PTR(const_value_t, constant, const_val)
+NODECL_EXPR_SET_PTR(const_value_t, constant, const_val, /* is_structural */ 1)
     
 // static void nodecl_expr_set_template_parameters(AST expr, template_parameter_list_t* template_params)
-NODECL_EXPR_SET_PTR(template_parameter_list_t, template_parameters, template_parameters)
+NODECL_EXPR_SET_PTR(template_parameter_list_t, template_parameters, template_parameters, /* is_structural */ 0)
 
 // static void nodecl_expr_set_placeholder(AST expr, AST* template_params)
-NODECL_EXPR_SET_PTR(AST, placeholder, placeholder);
+NODECL_EXPR_SET_PTR(AST, placeholder, placeholder, /* is_structural */ 0);
 
 
 // Public routines
@@ -34,11 +34,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "cxx-nodecl.h"
 #include "cxx-exprtype.h"
 #include "cxx-utils.h"
 #include "cxx-codegen.h"
+#include "cxx-cexpr.h"
 
 // nodecl_t nodecl_shallow_copy(nodecl_t t)
 // {
@@ -214,6 +216,58 @@ size_t nodecl_hash_table(nodecl_t key)
     return hash;
 }
 
+static unsigned int structural_hash_combine(unsigned int hash, uintptr_t value)
+{
+    // Like boost::hash_combine
+    unsigned int v = (unsigned int)value ^ (unsigned int)((uint64_t)value >> 32);
+    return hash ^ (v + 0x9e3779b9U + (hash << 6) + (hash >> 2));
+}
+
+unsigned int nodecl_structural_hash(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    AST a = nodecl_get_ast(n);
+    unsigned int hash = ast_get_structural_hash(a);
+    if (hash != 0)
+        return hash;
+
+    if (nodecl_get_kind(n) == NODECL_CONVERSION)
+    {
+        // Conversions are ignored so trees that only differ in them (and
+        // are equal when skipping conversion nodes) hash the same
+        hash = nodecl_structural_hash(nodecl_get_child(n, 0));
+    }
+    else
+    {
+        // Hash the same information as structurally_cmp_nodecls
+        const_value_t* cval = nodecl_get_constant(n);
+        if (cval != NULL
+                && (const_value_is_object(cval)
+                    || const_value_is_address(cval)))
+            cval = NULL;
+
+        hash = structural_hash_combine(0, nodecl_get_kind(n));
+        hash = structural_hash_combine(hash, (uintptr_t)nodecl_get_symbol(n));
+        hash = structural_hash_combine(hash, (uintptr_t)cval);
+
+        int i;
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            hash = structural_hash_combine(hash,
+                    nodecl_structural_hash(nodecl_get_child(n, i)));
+        }
+    }
+
+    // 0 means not computed
+    if (hash == 0)
+        hash = 1;
+
+    ast_set_structural_hash(a, hash);
+    return hash;
+}
+
 // Placeholder
 void nodecl_set_placeholder(nodecl_t n, AST* p)
 {
@@ -156,6 +156,11 @@ void nodecl_replace(nodecl_t old_node, nodecl_t new_node);
 // Hash table
 size_t nodecl_hash_table(nodecl_t key);
 
+// Structural hash, consistent with the structural comparisons of trees
+// (with or without skipping conversion nodes). It is cached in the tree
+// and recomputed only after the tree is modified
+unsigned int nodecl_structural_hash(nodecl_t n);
+
 // Sourceify
 const char* nodecl_stmt_to_source(nodecl_t n);
 const char* nodecl_expr_to_source(nodecl_t n);
@@ -3000,7 +3000,7 @@ char is_better_function(
 /*
  * num_arguments includes the implicit argument so it should never be zero, at least 1
  */
-static scope_entry_t* solve_overload_(candidate_t* candidate_set,
+static scope_entry_t* solve_overload_uncached_(candidate_t* candidate_set,
         const decl_context_t* decl_context,
         enum initialization_kind initialization_kind,
         type_t* dest,
@@ -3271,6 +3271,303 @@ static scope_entry_t* solve_overload_(candidate_t* candidate_set,
     return best_viable_function;
 }
 
+/*
+ * Overload resolution cache
+ *
+ * The same overload resolution (same candidate functions called with the
+ * same argument types) tends to happen many times in a translation unit. The
+ * result of solve_overload_ is memoized using as a key the candidate set, the
+ * initialization kind, the destination type and the enclosing class and
+ * namespace scopes. Overloads added later, e.g. by a using-declaration, are
+ * part of the candidate set so they change the key.
+ *
+ * Overload resolution only depends on these as long as the classes involved
+ * do not change. So the result is only cached when all the classes involved
+ * in the arguments and the parameters are complete and no type is dependent.
+ * A redeclaration may add default arguments to a candidate, making it viable
+ * for fewer arguments, so the number of default arguments of every candidate
+ * is part of the key too.
+ *
+ * Failed resolutions are not cached: they may succeed later (e.g. once a
+ * redeclaration adds default arguments) and callers usually diagnose them.
+ */
+typedef
+struct overload_cache_entry_tag
+{
+    unsigned int hash;
+    int num_words;
+    uintptr_t* words;
+
+    scope_entry_t* result;
+    char is_ambiguous;
+} overload_cache_entry_t;
+
+static struct
+{
+    int num_entries;
+    int capacity;
+    overload_cache_entry_t** entries;
+
+    int hits;
+    int misses;
+    int uncacheable;
+} overload_cache;
+
+void overload_cache_clear(void)
+{
+    int i;
+    for (i = 0; i < overload_cache.capacity; i++)
+    {
+        if (overload_cache.entries[i] != NULL)
+        {
+            DELETE(overload_cache.entries[i]->words);
+            DELETE(overload_cache.entries[i]);
+        }
+    }
+    DELETE(overload_cache.entries);
+
+    overload_cache.entries = NULL;
+    overload_cache.num_entries = 0;
+    overload_cache.capacity = 0;
+}
+
+void overload_cache_stats(void)
+{
+    fprintf(stderr, " - Overload resolution cache hits: %d\n", overload_cache.hits);
+    fprintf(stderr, " - Overload resolution cache misses: %d\n", overload_cache.misses);
+    fprintf(stderr, " - Overload resolutions not cacheable: %d\n", overload_cache.uncacheable);
+}
+
+// A type is settled if overload resolution involving it cannot change later
+// in the translation unit
+static char type_is_settled_for_overload(type_t* t)
+{
+    if (t == NULL)
+        return 1;
+
+    if (is_dependent_type(t))
+        return 0;
+
+    t = no_ref(t);
+    for (;;)
+    {
+        if (is_pointer_type(t))
+            t = pointer_type_get_pointee_type(t);
+        else if (is_array_type(t))
+            t = array_type_get_element_type(t);
+        else
+            break;
+    }
+
+    if (is_class_type(t))
+        return is_complete_type(t);
+
+    return 1;
+}
+
+// Like can_be_called_with_number_of_arguments, specializations of function
+// templates take their default arguments from the primary template
+static int overload_cache_num_default_arguments(scope_entry_t* entry)
+{
+    scope_entry_t* function_with_defaults = entry;
+    if (is_template_specialized_type(entry->type_information))
+    {
+        function_with_defaults =
+            named_type_get_symbol(
+                    template_type_get_primary_type(
+                        template_specialized_type_get_related_template_type(
+                            entry->type_information)));
+    }
+
+    int num_default_arguments = 0;
+    int i;
+    for (i = symbol_entity_specs_get_num_parameters(function_with_defaults) - 1;
+            i >= 0
+            && symbol_entity_specs_get_default_argument_info_num(function_with_defaults, i) != NULL;
+            i--)
+    {
+        num_default_arguments++;
+    }
+
+    return num_default_arguments;
+}
+
+static char overload_cache_key_add_candidate(uintptr_t* words, int* num_words,
+        candidate_t* candidate)
+{
+    if (is_computed_function_type(candidate->entry->type_information))
+        return 0;
+
+    words[(*num_words)++] = (uintptr_t)candidate->entry;
+    words[(*num_words)++] = (uintptr_t)candidate->num_args;
+
+    int i;
+    for (i = 0; i < candidate->num_args; i++)
+    {
+        if (!type_is_settled_for_overload(candidate->args[i]))
+            return 0;
+        words[(*num_words)++] = (uintptr_t)candidate->args[i];
+    }
+
+    scope_entry_t* function = entry_advance_aliases(candidate->entry);
+    type_t* function_type = function->type_information;
+    if (!is_function_type(function_type))
+        return 0;
+
+    words[(*num_words)++] = (uintptr_t)overload_cache_num_default_arguments(function);
+
+    int num_parameters = function_type_get_num_parameters(function_type);
+    if (function_type_get_has_ellipsis(function_type))
+        num_parameters--;
+
+    for (i = 0; i < num_parameters; i++)
+    {
+        if (!type_is_settled_for_overload(
+                    function_type_get_parameter_type_num(function_type, i)))
+            return 0;
+    }
+
+    return 1;
+}
+
+static unsigned int overload_cache_hash(uintptr_t* words, int num_words)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    int i;
+    for (i = 0; i < num_words; i++)
+    {
+        h ^= words[i];
+        h *= UINT64_C(0x100000001b3);
+        h ^= h >> 29;
+    }
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+static overload_cache_entry_t** overload_cache_find_slot(unsigned int hash,
+        uintptr_t* words, int num_words)
+{
+    unsigned int mask = overload_cache.capacity - 1;
+    unsigned int i = hash & mask;
+    overload_cache_entry_t* entry;
+    while ((entry = overload_cache.entries[i]) != NULL)
+    {
+        if (entry->hash == hash
+                && entry->num_words == num_words
+                && memcmp(entry->words, words, num_words * sizeof(*words)) == 0)
+            break;
+
+        i = (i + 1) & mask;
+    }
+    return &overload_cache.entries[i];
+}
+
+static void overload_cache_grow(void)
+{
+    int old_capacity = overload_cache.capacity;
+    overload_cache_entry_t** old_entries = overload_cache.entries;
+
+    overload_cache.capacity = (old_capacity == 0) ? 256 : 2 * old_capacity;
+    overload_cache.entries = NEW_VEC0(overload_cache_entry_t*, overload_cache.capacity);
+
+    int i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        overload_cache_entry_t* entry = old_entries[i];
+        if (entry == NULL)
+            continue;
+
+        *overload_cache_find_slot(entry->hash, entry->words, entry->num_words) = entry;
+    }
+
+    DELETE(old_entries);
+}
+
+static scope_entry_t* solve_overload_(candidate_t* candidate_set,
+        const decl_context_t* decl_context,
+        enum initialization_kind initialization_kind,
+        type_t* dest,
+        const locus_t* locus,
+        // Out
+        char *is_ambiguous)
+{
+    int max_words = 4;
+    candidate_t* it;
+    for (it = candidate_set; it != NULL; it = it->next)
+    {
+        max_words += 3 + it->num_args;
+    }
+
+    uintptr_t words[max_words];
+    int num_words = 0;
+
+    char is_cacheable = (candidate_set != NULL)
+        && type_is_settled_for_overload(dest);
+
+    if (is_cacheable)
+    {
+        words[num_words++] = (uintptr_t)initialization_kind;
+        words[num_words++] = (uintptr_t)dest;
+        words[num_words++] = (uintptr_t)decl_context->namespace_scope;
+        words[num_words++] = (uintptr_t)decl_context->class_scope;
+
+        for (it = candidate_set; it != NULL && is_cacheable; it = it->next)
+        {
+            is_cacheable = overload_cache_key_add_candidate(words, &num_words, it);
+        }
+    }
+
+    if (!is_cacheable)
+    {
+        overload_cache.uncacheable++;
+        return solve_overload_uncached_(candidate_set, decl_context,
+                initialization_kind, dest, locus, is_ambiguous);
+    }
+
+    unsigned int hash = overload_cache_hash(words, num_words);
+    if (overload_cache.capacity != 0)
+    {
+        overload_cache_entry_t* entry = *overload_cache_find_slot(hash, words, num_words);
+        if (entry != NULL)
+        {
+            overload_cache.hits++;
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "OVERLOAD: Result found in the overload resolution cache\n");
+            }
+            *is_ambiguous = entry->is_ambiguous;
+            return entry->result;
+        }
+    }
+
+    overload_cache.misses++;
+    scope_entry_t* result = solve_overload_uncached_(candidate_set, decl_context,
+            initialization_kind, dest, locus, is_ambiguous);
+
+    if (result == NULL)
+        return NULL;
+
+    if (4 * (overload_cache.num_entries + 1) > 3 * overload_cache.capacity)
+        overload_cache_grow();
+
+    overload_cache_entry_t** slot = overload_cache_find_slot(hash, words, num_words);
+    // A nested overload resolution may have already solved this one
+    if (*slot == NULL)
+    {
+        overload_cache_entry_t* entry = NEW(overload_cache_entry_t);
+        entry->hash = hash;
+        entry->num_words = num_words;
+        entry->words = NEW_VEC(uintptr_t, num_words);
+        memcpy(entry->words, words, num_words * sizeof(*words));
+        entry->result = result;
+        entry->is_ambiguous = *is_ambiguous;
+
+        *slot = entry;
+        overload_cache.num_entries++;
+    }
+
+    return result;
+}
+
 scope_entry_t* solve_overload(candidate_t* candidate_set,
         const decl_context_t* decl_context,
         const locus_t* locus)
@@ -82,6 +82,9 @@ LIBMCXX_EXTERN char solve_list_initialization_of_class_type(
         scope_entry_t** constructor,
         scope_entry_list_t** candidates);
 
+LIBMCXX_EXTERN void overload_cache_clear(void);
+LIBMCXX_EXTERN void overload_cache_stats(void);
+
 MCXX_END_DECLS
 
 #endif // CXX_OVERLOAD_H
@@ -405,6 +405,13 @@ struct scope_tag
     // they contain the namespace symbol, the class symbol
     // and the function symbol
     scope_entry_t* related_entry;
+
+    // Incremented every time the names or the using directives of this
+    // scope change. Used to validate lookup_cache
+    unsigned int generation;
+
+    // Results of unqualified lookups started in this scope. Created lazily
+    dhash_ptr_t* lookup_cache;
 };
 
 typedef const char* (*print_symbol_callback_t)(scope_entry_t*, const decl_context_t*, void*);
@@ -451,6 +451,7 @@ void insert_alias(scope_t* sc, scope_entry_t* entry, const char* name)
     }
 
     dhash_ptr_insert(sc->dhash, symbol_name, result_set);
+    sc->generation++;
 }
 
 static const char* scope_names[] =
@@ -485,8 +486,59 @@ char same_scope(scope_t* stA, scope_t* stB)
     return (stA->dhash == stB->dhash);
 }
 
+// Scopes consulted by the unqualified lookups being computed. See
+// name_lookup_in_scope_chain
+typedef
+struct name_lookup_dependence_tag
+{
+    scope_t* scope;
+    unsigned int generation;
+} name_lookup_dependence_t;
+
+static struct
+{
+    // Number of nested lookups being computed
+    int depth;
+    // False if the result depends on something not tracked by generations
+    char cacheable;
+    // First dependence of the innermost lookup being computed
+    int first_dependence;
+
+    int num_dependences;
+    name_lookup_dependence_t* dependences;
+    int capacity;
+} name_lookup_trace;
+
+static void name_lookup_trace_add(scope_t* sc, unsigned int generation)
+{
+    if (name_lookup_trace.depth == 0)
+        return;
+
+    // Only within the innermost lookup, it would be missing in its
+    // dependences otherwise
+    if (name_lookup_trace.num_dependences > name_lookup_trace.first_dependence
+            && name_lookup_trace.dependences[name_lookup_trace.num_dependences - 1].scope == sc
+            && name_lookup_trace.dependences[name_lookup_trace.num_dependences - 1].generation == generation)
+        return;
+
+    if (name_lookup_trace.num_dependences == name_lookup_trace.capacity)
+    {
+        name_lookup_trace.capacity = 2 * name_lookup_trace.capacity + 16;
+        name_lookup_trace.dependences = NEW_REALLOC(name_lookup_dependence_t,
+                name_lookup_trace.dependences,
+                name_lookup_trace.capacity);
+    }
+
+    name_lookup_dependence_t* dep = &name_lookup_trace.dependences[name_lookup_trace.num_dependences];
+    dep->scope = sc;
+    dep->generation = generation;
+    name_lookup_trace.num_dependences++;
+}
+
 static scope_entry_list_t* query_name_in_scope(scope_t* sc, const char* name)
 {
+    name_lookup_trace_add(sc, sc->generation);
+
     DEBUG_CODE()
     {
         if (sc->related_entry == NULL)
@@ -554,12 +606,14 @@ void insert_entry(scope_t* sc, scope_entry_t* entry)
         {
             result_set = entry_list_prepend(result_set, entry);
             dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+            sc->generation++;
         }
     }
     else
     {
         result_set = entry_list_new(entry);
         dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+        sc->generation++;
     }
 }
 
@@ -570,6 +624,7 @@ void remove_entry(scope_t* sc, scope_entry_t* entry)
         return;
 
     entry_list = entry_list_remove(entry_list, entry);
+    sc->generation++;
 
     if (entry_list_size(entry_list) > 1)
     {
@@ -581,6 +636,12 @@ void remove_entry(scope_t* sc, scope_entry_t* entry)
     }
 }
 
+void scope_add_used_namespace(scope_t* sc, scope_entry_t* namespace_entry)
+{
+    P_LIST_ADD_ONCE(sc->use_namespace, sc->num_used_namespaces, namespace_entry);
+    sc->generation++;
+}
+
 scope_entry_list_t* filter_symbol_kind_set(scope_entry_list_t* entry_list, int num_kinds, enum cxx_symbol_kind* symbol_kind_set)
 {
     scope_entry_list_t* result = NULL;
@@ -1173,6 +1234,14 @@ void class_scope_lookup_rec(scope_t* current_class_scope, const char* name,
 
     ERROR_CONDITION(current_class_type == NULL, "Class scope does not have a class-type", 0);
 
+    // Bases of a class may still change until it is complete
+    if (is_class_type(current_class_type)
+            && (!is_complete_type(current_class_type)
+                || is_dependent_type(current_class_type)))
+    {
+        name_lookup_trace.cacheable = 0;
+    }
+
     // Fill our information
     derived->path_length++;
     ERROR_CONDITION(derived->path_length == MCXX_MAX_SCOPES_NESTING, "Class path too long", 0);
@@ -2044,6 +2113,8 @@ static void transitive_add_using_namespaces(decl_flags_t decl_flags,
         int *num_associated_namespaces,
         associated_namespace_t **associated_namespaces)
 {
+    name_lookup_trace_add(current_scope, current_scope->generation);
+
     int i;
     for (i = 0; i < current_scope->num_used_namespaces; i++)
     {
@@ -2077,6 +2148,155 @@ static void transitive_add_using_namespaces(decl_flags_t decl_flags,
     }
 }
 
+// Unqualified lookups are cached in the scope where they start. A cached
+// result remains valid as long as none of the scopes consulted to compute it
+// (including their using directives) has changed, which is checked using the
+// generation of every one of these scopes.
+//
+// Lookups that filter by symbol kind (DF_STRUCT, DF_ENUM,
+// DF_NESTED_NAME_FIRST...) find different entities than the unfiltered ones,
+// so all the lookup flags are part of the key.
+//
+// Empty results are not cached because they are usually followed by a
+// declaration of the name, and neither are results that depend on the
+// friend-declared flag of symbols or on a class that is not complete yet
+typedef
+struct name_lookup_cache_item_tag
+{
+    decl_flags_t decl_flags;
+    scope_entry_list_t* result;
+
+    int num_dependences;
+    name_lookup_dependence_t* dependences;
+
+    struct name_lookup_cache_item_tag* next;
+} name_lookup_cache_item_t;
+
+static int name_lookup_cache_hits = 0;
+static int name_lookup_cache_misses = 0;
+
+static scope_entry_list_t* name_lookup_in_scope_chain_uncached(scope_t* current_scope,
+        const char* name,
+        field_path_t* field_path,
+        decl_flags_t decl_flags,
+        const locus_t* locus);
+
+static char name_lookup_cache_item_is_valid(name_lookup_cache_item_t* item)
+{
+    int i;
+    for (i = 0; i < item->num_dependences; i++)
+    {
+        if (item->dependences[i].scope->generation != item->dependences[i].generation)
+            return 0;
+    }
+    return 1;
+}
+
+static scope_entry_list_t* name_lookup_in_scope_chain(scope_t* current_scope,
+        const char* name,
+        field_path_t* field_path,
+        decl_flags_t decl_flags,
+        const locus_t* locus)
+{
+    if (BITMAP_TEST(decl_flags, DF_IGNORE_FRIEND_DECL))
+    {
+        // Do not let an enclosing lookup cache this result
+        name_lookup_trace.cacheable = 0;
+        return name_lookup_in_scope_chain_uncached(current_scope,
+                name, field_path, decl_flags, locus);
+    }
+
+    name_lookup_cache_item_t* first_item = NULL;
+    name_lookup_cache_item_t* item = NULL;
+    if (current_scope->lookup_cache != NULL)
+    {
+        first_item = (name_lookup_cache_item_t*)dhash_ptr_query(current_scope->lookup_cache, name);
+        for (item = first_item; item != NULL; item = item->next)
+        {
+            if (item->decl_flags == decl_flags)
+                break;
+        }
+    }
+
+    if (item != NULL
+            && name_lookup_cache_item_is_valid(item))
+    {
+        name_lookup_cache_hits++;
+
+        // An enclosing lookup being computed depends on the same scopes
+        int i;
+        for (i = 0; i < item->num_dependences; i++)
+        {
+            name_lookup_trace_add(item->dependences[i].scope,
+                    item->dependences[i].generation);
+        }
+
+        return entry_list_copy(item->result);
+    }
+
+    name_lookup_cache_misses++;
+
+    int first_dependence = name_lookup_trace.num_dependences;
+    int enclosing_first_dependence = name_lookup_trace.first_dependence;
+    char enclosing_cacheable = name_lookup_trace.cacheable;
+    int num_errors = diagnostics_get_error_count();
+    int num_warnings = diagnostics_get_warn_count();
+
+    name_lookup_trace.cacheable = 1;
+    name_lookup_trace.first_dependence = first_dependence;
+    name_lookup_trace.depth++;
+    scope_entry_list_t* result = name_lookup_in_scope_chain_uncached(current_scope,
+            name, field_path, decl_flags, locus);
+    name_lookup_trace.depth--;
+    name_lookup_trace.first_dependence = enclosing_first_dependence;
+
+    // Do not cache anything that emitted diagnostics, they would not be
+    // emitted again
+    if (name_lookup_trace.cacheable
+            && result != NULL
+            && num_errors == diagnostics_get_error_count()
+            && num_warnings == diagnostics_get_warn_count())
+    {
+        if (item == NULL)
+        {
+            item = NEW0(name_lookup_cache_item_t);
+            item->decl_flags = decl_flags;
+            item->next = first_item;
+
+            if (current_scope->lookup_cache == NULL)
+                current_scope->lookup_cache = dhash_ptr_new(5);
+            dhash_ptr_insert(current_scope->lookup_cache, name, item);
+        }
+        else
+        {
+            entry_list_free(item->result);
+            DELETE(item->dependences);
+        }
+
+        item->result = entry_list_copy(result);
+        item->num_dependences = name_lookup_trace.num_dependences - first_dependence;
+        item->dependences = NEW_VEC(name_lookup_dependence_t, item->num_dependences);
+        memcpy(item->dependences,
+                &name_lookup_trace.dependences[first_dependence],
+                item->num_dependences * sizeof(*item->dependences));
+    }
+
+    name_lookup_trace.cacheable = enclosing_cacheable && name_lookup_trace.cacheable;
+    if (name_lookup_trace.depth == 0)
+    {
+        name_lookup_trace.num_dependences = 0;
+        name_lookup_trace.cacheable = 1;
+    }
+
+    return result;
+}
+
+void name_lookup_cache_stats(void)
+{
+    fprintf(stderr, " - Name lookup cache hits: %d\n", name_lookup_cache_hits);
+    fprintf(stderr, " - Name lookup cache misses: %d\n", name_lookup_cache_misses);
+}
+
 static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
         const char* name,
         field_path_t* field_path,
@@ -2118,13 +2338,21 @@ static scope_entry_list_t* name_lookup(const decl_context_t* decl_context,
         template_parameters = template_parameters->enclosing;
     }
 
+    return name_lookup_in_scope_chain(decl_context->current_scope,
+            name, field_path, decl_flags, locus);
+}
+
+static scope_entry_list_t* name_lookup_in_scope_chain_uncached(scope_t* current_scope,
+        const char* name,
+        field_path_t* field_path,
+        decl_flags_t decl_flags,
+        const locus_t* locus)
+{
     scope_entry_list_t* result = NULL;
 
     associated_namespace_t* associated_namespaces = NULL;
     int num_associated_namespaces = 0;
 
-    scope_t* current_scope = decl_context->current_scope;
-
     while (result == NULL
             && current_scope != NULL)
     {
@@ -60,6 +60,12 @@ LIBMCXX_EXTERN scope_entry_t* new_symbol(const decl_context_t* decl_context,
         struct scope_tag* st, const char* name);
 LIBMCXX_EXTERN void remove_entry(struct scope_tag* st, scope_entry_t* entry);
 LIBMCXX_EXTERN void insert_entry(struct scope_tag* st, scope_entry_t* entry);
+
+// Adds a using directive (or an inline or anonymous namespace) to the scope
+LIBMCXX_EXTERN void scope_add_used_namespace(struct scope_tag* st, scope_entry_t* namespace_entry);
+
+// Used by memory report
+LIBMCXX_EXTERN void name_lookup_cache_stats(void);
 LIBMCXX_EXTERN void insert_alias(struct scope_tag* st, scope_entry_t* entry, const char* alias_name);
 
 // Given a list of symbols, purge all those that are not of symbol_kind kind
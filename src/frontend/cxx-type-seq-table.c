@@ -0,0 +1,165 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#include "cxx-type-seq-table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cxx-utils.h"
+
+typedef struct type_seq_table_entry_tag
+{
+    unsigned int hash;
+    unsigned int qualifiers;
+    int num_types;
+    const type_t** type_seq;
+    const type_t* result;
+} type_seq_table_entry_t;
+
+// Open addressing with linear probing. Entries are never removed
+struct type_seq_table_tag
+{
+    int capacity;
+    int num_entries;
+    type_seq_table_entry_t** entries;
+};
+
+enum { TYPE_SEQ_TABLE_INITIAL_CAPACITY = 64 };
+
+type_seq_table_t* type_seq_table_new(void)
+{
+    type_seq_table_t* table = NEW0(type_seq_table_t);
+    table->capacity = TYPE_SEQ_TABLE_INITIAL_CAPACITY;
+    table->entries = NEW_VEC0(type_seq_table_entry_t*, table->capacity);
+    return table;
+}
+
+unsigned int type_seq_table_hash(unsigned int qualifiers,
+        const type_t** type_seq, int num_types)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325) ^ qualifiers;
+    h *= UINT64_C(0x100000001b3);
+    h ^= (uint64_t)num_types;
+
+    int i;
+    for (i = 0; i < num_types; i++)
+    {
+        // Types are allocated aligned so the lowest bits are not relevant
+        h ^= ((uintptr_t)type_seq[i]) >> 3;
+        h *= UINT64_C(0x100000001b3);
+        h ^= h >> 29;
+    }
+
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+static char entry_matches(type_seq_table_entry_t* entry,
+        unsigned int hash, unsigned int qualifiers,
+        const type_t** type_seq, int num_types)
+{
+    return entry->hash == hash
+        && entry->qualifiers == qualifiers
+        && entry->num_types == num_types
+        && memcmp(entry->type_seq, type_seq, num_types * sizeof(*type_seq)) == 0;
+}
+
+const type_t* type_seq_table_lookup(type_seq_table_t* table,
+        unsigned int hash, unsigned int qualifiers,
+        const type_t** type_seq, int num_types)
+{
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = hash & mask;
+    type_seq_table_entry_t* entry;
+    while ((entry = table->entries[i]) != NULL)
+    {
+        if (entry_matches(entry, hash, qualifiers, type_seq, num_types))
+            return entry->result;
+
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+static void type_seq_table_grow(type_seq_table_t* table)
+{
+    int old_capacity = table->capacity;
+    type_seq_table_entry_t** old_entries = table->entries;
+
+    table->capacity = 2 * old_capacity;
+    table->entries = NEW_VEC0(type_seq_table_entry_t*, table->capacity);
+
+    unsigned int mask = table->capacity - 1;
+    int i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (old_entries[i] == NULL)
+            continue;
+
+        unsigned int j = old_entries[i]->hash & mask;
+        while (table->entries[j] != NULL)
+            j = (j + 1) & mask;
+
+        table->entries[j] = old_entries[i];
+    }
+
+    DELETE(old_entries);
+}
+
+void type_seq_table_insert(type_seq_table_t* table,
+        unsigned int hash, unsigned int qualifiers,
+        const type_t** type_seq, int num_types,
+        const type_t* result)
+{
+    // Keep the load factor below 3/4
+    if (4 * (table->num_entries + 1) > 3 * table->capacity)
+        type_seq_table_grow(table);
+
+    unsigned int mask = table->capacity - 1;
+    unsigned int i = hash & mask;
+    type_seq_table_entry_t* entry;
+    while ((entry = table->entries[i]) != NULL)
+    {
+        ERROR_CONDITION(entry_matches(entry, hash, qualifiers, type_seq, num_types),
+                "This sequence of types is already in the table", 0);
+
+        i = (i + 1) & mask;
+    }
+
+    entry = NEW(type_seq_table_entry_t);
+    entry->hash = hash;
+    entry->qualifiers = qualifiers;
+    entry->num_types = num_types;
+    entry->type_seq = NEW_VEC(const type_t*, num_types);
+    memcpy(entry->type_seq, type_seq, num_types * sizeof(*type_seq));
+    entry->result = result;
+
+    table->entries[i] = entry;
+    table->num_entries++;
+}
@@ -0,0 +1,57 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_TYPE_SEQ_TABLE_H
+#define CXX_TYPE_SEQ_TABLE_H
+
+#include "cxx-type-decls.h"
+
+MCXX_BEGIN_DECLS
+
+// Maps a sequence of types plus some qualifier bits to a type. Used to share
+// function, braced list and sequence types
+typedef struct type_seq_table_tag type_seq_table_t;
+
+type_seq_table_t* type_seq_table_new(void);
+
+// The hash is computed once by the caller and passed to both lookup and insert
+unsigned int type_seq_table_hash(unsigned int qualifiers,
+        const type_t** type_seq, int num_types);
+
+const type_t* type_seq_table_lookup(type_seq_table_t* table,
+        unsigned int hash, unsigned int qualifiers,
+        const type_t** type_seq, int num_types);
+void type_seq_table_insert(type_seq_table_t* table,
+        unsigned int hash, unsigned int qualifiers,
+        const type_t** type_seq, int num_types,
+        const type_t* result);
+
+MCXX_END_DECLS
+
+#endif // CXX_TYPE_SEQ_TABLE_H
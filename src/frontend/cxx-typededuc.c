@@ -4359,8 +4359,7 @@ static deduction_result_t deduce_template_arguments_from_call_function_aux(
     return DEDUCTION_OK;
 }
 
-// 14.8.2.1 [temp.deduct.call]
-deduction_result_t deduce_template_arguments_from_function_call(
+static deduction_result_t deduce_template_arguments_from_function_call_uncached(
         type_t** call_argument_types,
         int num_arguments,
         type_t* specialized_named_type,
@@ -4411,6 +4410,320 @@ deduction_result_t deduce_template_arguments_from_function_call(
     return deduction_result;
 }
 
+/*
+ * Deduction cache
+ *
+ * The same function template tends to be a candidate of many calls with the
+ * same argument types (think of std::swap or std::operator<<). The result of
+ * deducing template arguments from a function call is memoized using as a
+ * key the template, the explicit template arguments, the canonical types of
+ * the call arguments and the namespace of the call, where argument dependent
+ * lookup starts. The enclosing block and class scopes of the call are not
+ * part of the key, so calls from different function bodies share entries.
+ *
+ * Only explicit template arguments that are types or templates are cached:
+ * nontype ones are expressions evaluated in the scope of the call. Argument
+ * types are only cached when they will not change later in the translation
+ * unit: they are not dependent and the classes they involve are complete.
+ *
+ * Failed deductions are not cached: substitution failures may depend on
+ * declarations that appear later in the translation unit, like a function
+ * found by argument dependent lookup in a SFINAE context.
+ */
+typedef
+struct deduction_cache_entry_tag
+{
+    unsigned int hash;
+    int num_words;
+    uintptr_t* words;
+
+    deduction_result_t result;
+    template_parameter_list_t* deduced_template_arguments;
+} deduction_cache_entry_t;
+
+static struct
+{
+    int num_entries;
+    int capacity;
+    deduction_cache_entry_t** entries;
+
+    int hits;
+    int misses;
+    int uncacheable;
+} deduction_cache;
+
+void deduction_cache_clear(void)
+{
+    int i;
+    for (i = 0; i < deduction_cache.capacity; i++)
+    {
+        if (deduction_cache.entries[i] != NULL)
+        {
+            free_template_parameter_list(deduction_cache.entries[i]->deduced_template_arguments);
+            DELETE(deduction_cache.entries[i]->words);
+            DELETE(deduction_cache.entries[i]);
+        }
+    }
+    DELETE(deduction_cache.entries);
+
+    deduction_cache.entries = NULL;
+    deduction_cache.num_entries = 0;
+    deduction_cache.capacity = 0;
+}
+
+void deduction_cache_stats(void)
+{
+    fprintf(stderr, " - Template argument deduction cache hits: %d\n", deduction_cache.hits);
+    fprintf(stderr, " - Template argument deduction cache misses: %d\n", deduction_cache.misses);
+    fprintf(stderr, " - Template argument deductions not cacheable: %d\n", deduction_cache.uncacheable);
+
+    int num_deductions = deduction_cache.hits + deduction_cache.misses + deduction_cache.uncacheable;
+    if (num_deductions > 0)
+    {
+        fprintf(stderr, " - Template argument deduction cache hit rate: %.1f%%\n",
+                (100.0 * deduction_cache.hits) / num_deductions);
+    }
+}
+
+static char deduction_cache_key_add_type(uintptr_t* words, int* num_words, type_t* t)
+{
+    if (t == NULL
+            || is_dependent_type(t))
+        return 0;
+
+    type_t* class_type = no_ref(t);
+    for (;;)
+    {
+        if (is_pointer_type(class_type))
+            class_type = pointer_type_get_pointee_type(class_type);
+        else if (is_array_type(class_type))
+            class_type = array_type_get_element_type(class_type);
+        else
+            break;
+    }
+
+    // Deduction may look at the bases of a class
+    if (is_class_type(class_type)
+            && !is_complete_type(class_type))
+        return 0;
+
+    cv_qualifier_t cv_qualifier = CV_NONE;
+    uintptr_t canonical_id = type_get_canonical_id(t, &cv_qualifier);
+    if (canonical_id == 0)
+        return 0;
+
+    words[(*num_words)++] = canonical_id;
+    words[(*num_words)++] = (uintptr_t)cv_qualifier;
+
+    return 1;
+}
+
+static char deduction_cache_key_add_explicit_template_arguments(uintptr_t* words, int* num_words,
+        template_parameter_list_t* raw_explicit_template_arguments)
+{
+    if (raw_explicit_template_arguments == NULL)
+    {
+        words[(*num_words)++] = 0;
+        return 1;
+    }
+
+    words[(*num_words)++] = (uintptr_t)raw_explicit_template_arguments->num_parameters + 1;
+
+    int i;
+    for (i = 0; i < raw_explicit_template_arguments->num_parameters; i++)
+    {
+        template_parameter_value_t* value = raw_explicit_template_arguments->arguments[i];
+        if (value == NULL)
+            return 0;
+
+        words[(*num_words)++] = (uintptr_t)value->kind;
+        switch (value->kind)
+        {
+            case TPK_TYPE:
+                {
+                    if (!deduction_cache_key_add_type(words, num_words, value->type))
+                        return 0;
+                    break;
+                }
+            case TPK_TEMPLATE:
+                {
+                    // Template names are unique
+                    words[(*num_words)++] = (uintptr_t)value->type;
+                    words[(*num_words)++] = 0;
+                    break;
+                }
+            default:
+                {
+                    return 0;
+                }
+        }
+    }
+
+    return 1;
+}
+
+static unsigned int deduction_cache_hash(uintptr_t* words, int num_words)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    int i;
+    for (i = 0; i < num_words; i++)
+    {
+        h ^= words[i];
+        h *= UINT64_C(0x100000001b3);
+        h ^= h >> 29;
+    }
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+static deduction_cache_entry_t** deduction_cache_find_slot(unsigned int hash,
+        uintptr_t* words, int num_words)
+{
+    unsigned int mask = deduction_cache.capacity - 1;
+    unsigned int i = hash & mask;
+    deduction_cache_entry_t* entry;
+    while ((entry = deduction_cache.entries[i]) != NULL)
+    {
+        if (entry->hash == hash
+                && entry->num_words == num_words
+                && memcmp(entry->words, words, num_words * sizeof(*words)) == 0)
+            break;
+
+        i = (i + 1) & mask;
+    }
+    return &deduction_cache.entries[i];
+}
+
+static void deduction_cache_grow(void)
+{
+    int old_capacity = deduction_cache.capacity;
+    deduction_cache_entry_t** old_entries = deduction_cache.entries;
+
+    deduction_cache.capacity = (old_capacity == 0) ? 256 : 2 * old_capacity;
+    deduction_cache.entries = NEW_VEC0(deduction_cache_entry_t*, deduction_cache.capacity);
+
+    int i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        deduction_cache_entry_t* entry = old_entries[i];
+        if (entry == NULL)
+            continue;
+
+        *deduction_cache_find_slot(entry->hash, entry->words, entry->num_words) = entry;
+    }
+
+    DELETE(old_entries);
+}
+
+// 14.8.2.1 [temp.deduct.call]
+deduction_result_t deduce_template_arguments_from_function_call(
+        type_t** call_argument_types,
+        int num_arguments,
+        type_t* specialized_named_type,
+        template_parameter_list_t* template_parameters,         // those of the primary
+        template_parameter_list_t* type_template_parameters,    // those of the template-type
+        template_parameter_list_t* raw_explicit_template_arguments, // explicit by the user
+        const decl_context_t* decl_context,
+        const locus_t* locus,
+        // out
+        template_parameter_list_t **out_deduced_template_arguments)
+{
+    int max_words = 5 + 2 * num_arguments;
+    if (raw_explicit_template_arguments != NULL)
+        max_words += 3 * raw_explicit_template_arguments->num_parameters;
+
+    uintptr_t words[max_words];
+    int num_words = 0;
+
+    words[num_words++] = (uintptr_t)specialized_named_type;
+    words[num_words++] = (uintptr_t)template_parameters;
+    words[num_words++] = (uintptr_t)type_template_parameters;
+    words[num_words++] = (uintptr_t)decl_context->namespace_scope;
+
+    char is_cacheable = deduction_cache_key_add_explicit_template_arguments(words, &num_words,
+            raw_explicit_template_arguments);
+
+    int i;
+    for (i = 0; i < num_arguments && is_cacheable; i++)
+    {
+        is_cacheable = deduction_cache_key_add_type(words, &num_words, call_argument_types[i]);
+    }
+
+    if (!is_cacheable)
+    {
+        deduction_cache.uncacheable++;
+        return deduce_template_arguments_from_function_call_uncached(
+                call_argument_types,
+                num_arguments,
+                specialized_named_type,
+                template_parameters,
+                type_template_parameters,
+                raw_explicit_template_arguments,
+                decl_context,
+                locus,
+                out_deduced_template_arguments);
+    }
+
+    unsigned int hash = deduction_cache_hash(words, num_words);
+
+    if (deduction_cache.capacity != 0)
+    {
+        deduction_cache_entry_t* entry = *deduction_cache_find_slot(hash, words, num_words);
+        if (entry != NULL)
+        {
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "TYPEDEDUC: Deduction cache hit\n");
+            }
+            deduction_cache.hits++;
+
+            *out_deduced_template_arguments = NULL;
+            if (entry->deduced_template_arguments != NULL)
+            {
+                *out_deduced_template_arguments =
+                    duplicate_template_argument_list(entry->deduced_template_arguments);
+            }
+            return entry->result;
+        }
+    }
+
+    deduction_cache.misses++;
+
+    deduction_result_t result = deduce_template_arguments_from_function_call_uncached(
+            call_argument_types,
+            num_arguments,
+            specialized_named_type,
+            template_parameters,
+            type_template_parameters,
+            raw_explicit_template_arguments,
+            decl_context,
+            locus,
+            out_deduced_template_arguments);
+
+    if (result != DEDUCTION_OK)
+        return result;
+
+    // Keep the load factor below 3/4
+    if (4 * (deduction_cache.num_entries + 1) > 3 * deduction_cache.capacity)
+        deduction_cache_grow();
+
+    deduction_cache_entry_t* new_entry = NEW0(deduction_cache_entry_t);
+    new_entry->hash = hash;
+    new_entry->num_words = num_words;
+    new_entry->words = NEW_VEC(uintptr_t, num_words);
+    memcpy(new_entry->words, words, num_words * sizeof(*words));
+    new_entry->result = result;
+    if (*out_deduced_template_arguments != NULL)
+    {
+        new_entry->deduced_template_arguments =
+            duplicate_template_argument_list(*out_deduced_template_arguments);
+    }
+
+    *deduction_cache_find_slot(hash, words, num_words) = new_entry;
+    deduction_cache.num_entries++;
+
+    return result;
+}
+
 // 14.8.2.2 [temp.deduct.funcaddr]
 deduction_result_t deduce_template_arguments_from_address_of_a_function_template(
         type_t* specified_type, /* A */
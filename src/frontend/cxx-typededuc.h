@@ -74,6 +74,9 @@ LIBMCXX_EXTERN deduction_result_t deduce_template_arguments_from_function_call(
         // out
         template_parameter_list_t **out_deduced_template_arguments);
 
+LIBMCXX_EXTERN void deduction_cache_clear(void);
+LIBMCXX_EXTERN void deduction_cache_stats(void);
+
 LIBMCXX_EXTERN deduction_result_t deduce_template_arguments_for_conversion_function(
         scope_entry_t* conversion_function,
         type_t* required_type, /* A */
@@ -32,7 +32,7 @@
 #include "cxx-buildscope.h"
 #include "cxx-typeutils.h"
 #include "cxx-typeenviron.h"
-#include "cxx-type-trie.h"
+#include "cxx-type-seq-table.h"
 #include "cxx-utils.h"
 #include "cxx-cexpr.h"
 #include "cxx-exprtype.h"
@@ -240,6 +240,25 @@ struct class_info_tag {
 // functions to something neither arrays to something.  So every basic type is
 // represented here including builtin types, classes, structs, enums, unions
 // and other nuclear types (like type template parameters)
+
+// Hash index of the specializations of a template type, see
+// template_type_get_identical_specialized_type and
+// template_type_get_equivalent_specialized_type
+typedef
+struct specialization_index_item_tag
+{
+    unsigned int hash;
+    type_t* specialization;
+} specialization_index_item_t;
+
+typedef
+struct specialization_index_tag
+{
+    int num_items;
+    int capacity;
+    specialization_index_item_t* items;
+} specialization_index_t;
+
 typedef
 struct simple_type_tag {
     // Kind
@@ -318,6 +337,10 @@ struct simple_type_tag {
     //   All specialized types
     int num_all_specialized_types;
     type_t** all_specialized_types;
+    //   Hash indexes of the two lists above (the primary is not in the
+    //   unique index)
+    specialization_index_t* unique_specialization_index;
+    specialization_index_t* all_specialization_index;
 
     // Template dependent types (STK_TEMPLATE_DEPENDENT_TYPE)
     scope_entry_t* dependent_entry;
@@ -555,6 +578,10 @@ struct type_tag
 
     // Cache typedefs
     type_t* _advanced_type;
+
+    // Hash-consed representative of the equivalence class of this type, see
+    // type_get_canonical
+    struct canonical_type_tag* _canonical_type;
 };
 
 static common_type_info_t* new_common_type_info(void)
@@ -583,6 +610,7 @@ static type_t* copy_type_for_class_alias(type_t* t)
     *result = *t;
 
     result->_advanced_type = NULL;
+    result->_canonical_type = NULL;
 
     result->info = copy_common_type_info(t->info);
 
@@ -600,6 +628,7 @@ static type_t* copy_type_for_variant(type_t* t)
     result->unqualified_type = result;
 
     result->_advanced_type = NULL;
+    result->_canonical_type = NULL;
 
     result->info = copy_common_type_info(t->info);
 
@@ -2017,6 +2046,8 @@ template_parameter_list_t* compute_template_parameter_values_of_primary(template
     return result;
 }
 
+static void specialization_index_add_identical(type_t* template_type, type_t* specialization);
+
 extern inline type_t* get_new_template_alias_type(template_parameter_list_t* template_parameter_list, type_t* aliased_type,
         const char* template_name, const decl_context_t* decl_context, const locus_t* locus)
 {
@@ -2068,6 +2099,8 @@ extern inline type_t* get_new_template_alias_type(template_parameter_list_t* tem
     P_LIST_ADD(type_info->type->all_specialized_types,
             type_info->type->num_all_specialized_types,
             type_info->type->primary_specialization);
+    specialization_index_add_identical(type_info,
+            type_info->type->primary_specialization);
 
     DEBUG_CODE()
     {
@@ -2140,6 +2173,8 @@ extern inline type_t* get_new_template_type(template_parameter_list_t* template_
     P_LIST_ADD(type_info->type->all_specialized_types,
             type_info->type->num_all_specialized_types,
             type_info->type->primary_specialization);
+    specialization_index_add_identical(type_info,
+            type_info->type->primary_specialization);
 
     DEBUG_CODE()
     {
@@ -2547,60 +2582,476 @@ static int compare_identical_template_argument_list_of_named_types(
             template_specialized_type_get_template_arguments(t2));
 }
 
-static type_t* template_type_get_identical_specialized_type(type_t* t,
-        template_parameter_list_t* template_parameters,
-        const decl_context_t* decl_context UNUSED_PARAMETER)
+/*
+ * Hash indexes of specializations
+ *
+ * Every template type keeps two hash indexes of its specializations, one
+ * for identical template arguments and another one for equivalent template
+ * arguments. The hash of a template argument list must be consistent with
+ * compare_identical_template_argument_list and
+ * compare_equivalent_template_argument_list respectively: two lists that
+ * compare equal must have the same hash.
+ */
+static struct
 {
-    ERROR_CONDITION(!is_template_type(t), "This is not a template type", 0);
+    int identical_hits;
+    int identical_misses;
+    int equivalent_hits;
+    int equivalent_misses;
+    // Lists with the same hash that did not compare equal
+    int collisions;
+} specialization_index_stats;
 
-    type_t* specialization = NULL;
+static inline unsigned int specialization_hash_mix(unsigned int h, uintptr_t value)
+{
+    uint64_t x = (uint64_t)value * UINT64_C(0x9e3779b97f4a7c15);
+    x ^= x >> 32;
+    return (h ^ (unsigned int)x) * 0x01000193u;
+}
 
-    int lower = 0;
-    int upper = t->type->num_all_specialized_types - 1;
+static unsigned int specialization_hash_integer_constant(unsigned int h, const_value_t* cv)
+{
+    // Only integer values are hashed. Other constants are compared by value
+    // too but they never appear in template arguments
+    if (cv != NULL
+            && const_value_is_integer(cv))
+        h = specialization_hash_mix(h, (uintptr_t)const_value_cast_to_8(cv));
+    return h;
+}
 
-    while (lower <= upper)
+// Consistent with template_arg_value_type_identical_compare
+static unsigned int identical_template_arg_value_hash(unsigned int h, nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return specialization_hash_mix(h, 0);
+
+    h = specialization_hash_mix(h, nodecl_get_kind(n));
+    h = specialization_hash_mix(h, (uintptr_t)nodecl_get_symbol(n));
+
+    const_value_t* cv = nodecl_get_constant(n);
+    if (cv != NULL
+            && !const_value_is_object(cv)
+            && !const_value_is_address(cv))
+        h = specialization_hash_integer_constant(h, cv);
+
+    h = specialization_hash_mix(h, (uintptr_t)nodecl_get_type(n));
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
     {
-        int middle = (lower + upper) / 2;
+        h = identical_template_arg_value_hash(h, nodecl_get_child(n, i));
+    }
 
-        type_t* current_specialization = t->type->all_specialized_types[middle];
+    return h;
+}
 
-        scope_entry_t* entry = named_type_get_symbol(current_specialization);
-        template_parameter_list_t* specialization_template_parameters =
-            template_specialized_type_get_template_arguments(entry->type_information);
+// Consistent with compare_identical_template_argument_list
+static unsigned int identical_template_argument_list_hash(template_parameter_list_t* template_arguments)
+{
+    unsigned int h = specialization_hash_mix(0x811c9dc5u, template_arguments->num_parameters);
 
-        DEBUG_CODE()
+    int i;
+    for (i = 0; i < template_arguments->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_arguments->arguments[i];
+        h = specialization_hash_mix(h, targ->kind);
+        switch (targ->kind)
         {
-            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d in [%d<=%d, %d<=%d] '%s' (%p) at '%s'\n",
-                    t->type,
-                    middle,
-                    0,
-                    lower,
-                    upper,
-                    t->type->num_all_specialized_types - 1,
-                    print_type_str(current_specialization, entry->decl_context),
-                    entry->type_information,
-                    locus_to_str(entry->locus));
+            case TPK_TYPE:
+            case TPK_TEMPLATE:
+                {
+                    h = specialization_hash_mix(h, (uintptr_t)targ->type);
+                    break;
+                }
+            case TPK_NONTYPE:
+                {
+                    h = identical_template_arg_value_hash(h, targ->value);
+                    break;
+                }
+            default:
+                {
+                    internal_error("Invalid template argument kind", 0);
+                }
         }
+    }
+
+    return h;
+}
+
+static unsigned int equivalent_template_argument_list_hash(unsigned int h,
+        template_parameter_list_t* template_arguments);
+static unsigned int equivalent_template_arg_value_type_hash(unsigned int h, type_t* t);
+
+// Consistent with template_arg_value_expr_equivalent_compare. Whenever that
+// function compares different things depending on only one of the operands
+// nothing is hashed
+static unsigned int equivalent_template_arg_value_expr_hash(unsigned int h, nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return specialization_hash_mix(h, 0);
 
-        int cmp = compare_identical_template_argument_list(
-                template_parameters,
-                specialization_template_parameters);
+    const_value_t* cv = nodecl_get_constant(n);
+    h = specialization_hash_mix(h, 1 + (cv != NULL));
+    if (cv != NULL)
+    {
+        if (!const_value_is_address_or_object(cv))
+            return specialization_hash_integer_constant(h, cv);
+        return h;
+    }
 
-        if (cmp == 0)
+    scope_entry_t* entry = nodecl_get_symbol(n);
+    h = specialization_hash_mix(h, entry != NULL);
+    if (entry != NULL)
+    {
+        h = specialization_hash_mix(h, entry->kind);
+        if (entry->kind == SK_TEMPLATE_NONTYPE_PARAMETER)
         {
-            specialization = current_specialization;
-            break;
+            h = specialization_hash_mix(h, symbol_entity_specs_get_template_parameter_nesting(entry));
+            h = specialization_hash_mix(h, symbol_entity_specs_get_template_parameter_position(entry));
         }
-        else if (cmp < 0)
+        else if (entry->kind != SK_VARIABLE
+                && entry->kind != SK_DEPENDENT_ENTITY)
         {
-            upper = middle - 1;
+            h = specialization_hash_mix(h, (uintptr_t)entry);
         }
-        else if (cmp > 0)
+        return h;
+    }
+
+    h = specialization_hash_mix(h, nodecl_get_kind(n));
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        h = equivalent_template_arg_value_expr_hash(h, nodecl_get_child(n, i));
+    }
+
+    return h;
+}
+
+// Consistent with template_arg_value_type_equivalent_compare_aux
+static unsigned int equivalent_template_arg_value_type_hash(unsigned int h, type_t* t)
+{
+    if (t == NULL)
+        return specialization_hash_mix(h, 0);
+
+    cv_qualifier_t cv_qualifier = CV_NONE;
+    t = advance_over_typedefs_with_cv_qualif(t, &cv_qualifier);
+
+    h = specialization_hash_mix(h, cv_qualifier);
+    h = specialization_hash_mix(h, 1 + t->kind);
+
+    switch (t->kind)
+    {
+        case TK_DIRECT:
+            {
+                h = specialization_hash_mix(h, t->type->kind);
+                switch (t->type->kind)
+                {
+                    case STK_BUILTIN_TYPE:
+                        {
+                            h = specialization_hash_mix(h, t->type->builtin_type);
+                            h = specialization_hash_mix(h,
+                                    t->type->is_signed
+                                    | (t->type->is_unsigned << 1)
+                                    | (t->type->is_long << 2)
+                                    | (t->type->is_short << 4));
+                            break;
+                        }
+                    case STK_CLASS:
+                        {
+                            h = specialization_hash_mix(h, t->info->is_template_specialized_type);
+                            if (t->info->is_template_specialized_type)
+                            {
+                                scope_entry_t* entry = template_type_get_related_symbol(t->related_template_type);
+                                h = specialization_hash_mix(h, entry->kind);
+                                if (entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER
+                                        || entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER_PACK)
+                                {
+                                    h = specialization_hash_mix(h,
+                                            symbol_entity_specs_get_template_parameter_nesting(entry));
+                                    h = specialization_hash_mix(h,
+                                            symbol_entity_specs_get_template_parameter_position(entry));
+                                    h = equivalent_template_argument_list_hash(h,
+                                            template_specialized_type_get_template_arguments(t));
+                                    break;
+                                }
+                            }
+                            h = specialization_hash_mix(h, (uintptr_t)t->type);
+                            break;
+                        }
+                    case STK_ENUM:
+                    case STK_TEMPLATE_TYPE:
+                        {
+                            h = specialization_hash_mix(h, (uintptr_t)t->type);
+                            break;
+                        }
+                    case STK_UNDERLYING:
+                        {
+                            h = equivalent_template_arg_value_type_hash(h, t->type->underlying_type);
+                            break;
+                        }
+                    case STK_COMPLEX:
+                        {
+                            h = equivalent_template_arg_value_type_hash(h, t->type->complex_element);
+                            break;
+                        }
+                    case STK_VECTOR:
+                        {
+                            h = equivalent_template_arg_value_type_hash(h, t->type->vector_element);
+                            h = specialization_hash_mix(h, t->type->vector_size);
+                            break;
+                        }
+                    case STK_MASK:
+                        {
+                            h = specialization_hash_mix(h, t->type->vector_size);
+                            break;
+                        }
+                    case STK_INDIRECT:
+                    case STK_TEMPLATE_DEPENDENT_TYPE:
+                        {
+                            // Template parameters are compared by position
+                            // but only when both are template parameters
+                            scope_entry_t* entry = NULL;
+                            if (t->type->kind == STK_INDIRECT)
+                                entry = t->type->user_defined_type;
+                            else
+                                entry = t->type->dependent_entry;
+                            h = specialization_hash_mix(h, entry->kind);
+                            break;
+                        }
+                    default:
+                        {
+                            // STK_VA_LIST, STK_TYPE_DEP_EXPR, STK_TYPEOF
+                            break;
+                        }
+                }
+                break;
+            }
+        case TK_POINTER:
+        case TK_LVALUE_REFERENCE:
+        case TK_RVALUE_REFERENCE:
+        case TK_REBINDABLE_REFERENCE:
+            {
+                h = equivalent_template_arg_value_type_hash(h, t->pointer->pointee);
+                break;
+            }
+        case TK_POINTER_TO_MEMBER:
+            {
+                h = equivalent_template_arg_value_type_hash(h, t->pointer->pointee_class_type);
+                h = equivalent_template_arg_value_type_hash(h, t->pointer->pointee);
+                break;
+            }
+        case TK_ARRAY:
+            {
+                h = equivalent_template_arg_value_type_hash(h, t->array->element_type);
+                h = equivalent_template_arg_value_expr_hash(h, t->array->whole_size);
+                break;
+            }
+        case TK_FUNCTION:
+            {
+                h = equivalent_template_arg_value_type_hash(h, t->function->return_type);
+                h = specialization_hash_mix(h, t->function->num_parameters);
+                int i;
+                for (i = 0; i < t->function->num_parameters; i++)
+                {
+                    h = specialization_hash_mix(h, t->function->parameter_list[i]->is_ellipsis);
+                    h = equivalent_template_arg_value_type_hash(h,
+                            t->function->parameter_list[i]->type_info);
+                }
+                h = specialization_hash_mix(h, t->function->ref_qualifier);
+                break;
+            }
+        case TK_PACK:
+            {
+                h = equivalent_template_arg_value_type_hash(h, t->pack_type->packed);
+                break;
+            }
+        case TK_SEQUENCE:
+            {
+                h = specialization_hash_mix(h, t->sequence_type->num_types);
+                int i;
+                for (i = 0; i < t->sequence_type->num_types; i++)
+                {
+                    h = equivalent_template_arg_value_type_hash(h, t->sequence_type->types[i]);
+                }
+                break;
+            }
+        default:
+            {
+                break;
+            }
+    }
+
+    return h;
+}
+
+// Consistent with compare_equivalent_template_argument_list
+static unsigned int equivalent_template_argument_list_hash(unsigned int h,
+        template_parameter_list_t* template_arguments)
+{
+    h = specialization_hash_mix(h, template_arguments->num_parameters);
+
+    int i;
+    for (i = 0; i < template_arguments->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_arguments->arguments[i];
+        h = specialization_hash_mix(h, targ->kind);
+        h = equivalent_template_arg_value_type_hash(h, targ->type);
+        if (targ->kind == TPK_NONTYPE)
+        {
+            h = equivalent_template_arg_value_expr_hash(h, targ->value);
+        }
+    }
+
+    return h;
+}
+
+static void specialization_index_insert(specialization_index_t** p_index,
+        unsigned int hash,
+        type_t* specialization);
+
+static void specialization_index_grow(specialization_index_t* index)
+{
+    int old_capacity = index->capacity;
+    specialization_index_item_t* old_items = index->items;
+
+    index->capacity = (old_capacity == 0) ? 16 : 2 * old_capacity;
+    index->items = NEW_VEC0(specialization_index_item_t, index->capacity);
+
+    unsigned int mask = index->capacity - 1;
+    int i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (old_items[i].specialization == NULL)
+            continue;
+
+        unsigned int j = old_items[i].hash & mask;
+        while (index->items[j].specialization != NULL)
+            j = (j + 1) & mask;
+        index->items[j] = old_items[i];
+    }
+
+    DELETE(old_items);
+}
+
+static void specialization_index_insert(specialization_index_t** p_index,
+        unsigned int hash,
+        type_t* specialization)
+{
+    if (*p_index == NULL)
+        *p_index = NEW0(specialization_index_t);
+
+    specialization_index_t* index = *p_index;
+    if (4 * (index->num_items + 1) > 3 * index->capacity)
+        specialization_index_grow(index);
+
+    unsigned int mask = index->capacity - 1;
+    unsigned int j = hash & mask;
+    while (index->items[j].specialization != NULL)
+        j = (j + 1) & mask;
+
+    index->items[j].hash = hash;
+    index->items[j].specialization = specialization;
+    index->num_items++;
+}
+
+static type_t* specialization_index_lookup(specialization_index_t* index,
+        unsigned int hash,
+        template_parameter_list_t* template_arguments,
+        int (*compare)(template_parameter_list_t*, template_parameter_list_t*))
+{
+    if (index == NULL)
+        return NULL;
+
+    unsigned int mask = index->capacity - 1;
+    unsigned int j = hash & mask;
+    while (index->items[j].specialization != NULL)
+    {
+        if (index->items[j].hash == hash)
         {
-            lower = middle + 1;
+            type_t* current_specialization = index->items[j].specialization;
+            scope_entry_t* entry = named_type_get_symbol(current_specialization);
+
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "TYPEUTILS: Checking with specialization '%s' (%p) at '%s'\n",
+                        print_type_str(current_specialization, entry->decl_context),
+                        entry->type_information,
+                        locus_to_str(entry->locus));
+            }
+
+            if (compare(template_arguments,
+                        template_specialized_type_get_template_arguments(entry->type_information)) == 0)
+                return current_specialization;
+
+            specialization_index_stats.collisions++;
         }
+        j = (j + 1) & mask;
     }
 
+    return NULL;
+}
+
+static int compare_identical_template_argument_list_(
+        template_parameter_list_t* template_parameter_list_1,
+        template_parameter_list_t* template_parameter_list_2)
+{
+    return compare_identical_template_argument_list(template_parameter_list_1,
+            template_parameter_list_2);
+}
+
+static void specialization_index_add_identical(type_t* template_type, type_t* specialization)
+{
+    template_parameter_list_t* template_arguments =
+        template_specialized_type_get_template_arguments(
+                named_type_get_symbol(specialization)->type_information);
+
+    specialization_index_insert(&template_type->type->all_specialization_index,
+            identical_template_argument_list_hash(template_arguments),
+            specialization);
+}
+
+static void specialization_index_add_equivalent(type_t* template_type, type_t* specialization)
+{
+    template_parameter_list_t* template_arguments =
+        template_specialized_type_get_template_arguments(
+                named_type_get_symbol(specialization)->type_information);
+
+    specialization_index_insert(&template_type->type->unique_specialization_index,
+            equivalent_template_argument_list_hash(0x811c9dc5u, template_arguments),
+            specialization);
+}
+
+void template_specialization_index_stats(void)
+{
+    fprintf(stderr, " - Identical specialization lookups (hits): %d\n",
+            specialization_index_stats.identical_hits);
+    fprintf(stderr, " - Identical specialization lookups (misses): %d\n",
+            specialization_index_stats.identical_misses);
+    fprintf(stderr, " - Equivalent specialization lookups (hits): %d\n",
+            specialization_index_stats.equivalent_hits);
+    fprintf(stderr, " - Equivalent specialization lookups (misses): %d\n",
+            specialization_index_stats.equivalent_misses);
+    fprintf(stderr, " - Specialization index hash collisions: %d\n",
+            specialization_index_stats.collisions);
+}
+
+static type_t* template_type_get_identical_specialized_type(type_t* t,
+        template_parameter_list_t* template_parameters,
+        const decl_context_t* decl_context UNUSED_PARAMETER)
+{
+    ERROR_CONDITION(!is_template_type(t), "This is not a template type", 0);
+
+    type_t* specialization = specialization_index_lookup(
+            t->type->all_specialization_index,
+            identical_template_argument_list_hash(template_parameters),
+            template_parameters,
+            compare_identical_template_argument_list_);
+
+    if (specialization != NULL)
+        specialization_index_stats.identical_hits++;
+    else
+        specialization_index_stats.identical_misses++;
+
     return specialization;
 }
 
@@ -3311,53 +3762,11 @@ static type_t* template_type_get_equivalent_specialized_type(type_t* t,
                 template_type_get_num_specializations(t));
     }
 
-    type_t* specialization = NULL;
-
-    int lower = 0;
-    int upper = t->type->num_unique_specialized_types - 1;
-
-    while (lower <= upper)
-    {
-        int middle = (lower + upper) / 2;
-
-        type_t* current_specialization = t->type->unique_specialized_types[middle];
-
-        scope_entry_t* entry = named_type_get_symbol(current_specialization);
-        template_parameter_list_t* specialization_template_parameters =
-            template_specialized_type_get_template_arguments(entry->type_information);
-
-        DEBUG_CODE()
-        {
-            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d in [%d<=%d, %d<=%d] '%s' (%p) at '%s'\n",
-                    t->type,
-                    middle,
-                    0,
-                    lower,
-                    upper,
-                    t->type->num_unique_specialized_types - 1,
-                    print_type_str(current_specialization, entry->decl_context),
-                    entry->type_information,
-                    locus_to_str(entry->locus));
-        }
-
-        int cmp = compare_equivalent_template_argument_list(
-                template_parameters,
-                specialization_template_parameters);
-
-        if (cmp == 0)
-        {
-            specialization = current_specialization;
-            break;
-        }
-        else if (cmp < 0)
-        {
-            upper = middle - 1;
-        }
-        else if (cmp > 0)
-        {
-            lower = middle + 1;
-        }
-    }
+    type_t* specialization = specialization_index_lookup(
+            t->type->unique_specialization_index,
+            equivalent_template_argument_list_hash(0x811c9dc5u, template_parameters),
+            template_parameters,
+            compare_equivalent_template_argument_list);
 
     if (specialization == NULL)
     {
@@ -3382,6 +3791,7 @@ static type_t* template_type_get_equivalent_specialized_type(type_t* t,
 
     if (specialization != NULL)
     {
+        specialization_index_stats.equivalent_hits++;
         DEBUG_CODE()
         {
             scope_entry_t* entry = named_type_get_symbol(specialization);
@@ -3393,6 +3803,7 @@ static type_t* template_type_get_equivalent_specialized_type(type_t* t,
     }
     else
     {
+        specialization_index_stats.equivalent_misses++;
         DEBUG_CODE()
         {
             fprintf(stderr, "TYPEUTILS: No existing specialization matches\n");
@@ -3798,6 +4209,7 @@ static type_t* template_type_get_specialized_type_(
                     template_type->type->unique_specialized_types[j-1];
             }
             template_type->type->unique_specialized_types[lower] = result;
+            specialization_index_add_equivalent(template_type, result);
 #if 0
             int i;
             for (i = 0; i < template_type->type->num_unique_specialized_types - 1; i++)
@@ -3985,6 +4397,7 @@ static type_t* template_type_get_specialized_type_(
                 template_type->type->all_specialized_types[j-1];
         }
         template_type->type->all_specialized_types[lower] = result;
+        specialization_index_add_identical(template_type, result);
     }
 
     return result;
@@ -4319,6 +4732,7 @@ static inline type_t *get_qualified_type(type_t *original,
         qualified_type->unqualified_type = original->unqualified_type;
 
         qualified_type->_advanced_type = NULL;
+        qualified_type->_canonical_type = NULL;
 
         dhash_ptr_insert(_qualification[(int)(cv_qualification)], 
                 (const char*)original->unqualified_type, 
@@ -5403,6 +5817,7 @@ static type_t* _get_duplicated_class_type(type_t* class_type)
     result->unqualified_type = result;
 
     result->_advanced_type = NULL;
+    result->_canonical_type = NULL;
 
     // These are the parts relevant for duplication
     result->info = NEW0(common_type_info_t);
@@ -5453,23 +5868,16 @@ type_t* get_new_function_type_common(type_t* t,
         char is_trailing,
         ref_qualifier_t ref_qualifier)
 {
-#define MY_MAX(a, b) ((a) > (b) ? (a) : (b))
-#define MAX_REF_QUALIFIER MY_MAX(REF_QUALIFIER_NONE, MY_MAX(REF_QUALIFIER_RVALUE, REF_QUALIFIER_LVALUE))
-    static type_trie_t* _function_tries[2][2][MAX_REF_QUALIFIER + 1] = { };
-#undef MAX_REF_QUALIFIER
-#undef MY_MAX
-
-    type_trie_t* used_trie = NULL;
-
-    if (_function_tries[!!is_trailing][!!t][ref_qualifier] == NULL)
+    static type_seq_table_t* _function_types_table = NULL;
+    if (_function_types_table == NULL)
     {
-        _function_tries[!!is_trailing][!!t][ref_qualifier] = allocate_type_trie();
+        _function_types_table = type_seq_table_new();
     }
 
-    used_trie = _function_tries[!!is_trailing][!!t][ref_qualifier];
+    unsigned int qualifiers = (!!is_trailing) | ((!!t) << 1) | (ref_qualifier << 2);
 
     const type_t* type_seq[num_parameters + 1];
-    //  Don't worry, this 'void' is just for the trie
+    //  Don't worry, this 'void' is just for the table
     type_seq[0] = (t != NULL ? t : get_void_type());
 
     char fun_type_is_dependent = 0;
@@ -5499,19 +5907,22 @@ type_t* get_new_function_type_common(type_t* t,
         }
         else
         {
-            // This type is just for the trie 
+            // This type is just for the table
             type_seq[i + 1] = get_ellipsis_type();
         }
     }
 
+    unsigned int hash = type_seq_table_hash(qualifiers, type_seq, num_parameters + 1);
+
     // Cast to drop 'const'
-    type_t* function_type = (type_t*)lookup_type_trie(used_trie, 
-            type_seq, num_parameters + 1);
+    type_t* function_type = (type_t*)type_seq_table_lookup(_function_types_table,
+            hash, qualifiers, type_seq, num_parameters + 1);
 
     if (function_type == NULL)
     {
         type_t* new_funct_type = _get_new_function_type(t, parameter_info, num_parameters, is_trailing, ref_qualifier);
-        insert_type_trie(used_trie, type_seq, num_parameters + 1, new_funct_type);
+        type_seq_table_insert(_function_types_table,
+                hash, qualifiers, type_seq, num_parameters + 1, new_funct_type);
         function_type = new_funct_type;
 
         set_is_dependent_type(function_type, fun_type_is_dependent);
@@ -7065,6 +7476,446 @@ extern inline scope_entry_list_t* class_type_get_all_conversions(type_t* class_t
  * (ignoring typedefs). Just plain comparison, no standard conversion is
  * performed. cv-qualifiers are relevant for comparison
  */
+/*
+ * Hash-consing of types
+ *
+ * Every nondependent type gets a canonical representative that is unique
+ * for all the types that are structurally equivalent (modulo the top level
+ * cv-qualifier). This way equivalent_types is just a pointer comparison
+ * once both types have their canonical representative computed.
+ *
+ * The key of a type is made of its kind and the canonical representatives
+ * (plus the cv-qualifier) of its components, so the key is computed only
+ * once per type object and it never requires a structural comparison.
+ * Template specializations of classes are the only exception: their key is
+ * the template and a hash of their template arguments, and
+ * equivalent_simple_types is used to tell apart the representatives with the
+ * same key.
+ *
+ * Dependent types, types that depend on mutable typedefs and types whose
+ * structural equivalence is not transitive (e.g. function types with array
+ * or function parameters, that are compatible with pointer parameters) are
+ * not given a representative and always use the structural comparison.
+ */
+typedef
+struct canonical_type_tag
+{
+    uint32_t hash;
+    int num_words;
+    uintptr_t* words;
+    // Only for class template specializations
+    type_t* specialization;
+} canonical_type_t;
+
+// Stored in _canonical_type of types without canonical representative
+static canonical_type_t not_canonical_type;
+
+static struct
+{
+    int num_types;
+    int capacity;
+    canonical_type_t** types;
+} canonical_types;
+
+typedef
+struct canonical_key_tag
+{
+    int num_words;
+    int capacity;
+    uintptr_t* words;
+    uintptr_t inline_words[16];
+} canonical_key_t;
+
+static void canonical_key_add(canonical_key_t* key, uintptr_t word)
+{
+    if (key->num_words == key->capacity)
+    {
+        int new_capacity = 2 * key->capacity;
+        uintptr_t* new_words = NEW_VEC(uintptr_t, new_capacity);
+        memcpy(new_words, key->words, key->num_words * sizeof(*new_words));
+        if (key->words != key->inline_words)
+            DELETE(key->words);
+        key->words = new_words;
+        key->capacity = new_capacity;
+    }
+    key->words[key->num_words] = word;
+    key->num_words++;
+}
+
+static uint32_t canonical_key_hash(canonical_key_t* key)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    int i;
+    for (i = 0; i < key->num_words; i++)
+    {
+        h ^= key->words[i];
+        h *= UINT64_C(0x100000001b3);
+        h ^= h >> 29;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static canonical_type_t* type_get_canonical(type_t* t);
+
+// Adds to the key the representative of a component type and its
+// cv-qualifier, as equivalent_types would compare them
+static char canonical_key_add_component(canonical_key_t* key, type_t* t)
+{
+    if (t == NULL)
+    {
+        canonical_key_add(key, 0);
+        return 1;
+    }
+
+    cv_qualifier_t cv = CV_NONE;
+    char is_cacheable = 0;
+    t = advance_over_typedefs_with_cv_qualif_(t, &cv, &is_cacheable);
+    if (!is_cacheable)
+        return 0;
+
+    canonical_type_t* canonical = type_get_canonical(t);
+    if (canonical == NULL)
+        return 0;
+
+    canonical_key_add(key, (uintptr_t)canonical);
+    canonical_key_add(key, cv);
+    return 1;
+}
+
+// Adds a hash of the template arguments of a class template specialization.
+// It must be consistent with same_template_argument_list, so arguments that
+// cannot be hashed that way do not contribute to it
+static void canonical_key_add_template_arguments(canonical_key_t* key,
+        template_parameter_list_t* template_arguments)
+{
+    unsigned int h = specialization_hash_mix(0x811c9dc5u, template_arguments->num_parameters);
+
+    int i;
+    for (i = 0; i < template_arguments->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_arguments->arguments[i];
+        h = specialization_hash_mix(h, targ->kind);
+        switch (targ->kind)
+        {
+            case TPK_TYPE:
+            case TPK_TEMPLATE:
+                {
+                    // Like equivalent_types
+                    cv_qualifier_t cv = CV_NONE;
+                    type_t* t = advance_over_typedefs_with_cv_qualif(targ->type, &cv);
+                    canonical_type_t* canonical = NULL;
+                    if (!is_dependent_type(t)
+                            && (canonical = type_get_canonical(t)) != NULL)
+                    {
+                        h = specialization_hash_mix(h, (uintptr_t)canonical);
+                        h = specialization_hash_mix(h, cv);
+                    }
+                    break;
+                }
+            case TPK_NONTYPE:
+                {
+                    // Like same_functional_expression
+                    const_value_t* cv = nodecl_get_constant(targ->value);
+                    if (cv != NULL
+                            && !const_value_is_object(cv)
+                            && !const_value_is_address(cv))
+                        h = specialization_hash_integer_constant(h, cv);
+                    break;
+                }
+            default:
+                {
+                    internal_error("Invalid template argument kind", 0);
+                }
+        }
+    }
+
+    canonical_key_add(key, h);
+}
+
+static char canonical_key_of_simple_type(canonical_key_t* key, type_t* t, char *is_specialization)
+{
+    simple_type_t* simple_type = t->type;
+    canonical_key_add(key, simple_type->kind);
+
+    switch (simple_type->kind)
+    {
+        case STK_BUILTIN_TYPE:
+            {
+                // This must match equivalent_builtin_type
+                enum builtin_type_tag bt = simple_type->builtin_type;
+                canonical_key_add(key, bt);
+                canonical_key_add(key,
+                        (bt == BT_INT || bt == BT_DOUBLE) ? simple_type->is_long : 0);
+                canonical_key_add(key,
+                        (bt == BT_INT) ? simple_type->is_short : 0);
+                canonical_key_add(key,
+                        (bt == BT_INT || bt == BT_BYTE || bt == BT_CHAR)
+                        ? (simple_type->is_unsigned | (simple_type->is_signed << 1)) : 0);
+                canonical_key_add(key,
+                        (bt == BT_BOOL) ? t->info->size : 0);
+                return 1;
+            }
+        case STK_CLASS:
+            {
+                if (t->info->is_template_specialized_type)
+                {
+                    canonical_key_add(key, (uintptr_t)t->related_template_type);
+                    canonical_key_add_template_arguments(key,
+                            template_specialized_type_get_template_arguments(t));
+                    *is_specialization = 1;
+                }
+                else
+                {
+                    canonical_key_add(key, (uintptr_t)simple_type);
+                }
+                return 1;
+            }
+        case STK_TEMPLATE_TYPE:
+        case STK_ENUM:
+            {
+                canonical_key_add(key, (uintptr_t)simple_type);
+                return 1;
+            }
+        case STK_INDIRECT:
+            {
+                scope_entry_t* entry = simple_type->user_defined_type;
+                if (symbol_entity_specs_get_is_template_parameter(entry))
+                    return 0;
+                entry = fortran_get_ultimate_symbol(entry);
+                return canonical_key_add_component(key, entry->type_information);
+            }
+        case STK_VA_LIST:
+            {
+                return 1;
+            }
+        case STK_COMPLEX:
+            {
+                return canonical_key_add_component(key, simple_type->complex_element);
+            }
+        case STK_VECTOR:
+            {
+                canonical_key_add(key, simple_type->vector_size);
+                return canonical_key_add_component(key, simple_type->vector_element);
+            }
+        case STK_MASK:
+            {
+                canonical_key_add(key, mask_type_get_num_bits(t));
+                return 1;
+            }
+        default:
+            {
+                return 0;
+            }
+    }
+}
+
+static char canonical_key_of_type(canonical_key_t* key, type_t* t, char *is_specialization)
+{
+    canonical_key_add(key, t->kind);
+
+    switch (t->kind)
+    {
+        case TK_DIRECT:
+            {
+                return canonical_key_of_simple_type(key, t, is_specialization);
+            }
+        case TK_POINTER:
+        case TK_LVALUE_REFERENCE:
+        case TK_RVALUE_REFERENCE:
+        case TK_REBINDABLE_REFERENCE:
+            {
+                return canonical_key_add_component(key, t->pointer->pointee);
+            }
+        case TK_POINTER_TO_MEMBER:
+            {
+                return canonical_key_add_component(key, t->pointer->pointee)
+                    && canonical_key_add_component(key, t->pointer->pointee_class_type);
+            }
+        case TK_ARRAY:
+            {
+                nodecl_t whole_size = t->array->whole_size;
+                if (nodecl_is_null(whole_size))
+                {
+                    canonical_key_add(key, 0);
+                }
+                else if (nodecl_is_constant(whole_size)
+                        && const_value_is_integer(nodecl_get_constant(whole_size)))
+                {
+                    canonical_key_add(key, 1);
+                    canonical_key_add(key,
+                            (uintptr_t)const_value_cast_to_8(nodecl_get_constant(whole_size)));
+                }
+                else
+                {
+                    return 0;
+                }
+                return canonical_key_add_component(key, t->array->element_type);
+            }
+        case TK_FUNCTION:
+            {
+                function_info_t* function_info = t->function;
+                canonical_key_add(key, t->cv_qualifier);
+                canonical_key_add(key, function_info->ref_qualifier);
+                canonical_key_add(key, function_info->num_parameters);
+                if (!canonical_key_add_component(key, function_info->return_type))
+                    return 0;
+
+                int i;
+                for (i = 0; i < function_info->num_parameters; i++)
+                {
+                    parameter_info_t* parameter = function_info->parameter_list[i];
+                    if (parameter->is_ellipsis)
+                    {
+                        canonical_key_add(key, 1);
+                        continue;
+                    }
+
+                    // See compatible_parameters
+                    type_t* parameter_type = get_cv_qualified_type(parameter->type_info, CV_NONE);
+                    if (parameter_type->kind == TK_ARRAY
+                            || parameter_type->kind == TK_FUNCTION)
+                        return 0;
+
+                    canonical_key_add(key, 0);
+                    if (!canonical_key_add_component(key, parameter_type))
+                        return 0;
+                }
+                return 1;
+            }
+        default:
+            {
+                return 0;
+            }
+    }
+}
+
+static void canonical_types_grow(void)
+{
+    int old_capacity = canonical_types.capacity;
+    canonical_type_t** old_types = canonical_types.types;
+
+    canonical_types.capacity = (old_capacity == 0) ? 1024 : 2 * old_capacity;
+    canonical_types.types = NEW_VEC0(canonical_type_t*, canonical_types.capacity);
+
+    uint32_t mask = canonical_types.capacity - 1;
+    int i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (old_types[i] == NULL)
+            continue;
+
+        uint32_t j = old_types[i]->hash & mask;
+        while (canonical_types.types[j] != NULL)
+            j = (j + 1) & mask;
+        canonical_types.types[j] = old_types[i];
+    }
+
+    DELETE(old_types);
+}
+
+static canonical_type_t* canonical_types_get(canonical_key_t* key,
+        type_t* specialization)
+{
+    uint32_t hash = canonical_key_hash(key);
+    uint32_t j;
+    char rehashed;
+    do
+    {
+        rehashed = 0;
+        if (4 * (canonical_types.num_types + 1) > 3 * canonical_types.capacity)
+            canonical_types_grow();
+
+        uint32_t mask = canonical_types.capacity - 1;
+        j = hash & mask;
+        canonical_type_t* current;
+        while ((current = canonical_types.types[j]) != NULL)
+        {
+            if (current->hash == hash
+                    && current->num_words == key->num_words
+                    && memcmp(current->words, key->words, key->num_words * sizeof(*key->words)) == 0)
+            {
+                if (specialization == NULL)
+                    return current;
+
+                // Comparing the template arguments may compute their
+                // canonical types and grow the table, so probe again in the
+                // new one in that case
+                int capacity = canonical_types.capacity;
+                if (equivalent_simple_types(current->specialization, specialization))
+                    return current;
+                if (capacity != canonical_types.capacity)
+                {
+                    rehashed = 1;
+                    break;
+                }
+            }
+            j = (j + 1) & mask;
+        }
+    } while (rehashed);
+
+    canonical_type_t* result = NEW0(canonical_type_t);
+    result->hash = hash;
+    result->num_words = key->num_words;
+    result->words = NEW_VEC(uintptr_t, key->num_words);
+    memcpy(result->words, key->words, key->num_words * sizeof(*key->words));
+    result->specialization = specialization;
+
+    canonical_types.types[j] = result;
+    canonical_types.num_types++;
+
+    return result;
+}
+
+// Returns NULL if t (already advanced over typedefs) does not have a
+// canonical representative
+static canonical_type_t* type_get_canonical(type_t* t)
+{
+    if (t->_canonical_type != NULL)
+    {
+        return (t->_canonical_type == &not_canonical_type) ? NULL : t->_canonical_type;
+    }
+
+    // Avoid infinite recursion in case of cycles
+    t->_canonical_type = &not_canonical_type;
+
+    if (is_dependent_type(t))
+        return NULL;
+
+    canonical_key_t key;
+    key.num_words = 0;
+    key.capacity = STATIC_ARRAY_LENGTH(key.inline_words);
+    key.words = key.inline_words;
+
+    char is_specialization = 0;
+    canonical_type_t* result = NULL;
+    if (canonical_key_of_type(&key, t, &is_specialization))
+    {
+        result = canonical_types_get(&key, is_specialization ? t : NULL);
+        t->_canonical_type = result;
+    }
+
+    if (key.words != key.inline_words)
+        DELETE(key.words);
+
+    return result;
+}
+
+static char equivalent_types_structurally(type_t* t1, type_t* t2);
+
+uintptr_t type_get_canonical_id(type_t* t, cv_qualifier_t* cv_qualifier)
+{
+    cv_qualifier_t cv = CV_NONE;
+    t = advance_over_typedefs_with_cv_qualif(t, &cv);
+
+    if (cv_qualifier != NULL)
+        *cv_qualifier = cv;
+
+    if (IS_FORTRAN_LANGUAGE)
+        return 0;
+
+    return (uintptr_t)type_get_canonical(t);
+}
+
 extern inline char equivalent_types(type_t* t1, type_t* t2)
 {
     ERROR_CONDITION( (t1 == NULL || t2 == NULL), "No type can be null here", 0);
@@ -7080,6 +7931,29 @@ extern inline char equivalent_types(type_t* t1, type_t* t2)
         return 0;
     }
 
+    // Fortran symbols may change their types along the translation unit
+    if (!IS_FORTRAN_LANGUAGE)
+    {
+        canonical_type_t* canonical_t1 = type_get_canonical(t1);
+        if (canonical_t1 != NULL)
+        {
+            canonical_type_t* canonical_t2 = type_get_canonical(t2);
+            if (canonical_t2 != NULL)
+            {
+                return (canonical_t1 == canonical_t2)
+                    && equivalent_cv_qualification(cv_qualifier_t1, cv_qualifier_t2);
+            }
+        }
+    }
+
+    return equivalent_types_structurally(t1, t2)
+        && equivalent_cv_qualification(cv_qualifier_t1, cv_qualifier_t2);
+}
+
+// t1 and t2 have already been advanced over typedefs and they are of the same
+// kind. The top level cv-qualifier is not checked here
+static char equivalent_types_structurally(type_t* t1, type_t* t2)
+{
     char result = 0;
 
     switch (t1->kind)
@@ -7127,8 +8001,6 @@ extern inline char equivalent_types(type_t* t1, type_t* t2)
             internal_error("Unknown type kind (%d)\n", t1->kind);
     }
 
-    result &= equivalent_cv_qualification(cv_qualifier_t1, cv_qualifier_t2);
-
     return result;
 }
 
@@ -13956,10 +14828,10 @@ extern inline type_t* get_braced_list_type(int num_types, type_t** type_list)
         return _empty_braces_type;
     }
 
-    static type_trie_t* _braced_types_trie = NULL;
-    if (_braced_types_trie == NULL)
+    static type_seq_table_t* _braced_types_table = NULL;
+    if (_braced_types_table == NULL)
     {
-        _braced_types_trie = allocate_type_trie();
+        _braced_types_table = type_seq_table_new();
     }
 
     int i;
@@ -13970,7 +14842,9 @@ extern inline type_t* get_braced_list_type(int num_types, type_t** type_list)
         any_is_dependent = is_dependent_type(type_list[i]);
     }
 
-    type_t* result = (type_t*)lookup_type_trie(_braced_types_trie, (const type_t**)type_list, num_types);
+    type_t* result = (type_t*)type_seq_table_lookup(_braced_types_table,
+            type_seq_table_hash(0, (const type_t**)type_list, num_types),
+            /* qualifiers */ 0, (const type_t**)type_list, num_types);
 
     if (result == NULL)
     {
@@ -16234,10 +17108,10 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
         return _empty_sequence;
     }
 
-    static type_trie_t *_sequence_types_trie = NULL;
-    if (_sequence_types_trie == NULL)
+    static type_seq_table_t *_sequence_types_table = NULL;
+    if (_sequence_types_table == NULL)
     {
-        _sequence_types_trie = allocate_type_trie();
+        _sequence_types_table = type_seq_table_new();
     }
 
     char any_is_dependent = 0;
@@ -16249,7 +17123,9 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
         any_is_dependent = any_is_dependent || is_dependent_type(types[i]);
     }
 
-    type_t* result = (type_t*)lookup_type_trie(_sequence_types_trie, (const type_t**)types, num_types);
+    unsigned int hash = type_seq_table_hash(0, (const type_t**)types, num_types);
+    type_t* result = (type_t*)type_seq_table_lookup(_sequence_types_table,
+            hash, /* qualifiers */ 0, (const type_t**)types, num_types);
 
     if (result == NULL)
     {
@@ -16264,7 +17140,8 @@ extern inline type_t* get_sequence_of_types(int num_types, type_t** types)
 
         result->info->is_dependent = any_is_dependent;
 
-        insert_type_trie(_sequence_types_trie, (const type_t**)types, num_types, result);
+        type_seq_table_insert(_sequence_types_table,
+                hash, /* qualifiers */ 0, (const type_t**)types, num_types, result);
     }
 
     return result;
@@ -32,6 +32,8 @@
 
 #include "libmcxx-common.h"
 
+#include <stdint.h>
+
 #include "cxx-type-decls.h"
 #include "cxx-ast-decls.h"
 #include "cxx-scope-decls.h"
@@ -299,6 +301,10 @@ LIBMCXX_EXTERN type_t* fix_dependent_typenames_in_context(type_t* t, const decl_
 LIBMCXX_EXTERN char equivalent_types(type_t* t1, type_t* t2);
 LIBMCXX_EXTERN char equivalent_cv_qualification(cv_qualifier_t cv1, cv_qualifier_t cv2);
 
+// Identifier shared by all the types equivalent to t, ignoring its top-level
+// cv-qualifier (returned in cv_qualifier). It is 0 if t has no canonical type
+LIBMCXX_EXTERN uintptr_t type_get_canonical_id(type_t* t, cv_qualifier_t* cv_qualifier);
+
 // Compares two function types ignoring ref qualifiers
 LIBMCXX_EXTERN char equivalent_function_types_may_differ_ref_qualifier(
         type_t* ft1, type_t* ft2);
@@ -852,6 +858,7 @@ LIBMCXX_EXTERN void class_type_get_virtual_base_with_offset_num(type_t* t, int n
         _size_t* offset);
 
 LIBMCXX_EXTERN size_t get_type_t_size(void);
+LIBMCXX_EXTERN void template_specialization_index_stats(void);
 
 LIBMCXX_EXTERN const char* print_decl_type_str(type_t* t, const decl_context_t* decl_context, const char* name);
 LIBMCXX_EXTERN const char* print_type_str(type_t* t, const decl_context_t* decl_context);
@@ -40,11 +40,18 @@
 #include "cxx-utils.h"
 #include "cxx-driver-utils.h"
 
+typedef
+struct split_output_tag
+{
+    fortran_split_write_fn_t write_fn;
+    void* data;
+} split_output_t;
+
 static char check_for_comment(char* c);
 static char check_for_construct(char *c, char *prefix, int max_length);
 
-static void double_continuate(FILE* output, const char* c, int width, int* column);
-static void double_continuate_construct(FILE* output, 
+static void double_continuate(split_output_t* output, const char* c, int width, int* column);
+static void double_continuate_construct(split_output_t* output, 
         const char* prefix, 
         const char* c, int width, int* column);
 static char* read_whole_line(FILE* input);
@@ -68,131 +75,161 @@ extern int mf03lex(void);
 
 extern YYSTYPE mf03lval;
 
+static void output_str(split_output_t* output, const char* str)
+{
+    output->write_fn(str, strlen(str), output->data);
+}
+
+static void output_char(split_output_t* output, char c)
+{
+    output->write_fn(&c, 1, output->data);
+}
+
+static void write_to_file(const char* str, size_t length, void* data)
+{
+    FILE* output = (FILE*)data;
+    if (fwrite(str, length, 1, output) != 1)
+    {
+        fatal_error("error: while splitting file\n");
+    }
+}
+
 void fortran_split_lines(FILE* input, FILE* output, int width)
 {
     ERROR_CONDITION(width <= 0, "Invalid width = %d\n", width);
 
-	int length;
 	char* line;
 
 	while ((line = read_whole_line(input)) != NULL)
 	{
-		// We must remove trailing spaces before "\n" (if any)
-		// since we cannot continuate to an empty line
-		trim_right_line(line);
-
-		// Comments that will reach here are those created within the compiler 
-		// (e.g. TPL) because scanner always trims them
-        char prefix[33] = { 0 };
-        char is_construct = check_for_construct(line, prefix, 32);
-		char is_comment = check_for_comment(line);
-
-		length = strlen(line);
-		// Many times we will fall here by means of length <= width
-		if ((length <= width))
-		{
-			fputs(line, output);
-		}
-        else if (is_construct)
-        {
-            // Do not complicate ourselves, rely on a double continuation
-            int column = 1;
-            double_continuate_construct(output, prefix, line, width, &column);
-            fprintf(output, "\n");
-        }
-        else if (is_comment)
-        {
-			fputs(line, output);
-        }
-		else
-		{
-			int column, next_column;
-			char* position;
-			char* next_position;
+		fortran_split_line(line, width, write_to_file, output);
+		DELETE(line);
+	}
+}
+
+void fortran_split_line(char* line, int width,
+        fortran_split_write_fn_t write_fn, void* data)
+{
+    ERROR_CONDITION(width <= 0, "Invalid width = %d\n", width);
+
+    split_output_t split_output = { write_fn, data };
+    split_output_t* output = &split_output;
+
+	int length;
+
+	// We must remove trailing spaces before "\n" (if any)
+	// since we cannot continuate to an empty line
+	trim_right_line(line);
+
+	// Comments that will reach here are those created within the compiler 
+	// (e.g. TPL) because scanner always trims them
+    char prefix[33] = { 0 };
+    char is_construct = check_for_construct(line, prefix, 32);
+	char is_comment = check_for_comment(line);
+
+	length = strlen(line);
+	// Many times we will fall here by means of length <= width
+	if ((length <= width))
+	{
+		output->write_fn(line, length, output->data);
+	}
+    else if (is_construct)
+    {
+        // Do not complicate ourselves, rely on a double continuation
+        int column = 1;
+        double_continuate_construct(output, prefix, line, width, &column);
+        output_char(output, '\n');
+    }
+    else if (is_comment)
+    {
+		output->write_fn(line, length, output->data);
+    }
+	else
+	{
+		int column, next_column;
+		char* position;
+		char* next_position;
 
 #ifdef FORTRAN_NEW_SCANNER
-            mf03_prepare_string_for_scanning(line);
+        mf03_prepare_string_for_scanning(line);
 #else
-			YY_BUFFER_STATE scan_line = mf03_scan_string(line);
-			mf03_switch_to_buffer(scan_line);
+		YY_BUFFER_STATE scan_line = mf03_scan_string(line);
+		mf03_switch_to_buffer(scan_line);
 #endif
 
-			// Initialize stuff
-			column = 1;
-			position = line;
+		// Initialize stuff
+		column = 1;
+		position = line;
+
+		// Scan
+		int token = mf03lex();
+		while (token != EOS)
+		{
+			// Find the token as there can be spaces
+			// next_position has the first character of the token
+			next_position = strstr(position, mf03lval.token_atrib.token_text);
+
+			if (next_position == NULL)
+			{
+				fatal_error("Serious problem when splitting line. '%s' not found:\n\n %s", mf03lval.token_atrib.token_text, position);
+			}
+
+			// Next column has the column where the token will start
+			next_column = column + (next_position - position);
 
-			// Scan
-			int token = mf03lex();
-			while (token != EOS)
+
+			// Check if we have reached the last column or if spaces plus
+			// token will not fit in this line
+			if (column == width
+					|| (next_column + (int)strlen(mf03lval.token_atrib.token_text) >= width))
 			{
-				// Find the token as there can be spaces
-				// next_position has the first character of the token
-				next_position = strstr(position, mf03lval.token_atrib.token_text);
-
-				if (next_position == NULL)
-				{
-					fatal_error("Serious problem when splitting line. '%s' not found:\n\n %s", mf03lval.token_atrib.token_text, position);
-				}
-
-				// Next column has the column where the token will start
-				next_column = column + (next_position - position);
-
-
-				// Check if we have reached the last column or if spaces plus
-				// token will not fit in this line
-				if (column == width
-						|| (next_column + (int)strlen(mf03lval.token_atrib.token_text) >= width))
-				{
-					DEBUG_CODE() DEBUG_MESSAGE("Cutting at '%s'", mf03lval.token_atrib.token_text);
-					// Nothing fits here already
-                    fprintf(output, "&\n");
-                    column = 1;
-				}
-
-				// Write the blanks
-				char* c;
-				for (c = position; c < next_position; c++)
-				{
-					DEBUG_CODE() DEBUG_MESSAGE("%d - Blank - '%c'", column, *c);
-					fprintf(output, "%c", *c);
-					column++;
-				}
-
-				if ((column + (int)strlen(mf03lval.token_atrib.token_text)) >= width)
-				{
-					// We are very unlucky, the whole token still does not fit
-					// in this line !
-					double_continuate(output, mf03lval.token_atrib.token_text, width, &column);
-				}
-				else
-				{
-					// Write the token
-					DEBUG_CODE() DEBUG_MESSAGE("%d - Token '%s'", column, mf03lval.token_atrib.token_text);
-					fprintf(output, "%s", mf03lval.token_atrib.token_text);
-					column += strlen(mf03lval.token_atrib.token_text);
-				}
-
-				// Update state to be coherent before entering the next iteration
-				// column has been updated before
-				position = next_position + strlen(mf03lval.token_atrib.token_text);
-				token = mf03lex();
+				DEBUG_CODE() DEBUG_MESSAGE("Cutting at '%s'", mf03lval.token_atrib.token_text);
+				// Nothing fits here already
+                output_str(output, "&\n");
+                column = 1;
 			}
 
-			// The EOS
-			fprintf(output, "\n");
+			// Write the blanks
+			char* c;
+			for (c = position; c < next_position; c++)
+			{
+				DEBUG_CODE() DEBUG_MESSAGE("%d - Blank - '%c'", column, *c);
+				output_char(output, *c);
+				column++;
+			}
+
+			if ((column + (int)strlen(mf03lval.token_atrib.token_text)) >= width)
+			{
+				// We are very unlucky, the whole token still does not fit
+				// in this line !
+				double_continuate(output, mf03lval.token_atrib.token_text, width, &column);
+			}
+			else
+			{
+				// Write the token
+				DEBUG_CODE() DEBUG_MESSAGE("%d - Token '%s'", column, mf03lval.token_atrib.token_text);
+				output_str(output, mf03lval.token_atrib.token_text);
+				column += strlen(mf03lval.token_atrib.token_text);
+			}
+
+			// Update state to be coherent before entering the next iteration
+			// column has been updated before
+			position = next_position + strlen(mf03lval.token_atrib.token_text);
+			token = mf03lex();
+		}
+
+		// The EOS
+		output_char(output, '\n');
 
 #ifdef FORTRAN_NEW_SCANNER
-            // Do nothing
+        // Do nothing
 #else
-			mf03_delete_buffer(scan_line);
+		mf03_delete_buffer(scan_line);
 #endif
-		}
-		
-		DELETE(line);
 	}
 }
 
-static void double_continuate(FILE* output, const char* c, int width, int* column)
+static void double_continuate(split_output_t* output, const char* c, int width, int* column)
 {
 	// This is a naive but easy-to-reason-about-it implementation
 	// It refuses to reuse the last column for other than continuation,
@@ -204,17 +241,17 @@ static void double_continuate(FILE* output, const char* c, int width, int* colum
 		if ((*column == width) && (*c != '\n'))
 		{
 			// Double continue
-			fprintf(output, "&\n&");
+			output_str(output, "&\n&");
 			*column = 2;
 			DEBUG_CODE() DEBUG_MESSAGE("Cutting at '%c'", *c);
 		}
 		DEBUG_CODE() DEBUG_MESSAGE("%d - Letter - '%c'", *column, *c);
-		fprintf(output, "%c", *c);
+		output_char(output, *c);
 		(*column)++;
 	}
 }
 
-static void double_continuate_construct(FILE* output, 
+static void double_continuate_construct(split_output_t* output, 
         const char* prefix, 
         const char* c, int width, int* column)
 {
@@ -230,12 +267,13 @@ static void double_continuate_construct(FILE* output,
 		if ((*column == width) && (*c != '\n'))
 		{
 			// Double continue
-			fprintf(output, "&\n%s", prefix_start);
+			output_str(output, "&\n");
+			output_str(output, prefix_start);
 			*column = 1 + strlen(prefix_start);
 			DEBUG_CODE() DEBUG_MESSAGE("Cutting at '%c'", *c);
 		}
 		DEBUG_CODE() DEBUG_MESSAGE("%d - Letter - '%c'", *column, *c);
-		fprintf(output, "%c", *c);
+		output_char(output, *c);
 		(*column)++;
 	}
 }
@@ -37,6 +37,14 @@ MCXX_BEGIN_DECLS
 
 LIBMF03_EXTERN void fortran_split_lines(FILE* input, FILE* output, int width);
 
+typedef void (*fortran_split_write_fn_t)(const char* str, size_t length, void* data);
+
+// Splits a single line so it fits in width columns. line must end with a
+// newline unless it is the last line of the output and it is modified.
+// The result is passed to write_fn in one or more pieces
+LIBMF03_EXTERN void fortran_split_line(char* line, int width,
+        fortran_split_write_fn_t write_fn, void* data);
+
 MCXX_END_DECLS
 
 #endif
@@ -33,10 +33,16 @@
 
 #include <cstdio>
 #include <cstring>
+#include <cerrno>
 #include <vector>
 #include <set>
+#include <map>
+#include <string>
+#include <sys/time.h>
 #ifndef WIN32_BUILD
   #include <dlfcn.h>
+  #include <unistd.h>
+  #include <sys/resource.h>
 #else
   #include <windows.h>
 #endif
@@ -54,6 +60,268 @@
 
 namespace TL
 {
+    // Profiling of the compiler phases, enabled with --profile-phases
+    class PhaseProfiler
+    {
+        private:
+            struct Sample
+            {
+                double wall_us;
+                double cpu_us;
+                size_t allocated_bytes;
+                long max_rss_kb;
+                size_t nodes_created;
+                size_t nodes_freed;
+            };
+
+            struct Record
+            {
+                std::string phase;
+                std::string stage;
+                std::string filename;
+                double start_us;
+                Sample delta;
+                // Bytes written by codegen, zero for other stages
+                size_t output_bytes;
+            };
+
+            static std::vector<Record> records;
+
+            static Sample sample()
+            {
+                Sample result;
+
+                struct timeval tv;
+                gettimeofday(&tv, NULL);
+                result.wall_us = tv.tv_sec * 1e6 + tv.tv_usec;
+
+#ifndef WIN32_BUILD
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                result.cpu_us = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6
+                    + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+                result.max_rss_kb = usage.ru_maxrss;
+#else
+                result.cpu_us = 0;
+                result.max_rss_kb = 0;
+#endif
+
+                result.allocated_bytes = xmalloc_allocated_bytes;
+                result.nodes_created = ast_arena.num_nodes_allocated;
+                result.nodes_freed = ast_arena.num_nodes_released;
+
+                return result;
+            }
+
+            static std::string json_string(const std::string& str)
+            {
+                std::string result = "\"";
+                for (std::string::const_iterator it = str.begin(); it != str.end(); it++)
+                {
+                    unsigned char c = *it;
+                    if (c == '"' || c == '\\')
+                    {
+                        result += '\\';
+                        result += c;
+                    }
+                    else if (c < 0x20)
+                    {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        result += escaped;
+                    }
+                    else
+                    {
+                        result += c;
+                    }
+                }
+                result += "\"";
+                return result;
+            }
+
+            static void print_row(const char* phase, const char* stage, const Sample& s)
+            {
+                fprintf(stderr, "%-40s %-8s %10.3f %10.3f %12zu %10ld %10zu %10zu\n",
+                        phase, stage,
+                        s.wall_us / 1e6, s.cpu_us / 1e6,
+                        s.allocated_bytes, s.max_rss_kb,
+                        s.nodes_created, s.nodes_freed);
+            }
+
+            static void print_header()
+            {
+                fprintf(stderr, "%-40s %-8s %10s %10s %12s %10s %10s %10s\n",
+                        "Phase", "Stage", "Wall (s)", "CPU (s)", "Allocated",
+                        "RSS+ (KB)", "Created", "Freed");
+            }
+
+            static void print_table()
+            {
+                std::string current_filename;
+                bool first = true;
+                for (std::vector<Record>::iterator it = records.begin(); it != records.end(); it++)
+                {
+                    if (first || it->filename != current_filename)
+                    {
+                        fprintf(stderr, "\nProfile of compiler phases for file '%s'\n\n", it->filename.c_str());
+                        print_header();
+                        current_filename = it->filename;
+                        first = false;
+                    }
+                    print_row(it->phase.c_str(), it->stage.c_str(), it->delta);
+                    if (it->output_bytes > 0
+                            && it->delta.wall_us > 0)
+                    {
+                        fprintf(stderr, "%-40s %-8s %zu bytes written, %.3f MB/s\n",
+                                "", "",
+                                it->output_bytes,
+                                (it->output_bytes / (1024.0 * 1024.0)) / (it->delta.wall_us / 1e6));
+                    }
+                }
+
+                // Totals per phase along all the files, keeping the order of execution
+                std::vector<std::string> order;
+                std::map<std::string, Sample> totals;
+                std::set<std::string> filenames;
+                for (std::vector<Record>::iterator it = records.begin(); it != records.end(); it++)
+                {
+                    filenames.insert(it->filename);
+
+                    std::string key = it->phase + "\n" + it->stage;
+                    std::map<std::string, Sample>::iterator total = totals.find(key);
+                    if (total == totals.end())
+                    {
+                        order.push_back(key);
+                        totals[key] = it->delta;
+                        continue;
+                    }
+
+                    Sample& s = total->second;
+                    s.wall_us += it->delta.wall_us;
+                    s.cpu_us += it->delta.cpu_us;
+                    s.allocated_bytes += it->delta.allocated_bytes;
+                    s.max_rss_kb += it->delta.max_rss_kb;
+                    s.nodes_created += it->delta.nodes_created;
+                    s.nodes_freed += it->delta.nodes_freed;
+                }
+
+                if (filenames.size() > 1)
+                {
+                    fprintf(stderr, "\nProfile of compiler phases for all files\n\n");
+                    print_header();
+                    for (std::vector<std::string>::iterator it = order.begin(); it != order.end(); it++)
+                    {
+                        std::string::size_type separator = it->find('\n');
+                        print_row(it->substr(0, separator).c_str(),
+                                it->substr(separator + 1).c_str(),
+                                totals[*it]);
+                    }
+                }
+                fprintf(stderr, "\n");
+            }
+
+            static void write_trace(const char* trace_filename)
+            {
+                FILE* trace_file = fopen(trace_filename, "w");
+                if (trace_file == NULL)
+                {
+                    fprintf(stderr, "warning: could not open profile trace file '%s' (%s)\n",
+                            trace_filename, strerror(errno));
+                    return;
+                }
+
+#ifndef WIN32_BUILD
+                int pid = getpid();
+#else
+                int pid = 0;
+#endif
+
+                fprintf(trace_file, "{\"traceEvents\": [\n");
+                for (std::vector<Record>::iterator it = records.begin(); it != records.end(); it++)
+                {
+                    fprintf(trace_file,
+                            "  {\"name\": %s, \"cat\": %s, \"ph\": \"X\", \"ts\": %.0f, \"dur\": %.0f, "
+                            "\"pid\": %d, \"tid\": 0, \"args\": {\"file\": %s, \"cpu_us\": %.0f, "
+                            "\"allocated_bytes\": %zu, \"peak_rss_delta_kb\": %ld, "
+                            "\"nodes_created\": %zu, \"nodes_freed\": %zu, \"output_bytes\": %zu}}%s\n",
+                            json_string(it->phase).c_str(),
+                            json_string(it->stage).c_str(),
+                            it->start_us,
+                            it->delta.wall_us,
+                            pid,
+                            json_string(it->filename).c_str(),
+                            it->delta.cpu_us,
+                            it->delta.allocated_bytes,
+                            it->delta.max_rss_kb,
+                            it->delta.nodes_created,
+                            it->delta.nodes_freed,
+                            it->output_bytes,
+                            (it + 1 != records.end()) ? "," : "");
+                }
+                fprintf(trace_file, "],\n\"displayTimeUnit\": \"ms\"}\n");
+
+                fclose(trace_file);
+            }
+        public:
+            // Profiles the lifetime of this object if profiling is enabled
+            class Scope
+            {
+                private:
+                    bool _enabled;
+                    Record _record;
+                    Sample _start;
+                public:
+                    Scope(const std::string& phase, const char* stage, translation_unit_t* translation_unit)
+                        : _enabled(compilation_process.profile_phases)
+                    {
+                        if (!_enabled)
+                            return;
+
+                        _record.phase = phase;
+                        _record.stage = stage;
+                        _record.filename = translation_unit->input_filename;
+                        _record.output_bytes = 0;
+                        _start = sample();
+                        _record.start_us = _start.wall_us;
+                    }
+
+                    ~Scope()
+                    {
+                        if (!_enabled)
+                            return;
+
+                        Sample end = sample();
+                        _record.delta.wall_us = end.wall_us - _start.wall_us;
+                        _record.delta.cpu_us = end.cpu_us - _start.cpu_us;
+                        _record.delta.allocated_bytes = end.allocated_bytes - _start.allocated_bytes;
+                        _record.delta.max_rss_kb = end.max_rss_kb - _start.max_rss_kb;
+                        _record.delta.nodes_created = end.nodes_created - _start.nodes_created;
+                        _record.delta.nodes_freed = end.nodes_freed - _start.nodes_freed;
+
+                        records.push_back(_record);
+                    }
+
+                    bool enabled() const { return _enabled; }
+
+                    void set_output_bytes(size_t n) { _record.output_bytes = n; }
+            };
+
+            static void report(const char* trace_filename)
+            {
+                if (records.empty())
+                    return;
+
+                print_table();
+
+                if (trace_filename != NULL)
+                {
+                    write_trace(trace_filename);
+                }
+            }
+    };
+
+    std::vector<PhaseProfiler::Record> PhaseProfiler::records;
+
     class CompilerPhaseRunner
     {
         private:
@@ -103,7 +371,10 @@ namespace TL
                         fprintf(stderr, "COMPILERPHASES: Execution of pre_run of phase '%s'\n", phase->get_phase_name().c_str());
                     }
 
-                    phase->pre_run(dto);
+                    {
+                        PhaseProfiler::Scope profile(phase->get_phase_name(), "pre_run", translation_unit);
+                        phase->pre_run(dto);
+                    }
 
                     if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
                     {
@@ -176,7 +447,10 @@ namespace TL
                         fprintf(stderr, "COMPILERPHASES: Running phase '%s'\n", phase->get_phase_name().c_str());
                     }
 
-                    phase->run(dto);
+                    {
+                        PhaseProfiler::Scope profile(phase->get_phase_name(), "run", translation_unit);
+                        phase->run(dto);
+                    }
 
                     if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
                     {
@@ -629,6 +903,34 @@ extern "C"
 
 	// This function will change the DTO adding an abstract information that will contain
 	// I'm waiting something like 'variable:type:text'
+    const char* compiler_phase_get_library_path(const char* library_name)
+    {
+#ifndef WIN32_BUILD
+        library_name = add_dso_extension(library_name);
+
+        // Open it like load_compiler_phases_cxx_unix does, so the same file
+        // is found. It is going to be loaded anyway, so keep it loaded
+        void* handle = dlopen(library_name, RTLD_NOW | RTLD_GLOBAL);
+        if (handle == NULL)
+            return NULL;
+
+        TL::CompilerPhaseRunner::lib_handle_list.insert(handle);
+
+        const char* result = NULL;
+        void* factory_function_sym = dlsym(handle, "give_compiler_phase_object");
+        Dl_info info;
+        if (factory_function_sym != NULL
+                && dladdr(factory_function_sym, &info) != 0
+                && info.dli_fname != NULL)
+        {
+            result = uniquestr(info.dli_fname);
+        }
+        return result;
+#else
+        return NULL;
+#endif
+    }
+
     void compiler_special_phase_set_dto(compilation_configuration_t* config, const char* data)
     {
         TL::SetDTOCompilerPhase* new_phase = new TL::SetDTOCompilerPhase();
@@ -715,7 +1017,7 @@ extern "C"
     }
 
     void run_codegen_phase(FILE *out_file, translation_unit_t* translation_unit,
-            const char* output_filename)
+            const char* output_filename, int output_column_width)
     {
         TL::DTO* _dto = reinterpret_cast<TL::DTO*>(translation_unit->dto);
         TL::DTO& dto = *_dto;
@@ -728,7 +1030,28 @@ extern "C"
         std::shared_ptr<TL::String> output_filename_p(new TL::String(output_filename));
         dto.set_object("output_filename", output_filename_p);
 
+        std::shared_ptr<TL::Integer> output_column_width_p(new TL::Integer(output_column_width));
+        dto.set_object("output_column_width", output_column_width_p);
+
+        TL::PhaseProfiler::Scope profile(codegen_phase->get_phase_name(), "codegen", translation_unit);
+
+        // Measure the codegen throughput, unless the output is not seekable
+        long start_offset = -1;
+        if (profile.enabled())
+        {
+            fflush(out_file);
+            start_offset = ftell(out_file);
+        }
+
         codegen_phase->run(dto);
+
+        if (start_offset >= 0)
+        {
+            fflush(out_file);
+            long end_offset = ftell(out_file);
+            if (end_offset > start_offset)
+                profile.set_output_bytes(end_offset - start_offset);
+        }
     }
 
     const char* codegen_to_str(nodecl_t node, const decl_context_t* decl_context)
@@ -745,6 +1068,11 @@ extern "C"
         return uniquestr(str.c_str());
     }
 
+    void compiler_phases_profile_report(const char* trace_filename)
+    {
+        TL::PhaseProfiler::report(trace_filename);
+    }
+
     void unload_compiler_phases(void)
     {
         TL::CompilerPhaseRunner::unload_compiler_phases();
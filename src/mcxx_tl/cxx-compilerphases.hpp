@@ -54,13 +54,23 @@ LIBMCXXTL_EXTERN void start_compiler_phase_execution(compilation_configuration_t
 LIBMCXXTL_EXTERN void phases_help(compilation_configuration_t* config);
 LIBMCXXTL_EXTERN void unload_compiler_phases(void);
 
+// Prints the profile of the phases run so far (see --profile-phases) and
+// writes it in trace_filename, if not NULL
+LIBMCXXTL_EXTERN void compiler_phases_profile_report(const char* trace_filename);
+
 LIBMCXXTL_EXTERN void compiler_regular_phase_loader(compilation_configuration_t* config, const char* data);
 LIBMCXXTL_EXTERN void compiler_special_phase_set_dto(compilation_configuration_t* config, const char* data);
 LIBMCXXTL_EXTERN void compiler_special_phase_set_codegen(compilation_configuration_t* config, const char* data);
 
+// The file of the compiler phase library_name, as it is found when loading
+// it, or NULL if it cannot be loaded
+LIBMCXXTL_EXTERN const char* compiler_phase_get_library_path(const char* library_name);
+
+// If output_column_width is not zero, Fortran lines longer than it are split
 LIBMCXXTL_EXTERN void run_codegen_phase(FILE *out_file,
         translation_unit_t* translation_unit,
-        const char* output_filename);
+        const char* output_filename,
+        int output_column_width);
 
 LIBMCXXTL_EXTERN void initialize_dto(translation_unit_t* translation_unit);
 
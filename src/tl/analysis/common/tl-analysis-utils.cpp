@@ -239,10 +239,8 @@ namespace Utils {
     
     bool nodecl_set_contains_nodecl(const NBase& nodecl, const NodeclSet& set)
     {
-        for(NodeclSet::const_iterator it = set.begin(); it != set.end(); ++it)
-            if(Nodecl::Utils::structurally_equal_nodecls(nodecl, *it, /*skip_conversions*/true))
-                return true;
-        return false;
+        // The comparator of NodeclSet skips conversions too
+        return set.find(nodecl) != set.end();
     }
     
     bool nodecl_set_contains_nodecl_pointer(const NBase& nodecl, const NodeclSet& set)
@@ -0,0 +1,223 @@
+/*--------------------------------------------------------------------
+ ( C) Copyright 2006-2015 Barcelona Supercomputing Center             *
+ Centro Nacional de Supercomputacion
+
+ This file is part of Mercurium C/C++ source-to-source compiler.
+
+ See AUTHORS file in the top level directory for information
+ regarding developers and contributors.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Mercurium C/C++ source-to-source compiler is distributed in the hope
+ that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the GNU Lesser General Public License for more
+ details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Mercurium C/C++ source-to-source compiler; if
+ not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+ Cambridge, MA 02139, USA.
+ --------------------------------------------------------------------*/
+
+#include "tl-dataflow-sets.hpp"
+
+namespace TL {
+namespace Analysis {
+
+    // **************************************************************************************************** //
+    // ******************************** Bit-vectors for data-flow analyses ******************************** //
+
+    const unsigned int BitVector::npos;
+
+    BitVector::BitVector()
+        : _words()
+    {}
+
+    void BitVector::trim()
+    {
+        while (!_words.empty() && _words.back() == 0)
+            _words.pop_back();
+    }
+
+    bool BitVector::test(unsigned int i) const
+    {
+        unsigned int w = i / WORD_BITS;
+        if (w >= _words.size())
+            return false;
+        return (_words[w] >> (i % WORD_BITS)) & 1;
+    }
+
+    void BitVector::set(unsigned int i)
+    {
+        unsigned int w = i / WORD_BITS;
+        if (w >= _words.size())
+            _words.resize(w + 1, 0);
+        _words[w] |= (word_t)1 << (i % WORD_BITS);
+    }
+
+    void BitVector::reset(unsigned int i)
+    {
+        unsigned int w = i / WORD_BITS;
+        if (w >= _words.size())
+            return;
+        _words[w] &= ~((word_t)1 << (i % WORD_BITS));
+        trim();
+    }
+
+    bool BitVector::empty() const
+    {
+        // Vectors are always trimmed
+        return _words.empty();
+    }
+
+    unsigned int BitVector::count() const
+    {
+        unsigned int result = 0;
+        for (std::vector<word_t>::const_iterator it = _words.begin(); it != _words.end(); ++it)
+            result += __builtin_popcountl(*it);
+        return result;
+    }
+
+    void BitVector::clear()
+    {
+        _words.clear();
+    }
+
+    unsigned int BitVector::find_next(unsigned int i) const
+    {
+        unsigned int w = i / WORD_BITS;
+        if (w >= _words.size())
+            return npos;
+
+        word_t current = _words[w] & (~(word_t)0 << (i % WORD_BITS));
+        while (current == 0)
+        {
+            w++;
+            if (w == _words.size())
+                return npos;
+            current = _words[w];
+        }
+        return w * WORD_BITS + __builtin_ctzl(current);
+    }
+
+    bool BitVector::union_with(const BitVector& b)
+    {
+        if (_words.size() < b._words.size())
+            _words.resize(b._words.size(), 0);
+
+        bool changed = false;
+        for (unsigned int i = 0; i < b._words.size(); ++i)
+        {
+            word_t w = _words[i] | b._words[i];
+            if (w != _words[i])
+            {
+                _words[i] = w;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool BitVector::difference_with(const BitVector& b)
+    {
+        bool changed = false;
+        unsigned int n = std::min(_words.size(), b._words.size());
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            word_t w = _words[i] & ~b._words[i];
+            if (w != _words[i])
+            {
+                _words[i] = w;
+                changed = true;
+            }
+        }
+        trim();
+        return changed;
+    }
+
+    bool BitVector::intersection_with(const BitVector& b)
+    {
+        bool changed = false;
+        if (_words.size() > b._words.size())
+        {
+            _words.resize(b._words.size());
+            changed = true;
+        }
+        for (unsigned int i = 0; i < _words.size(); ++i)
+        {
+            word_t w = _words[i] & b._words[i];
+            if (w != _words[i])
+            {
+                _words[i] = w;
+                changed = true;
+            }
+        }
+        trim();
+        return changed;
+    }
+
+    bool BitVector::operator==(const BitVector& b) const
+    {
+        return _words == b._words;
+    }
+
+    bool BitVector::operator!=(const BitVector& b) const
+    {
+        return _words != b._words;
+    }
+
+    NodeclUniverse::NodeclUniverse()
+        : _index(), _elements()
+    {}
+
+    unsigned int NodeclUniverse::get_index(const NBase& n)
+    {
+        std::pair<IndexMap::iterator, bool> it = _index.insert(std::make_pair(n, (unsigned int)_elements.size()));
+        if (it.second)
+            _elements.push_back(n);
+        return it.first->second;
+    }
+
+    unsigned int NodeclUniverse::find_index(const NBase& n) const
+    {
+        IndexMap::const_iterator it = _index.find(n);
+        return (it == _index.end()) ? BitVector::npos : it->second;
+    }
+
+    const NBase& NodeclUniverse::get_element(unsigned int i) const
+    {
+        ERROR_CONDITION(i >= _elements.size(), "Element %d has not been numbered", i);
+        return _elements[i];
+    }
+
+    unsigned int NodeclUniverse::size() const
+    {
+        return _elements.size();
+    }
+
+    BitVector NodeclUniverse::to_bit_vector(const NodeclSet& s)
+    {
+        BitVector result;
+        for (NodeclSet::const_iterator it = s.begin(); it != s.end(); ++it)
+            result.set(get_index(*it));
+        return result;
+    }
+
+    NodeclSet NodeclUniverse::to_nodecl_set(const BitVector& b) const
+    {
+        NodeclSet result;
+        for (unsigned int i = b.find_next(0); i != BitVector::npos; i = b.find_next(i + 1))
+            result.insert(_elements[i]);
+        return result;
+    }
+
+    // ****************************** END bit-vectors for data-flow analyses ****************************** //
+    // **************************************************************************************************** //
+
+}
+}
@@ -0,0 +1,116 @@
+/*--------------------------------------------------------------------
+ ( C) Copyright 2006-2015 Barcelona Supercomputing Center             *
+ Centro Nacional de Supercomputacion
+
+ This file is part of Mercurium C/C++ source-to-source compiler.
+
+ See AUTHORS file in the top level directory for information
+ regarding developers and contributors.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3 of the License, or (at your option) any later version.
+
+ Mercurium C/C++ source-to-source compiler is distributed in the hope
+ that it will be useful, but WITHOUT ANY WARRANTY; without even the
+ implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the GNU Lesser General Public License for more
+ details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with Mercurium C/C++ source-to-source compiler; if
+ not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+ Cambridge, MA 02139, USA.
+ --------------------------------------------------------------------*/
+
+#ifndef TL_DATAFLOW_SETS_HPP
+#define TL_DATAFLOW_SETS_HPP
+
+#include "tl-analysis-utils.hpp"
+
+#include <vector>
+#include <tr1/unordered_map>
+
+namespace TL {
+namespace Analysis {
+
+    // **************************************************************************************************** //
+    // ******************************** Bit-vectors for data-flow analyses ******************************** //
+
+    //! Set of small integers represented as a bit-vector
+    /*!
+     * The vector only grows up to its highest element, so sets of the few last numbered
+     * elements are as cheap as dense ones and sets of the first elements stay short.
+     */
+    class LIBTL_CLASS BitVector
+    {
+    private:
+        typedef unsigned long word_t;
+        enum { WORD_BITS = sizeof(word_t) * 8 };
+
+        std::vector<word_t> _words;
+
+        void trim();
+
+    public:
+        static const unsigned int npos = ~0U;
+
+        BitVector();
+
+        bool test(unsigned int i) const;
+        void set(unsigned int i);
+        void reset(unsigned int i);
+
+        bool empty() const;
+        unsigned int count() const;
+        void clear();
+
+        //! Returns the first element greater or equal than \i, or npos
+        unsigned int find_next(unsigned int i) const;
+
+        //! These return whether this set has changed
+        bool union_with(const BitVector& b);
+        bool difference_with(const BitVector& b);
+        bool intersection_with(const BitVector& b);
+
+        bool operator==(const BitVector& b) const;
+        bool operator!=(const BitVector& b) const;
+    };
+
+    //! Numbers nodecls so sets of them can be represented as bit-vectors
+    /*!
+     * Elements are numbered with the same equivalence used by NodeclSet, so converting
+     * a NodeclSet to a BitVector and back gives an equivalent set.
+     * The first nodecl numbered is the one returned for its number.
+     */
+    class LIBTL_CLASS NodeclUniverse
+    {
+    private:
+        typedef std::tr1::unordered_map<NBase, unsigned int, Nodecl::Utils::Nodecl_structural_hash,
+                                        Nodecl::Utils::Nodecl_structural_equal_skip_conv> IndexMap;
+        IndexMap _index;
+        std::vector<NBase> _elements;
+
+    public:
+        NodeclUniverse();
+
+        //! Returns the number of \n, numbering it if needed
+        unsigned int get_index(const NBase& n);
+        //! Returns the number of \n, or BitVector::npos if it has not been numbered
+        unsigned int find_index(const NBase& n) const;
+
+        const NBase& get_element(unsigned int i) const;
+        unsigned int size() const;
+
+        BitVector to_bit_vector(const NodeclSet& s);
+        NodeclSet to_nodecl_set(const BitVector& b) const;
+    };
+
+    // ****************************** END bit-vectors for data-flow analyses ****************************** //
+    // **************************************************************************************************** //
+
+}
+}
+
+#endif      // TL_DATAFLOW_SETS_HPP
@@ -36,7 +36,8 @@ namespace Analysis {
     // ******************************* Class implementing liveness analysis ******************************* //
 
     Liveness::Liveness(ExtensibleGraph* graph, bool propagate_graph_nodes)
-        : _graph(graph), _propagate_graph_nodes(propagate_graph_nodes)
+        : WorklistSolver(graph, /*backwards*/ true),
+          _graph(graph), _propagate_graph_nodes(propagate_graph_nodes), _vars(), _live_sets()
     {}
 
     void Liveness::compute_liveness()
@@ -63,17 +64,71 @@ namespace Analysis {
         graph->set_visited(false);
 
         // Common Liveness analysis
-        bool changed = true;
-        while(changed)
+        solve();
+        if (ANALYSIS_PERFORMANCE_MEASURE)
+            fprintf(stderr, "ANALYSIS: LIVENESS of '%s': %u nodes, %u evaluations\n",
+                    _graph->get_name().c_str(), get_num_nodes(), get_num_evaluations());
+
+        commit_live_sets();
+    }
+
+    Liveness::LiveSets& Liveness::get_live_sets(Node* n)
+    {
+        add_dependency(n);
+
+        LiveSetsMap::iterator it = _live_sets.find(n);
+        if (it != _live_sets.end())
+            return it->second;
+
+        LiveSets& sets = _live_sets[n];
+        sets._ue = _vars.to_bit_vector(n->get_ue_vars());
+        sets._killed = _vars.to_bit_vector(n->get_killed_vars());
+        sets._live_in = _vars.to_bit_vector(n->get_live_in_vars());
+        sets._live_out = _vars.to_bit_vector(n->get_live_out_vars());
+        return sets;
+    }
+
+    void Liveness::commit_live_sets()
+    {
+        for (LiveSetsMap::iterator it = _live_sets.begin(); it != _live_sets.end(); ++it)
         {
-            changed = false;
-            solve_live_equations_rec(graph, changed);
-            if (post_sync != NULL)
-                solve_live_equations_rec(post_sync, changed);
-            ExtensibleGraph::clear_visits_backwards_in_level(exit, graph);
-            if (post_sync != NULL)
-                ExtensibleGraph::clear_visits_backwards_in_level(post_sync, graph);
-            graph->set_visited(false);
+            if (!it->second._modified)
+                continue;
+            it->first->set_live_in(_vars.to_nodecl_set(it->second._live_in));
+            it->first->set_live_out(_vars.to_nodecl_set(it->second._live_out));
+        }
+        _live_sets.clear();
+    }
+
+    void Liveness::filter_inner_vars(Node* n, BitVector& live_in)
+    {
+        if (n->is_context_node())
+        {   // Variables declared within the current context
+            LiveSets& sets = get_live_sets(n);
+            Scope sc(n->get_graph_related_ast().retrieve_context());
+            for (unsigned int i = live_in.find_next(0); i != BitVector::npos; i = live_in.find_next(i + 1))
+            {
+                if (sets._checked_context.test(i))
+                    continue;
+                sets._checked_context.set(i);
+                const NBase& it_base = Utils::get_nodecl_base(_vars.get_element(i));
+                if (!it_base.retrieve_context().scope_is_enclosed_by(sc))
+                    sets._outer_context.set(i);
+            }
+            live_in.intersection_with(sets._outer_context);
+        }
+        // FIXME We should include here any OpenMP|OmpSs node that may have private variables
+        else if (n->is_omp_task_node()
+                || n->is_omp_async_target_node()
+                || n->is_omp_sync_target_node())
+        {   // Variables private to the task
+            LiveSets& sets = get_live_sets(n);
+            if (!sets._private_computed)
+            {
+                sets._private = _vars.to_bit_vector(n->get_private_vars());
+                sets._private_computed = true;
+            }
+            live_in.difference_with(sets._private);
         }
     }
 
@@ -95,7 +150,9 @@ namespace Analysis {
         }
         else if (!n->is_exit_node())
         {
-            n->set_live_in(n->get_ue_vars());
+            LiveSets& sets = get_live_sets(n);
+            sets._live_in = sets._ue;
+            sets._modified = true;
         }
 
         const ObjectList<Node*>& parents = n->get_parents();
@@ -103,75 +160,63 @@ namespace Analysis {
             initialize_live_sets(*it);
     }
 
-    void Liveness::solve_live_equations_rec(Node* n, bool& changed)
+    Node* Liveness::get_task_of_exit_flush(Node* n)
     {
-        if (n->is_visited())
-            return;
-
-        n->set_visited(true);
-
-        if (n->is_entry_node())
-            return;
-
-        if (n->is_graph_node())
-        {
-            Node* exit = n->get_graph_exit_node();
-            if (n->is_omp_task_node()
-                || n->is_omp_async_target_node())
-                solve_task_live_equations_rec(exit, changed, n);
-            else
-                solve_live_equations_rec(exit, changed);
-            if (_propagate_graph_nodes)
-                set_graph_node_liveness(n);
-        }
-        else if (!n->is_exit_node())
+        const ObjectList<Node*>& children = n->get_children();
+        for (ObjectList<Node*>::const_iterator it = children.begin(); it != children.end(); ++it)
         {
-            // 1.- Gather old liveness sets
-            const NodeclSet& old_live_out = n->get_live_out_vars();
-            const NodeclSet& old_live_in = n->get_live_in_vars();
-
-            // 2.- Compute new liveness sets
-            // 2.1.- Compute Live Out: LO(x) = U LI(y), forall y ∈ Succ(x)
-            const NodeclSet& live_out = compute_successors_live_in(n);
-            // 2.2.-Compute Live In: LI(x) = UE(x) U ( LO(x) - KILL(x) )
-            const NodeclSet& live_in = Utils::nodecl_set_union(n->get_ue_vars(),
-                    Utils::nodecl_set_difference(live_out, n->get_killed_vars()));
-
-            // 3.- Compare the two sets to see whether something has changed and, if yes, set the new values
-            if (!Utils::nodecl_set_equivalence(old_live_in, live_in)
-                    || !Utils::nodecl_set_equivalence(old_live_out, live_out))
+            if (!(*it)->is_exit_node())
+                continue;
+            Node* task = (*it)->get_outer_node();
+            if (task->is_omp_task_node()
+                || task->is_omp_async_target_node())
             {
-                n->set_live_in(live_in);
-                n->set_live_out(live_out);
-                changed = true;
+                ERROR_CONDITION((*it)->get_parents().size()!=1,
+                                "The number of parents of a task exit node must be 1 (a flush node), but %d found.\n",
+                                (*it)->get_parents().size());
+                return task;
             }
         }
-
-        const ObjectList<Node*>& parents = n->get_parents();
-        for (ObjectList<Node*>::const_iterator it = parents.begin(); it != parents.end(); ++it)
-            solve_live_equations_rec(*it, changed);
+        return NULL;
     }
 
-    void Liveness::solve_task_live_equations_rec(Node* n, bool& changed, Node* task)
+    bool Liveness::evaluate(Node* n)
     {
-        if (!n->is_exit_node())
-            return;
+        if (n->is_entry_node() || n->is_exit_node())
+            return false;
 
-        n->set_visited(true);
+        if (n->is_graph_node())
+            return _propagate_graph_nodes && set_graph_node_liveness(n);
+
+        Node* task = get_task_of_exit_flush(n);
+        if (task != NULL)
+            return solve_task_live_equations(n, task);
+
+        // 1.- Compute Live Out: LO(x) = U LI(y), forall y ∈ Succ(x)
+        BitVector live_out = compute_successors_live_in(n);
+        LiveSets& sets = get_live_sets(n);
+        // 2.- Compute Live In: LI(x) = UE(x) U ( LO(x) - KILL(x) )
+        BitVector live_in = live_out;
+        live_in.difference_with(sets._killed);
+        live_in.union_with(sets._ue);
+
+        // 3.- Compare with the old sets to see whether something has changed and, if yes, set the new values
+        if (live_in == sets._live_in && live_out == sets._live_out)
+            return false;
+
+        sets._live_in = live_in;
+        sets._live_out = live_out;
+        sets._modified = true;
+        return true;
+    }
 
+    bool Liveness::solve_task_live_equations(Node* exit_flush, Node* task)
+    {
         // 1.- Compute the task successors LI set
-        const ObjectList<Node*>& parents = n->get_parents();
-        ERROR_CONDITION(parents.size()!=1,
-                        "The number of parents of a task exit node must be 1 (a flush node), but %d found.\n",
-                        parents.size());
-        Node* exit_flush = parents[0];
-        NodeclSet succ_live_in = compute_successors_live_in(exit_flush);
+        BitVector succ_live_in = compute_successors_live_in(exit_flush);
         // 1.2.- If the task has a post_sync successor, then all shared variables must be alive at the exit of the task
         if (ExtensibleGraph::task_synchronizes_in_post_sync(task))
-        {
-            const NodeclSet& shared_accesses = task->get_all_shared_accesses();
-            succ_live_in.insert(shared_accesses.begin(), shared_accesses.end());
-        }
+            succ_live_in.union_with(_vars.to_bit_vector(task->get_all_shared_accesses()));
 
         // 2.- Add to the list of successors, the flow successors of the Task Creation node of the current task
         Node* task_creation = ExtensibleGraph::get_task_creation_from_task(task);
@@ -179,41 +224,26 @@ namespace Analysis {
         for (ObjectList<Node*>::const_iterator it = tc_children.begin(); it != tc_children.end(); ++it)
         {
             if (*it != task)
-            {
-                const NodeclSet& li = (*it)->get_live_in_vars();
-                succ_live_in.insert(li.begin(), li.end());
-            }
+                succ_live_in.union_with(get_live_sets(*it)._live_in);
         }
 
         // 3.- Remove from the set of successors LI those variables private to the task
-        const NodeclSet& private_vars = task->get_all_private_vars();
-        for (NodeclSet::const_iterator it = private_vars.begin(); it != private_vars.end(); ++it)
-            if (Utils::nodecl_set_contains_nodecl(*it, succ_live_in))
-                succ_live_in.erase(*it);
-
-        // 4.- Gather the old liveness sets
-        const NodeclSet& old_live_out = exit_flush->get_live_out_vars();
-        const NodeclSet& old_live_in = exit_flush->get_live_in_vars();
-
-        // 5.- Compare the two sets to see whether something has changed and, if yes, set the new values
-        if (!Utils::nodecl_set_equivalence(old_live_in, succ_live_in)
-                || !Utils::nodecl_set_equivalence(old_live_out, succ_live_in))
-        {
-            exit_flush->set_live_out(succ_live_in);
-            exit_flush->set_live_in(succ_live_in);
-            changed = true;
-        }
+        succ_live_in.difference_with(_vars.to_bit_vector(task->get_all_private_vars()));
+
+        // 4.- Compare with the old sets to see whether something has changed and, if yes, set the new values
+        LiveSets& sets = get_live_sets(exit_flush);
+        if (succ_live_in == sets._live_in && succ_live_in == sets._live_out)
+            return false;
 
-        // 6.- Keep iterating normally within the task
-        exit_flush->set_visited(true);
-        const ObjectList<Node*>& flush_parents = exit_flush->get_parents();
-        for (ObjectList<Node*>::const_iterator it = flush_parents.begin(); it != flush_parents.end(); ++it)
-            solve_live_equations_rec(*it, changed);
+        sets._live_out = succ_live_in;
+        sets._live_in = succ_live_in;
+        sets._modified = true;
+        return true;
     }
 
-    NodeclSet Liveness::compute_successors_live_in(Node* n)
+    BitVector Liveness::compute_successors_live_in(Node* n)
     {
-        NodeclSet succ_live_in;
+        BitVector succ_live_in;
         const ObjectList<Node*>& children = n->get_children();
         for (ObjectList<Node*>::const_iterator it = children.begin(); it != children.end(); ++it)
         {
@@ -232,113 +262,60 @@ namespace Analysis {
                 }
                 // Get the Live in of the current successors
                 for (ObjectList<Node*>::iterator itoc = outer_children.begin(); itoc != outer_children.end(); ++itoc)
-                {
-                    const NodeclSet& outer_live_in = (*itoc)->get_live_in_vars();
-                    succ_live_in.insert(outer_live_in.begin(), outer_live_in.end());
-                }
+                    succ_live_in.union_with(get_live_sets(*itoc)._live_in);
             }
             else
             {
                 if (!_propagate_graph_nodes && c->is_graph_node())
                 {   // Gather the LiveIn variables of the graph
                     // 1.- Compute all LiveIn variables: LI(graph) = U LI(inner entries)
-                    NodeclSet all_live_in;
+                    BitVector all_live_in;
                     const ObjectList<Node*>& grandchildren = c->get_graph_entry_node()->get_children();
                     for (ObjectList<Node*>::const_iterator itt = grandchildren.begin();
                          itt != grandchildren.end(); ++itt)
                     {
-                        const NodeclSet& li = (*itt)->get_live_in_vars();
-                        all_live_in.insert(li.begin(), li.end());
+                        all_live_in.union_with(get_live_sets(*itt)._live_in);
                     }
                     // 2.- Delete those variables which are local to the graph
-                    if (c->is_context_node())
-                    {   // Variables declared within the current context
-                        Scope sc(c->get_graph_related_ast().retrieve_context());
-                        for (NodeclSet::iterator itt = all_live_in.begin(); itt != all_live_in.end(); ++itt)
-                        {
-                            const NBase& it_base = Utils::get_nodecl_base(*itt);
-                            if (!it_base.retrieve_context().scope_is_enclosed_by(sc))
-                                succ_live_in.insert(*itt);
-                        }
-                    }
-                    // FIXME We should include here any OpenMP|OmpSs node that may have private variables
-                    else if (c->is_omp_task_node()
-                            || c->is_omp_async_target_node()
-                            || c->is_omp_sync_target_node())
-                    {   // Variables private to the task
-                        const NodeclSet& p_vars = c->get_private_vars();
-                        for (NodeclSet::iterator itt = all_live_in.begin(); itt != all_live_in.end(); ++itt)
-                        {
-                            if (p_vars.find(*itt) == p_vars.end())
-                                succ_live_in.insert(*itt);
-                        }
-                    }
-                    else
-                    {
-                        succ_live_in.insert(all_live_in.begin(), all_live_in.end());
-                    }
+                    filter_inner_vars(c, all_live_in);
+                    succ_live_in.union_with(all_live_in);
                 }
                 else
                 {
-                    const NodeclSet& li = c->get_live_in_vars();
-                    succ_live_in.insert(li.begin(), li.end());
+                    succ_live_in.union_with(get_live_sets(c)._live_in);
                 }
             }
         }
         return succ_live_in;
     }
 
-    void Liveness::set_graph_node_liveness(Node* n)
+    bool Liveness::set_graph_node_liveness(Node* n)
     {
         if (!n->is_graph_node())
-            return;
+            return false;
 
         // 1.- LO(graph) = U L0(inner exits)
-        NodeclSet live_out;
+        BitVector live_out;
         const ObjectList<Node*>& parents = n->get_graph_exit_node()->get_parents();
         for (ObjectList<Node*>::const_iterator it = parents.begin(); it != parents.end(); ++it)
-        {
-            const NodeclSet& lo = (*it)->get_live_out_vars();
-            live_out.insert(lo.begin(), lo.end());
-        }
-        n->set_live_out(live_out);
+            live_out.union_with(get_live_sets(*it)._live_out);
 
         // 2.- LI(graph) = U LI(inner entries)
-        NodeclSet all_live_in;
+        BitVector live_in;
         const ObjectList<Node*>& children = n->get_graph_entry_node()->get_children();
         for (ObjectList<Node*>::const_iterator it = children.begin(); it != children.end(); ++it)
-        {
-            const NodeclSet& li = (*it)->get_live_in_vars();
-            all_live_in.insert(li.begin(), li.end());
-        }
+            live_in.union_with(get_live_sets(*it)._live_in);
         // 2.1.- Delete those variables which are local to the graph
-        NodeclSet live_in;
-        if (n->is_context_node())
-        {   // Variables declared within the current context
-            Scope sc(n->get_graph_related_ast().retrieve_context());
-            for(NodeclSet::iterator it = all_live_in.begin(); it != all_live_in.end(); ++it)
-            {
-                const NBase& it_base = Utils::get_nodecl_base(*it);
-                if (!it_base.retrieve_context().scope_is_enclosed_by(sc))
-                    live_in.insert(*it);
-            }
-        }
-        else if (n->is_omp_task_node()
-                || n->is_omp_async_target_node()
-                || n->is_omp_sync_target_node())
-        {   // Variables private to the task
-            NodeclSet p_vars = n->get_private_vars();
-            for (NodeclSet::iterator it = all_live_in.begin(); it != all_live_in.end(); ++it)
-            {
-                if (p_vars.find(*it) == p_vars.end())
-                    live_in.insert(*it);
-            }
-        }
-        else
-        {
-            live_in = all_live_in;
-        }
-        n->set_live_in(live_in);
+        filter_inner_vars(n, live_in);
+
+        LiveSets& sets = get_live_sets(n);
+        sets._modified = true;
+        if (live_in == sets._live_in && live_out == sets._live_out)
+            return false;
+
+        sets._live_out = live_out;
+        sets._live_in = live_in;
+        return true;
     }
 
     // ***************************** END class implementing liveness analysis ***************************** //
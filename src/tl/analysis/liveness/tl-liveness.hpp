@@ -27,6 +27,7 @@
 #ifndef TL_LIVENESS_HPP
 #define TL_LIVENESS_HPP
 
+#include "tl-dataflow-sets.hpp"
 #include "tl-extensible-graph.hpp"
 
 namespace TL {
@@ -45,29 +46,66 @@ namespace Analysis {
      *                                      where y = all successors of x
      *      - x is a task:                  L0(x) = UE(x) U ( LO(x) - (KILL(x) - Private|Firstprivate(x)) ), 
      */
-    class LIBTL_CLASS Liveness
+    class LIBTL_CLASS Liveness : private WorklistSolver
     {
     private:
+        //! Liveness sets of a node while the equations are solved
+        struct LiveSets
+        {
+            BitVector _ue;
+            BitVector _killed;
+            BitVector _live_in;
+            BitVector _live_out;
+            //! Variables of the node that are not live out of it. Only for graph nodes
+            BitVector _private;
+            //! Elements already classified by #filter_inner_vars and those kept. Only for context nodes
+            BitVector _checked_context;
+            BitVector _outer_context;
+            bool _private_computed;
+            bool _modified;
+
+            LiveSets()
+                : _private_computed(false), _modified(false)
+            {}
+        };
+        typedef std::map<Node*, LiveSets> LiveSetsMap;
+
         ExtensibleGraph* _graph;
         bool _propagate_graph_nodes;
 
+        //! Variables and data references of the graph, numbered when they are first found
+        NodeclUniverse _vars;
+        LiveSetsMap _live_sets;
+
+        //! Returns the sets of \n, converting them from the node the first time
+        LiveSets& get_live_sets(Node* n);
+
+        //! Stores into each node the liveness sets that have changed
+        void commit_live_sets();
+
+        //! Removes from \live_in the variables that are not visible out of \graph
+        void filter_inner_vars(Node* graph, BitVector& live_in);
+
         //! Computes the liveness information of each node regarding only its inner statements
         //! Live In (X) = Upper exposed (X)
         void initialize_live_sets(Node* current);
 
-        //! Computes liveness equations for a given node and calls recursively to its children
-        void solve_live_equations_rec(Node* current, bool& changed);
-        void solve_task_live_equations_rec(Node* n, bool& changed, Node* task);
+        //! Computes liveness equations for a given node
+        bool evaluate(Node* n);
+
+        //! Computes the liveness sets of the last node of a task, which are the same
+        //! Excludes from them those variables private to the task
+        bool solve_task_live_equations(Node* exit_flush, Node* task);
 
-        //! Initiates computation of a task liveness sets
-        //! Excludes from the exit node LiveOut those variables private to the task
-        void solve_specific_live_in_tasks(Node* current);
+        //! Returns the task whose last node is \n, if any
+        Node* get_task_of_exit_flush(Node* n);
 
         //! U(Live In(Y)), for all Y successors of X
-        NodeclSet compute_successors_live_in(Node* n);
+        BitVector compute_successors_live_in(Node* n);
 
         //! Propagates liveness information from inner to outer nodes
-        void set_graph_node_liveness(Node* current);
+        //! Returns whether the sets of \current have changed
+        bool set_graph_node_liveness(Node* current);
 
     public:
         //! Constructor
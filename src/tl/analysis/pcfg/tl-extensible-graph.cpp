@@ -24,6 +24,7 @@
   Cambridge, MA 02139, USA.
 --------------------------------------------------------------------*/
 
+#include <functional>
 #include <queue>
 
 #include "tl-datareference.hpp"
@@ -40,6 +41,7 @@ namespace Analysis {
           _concurrent_tasks(), _last_sync_tasks(), _last_sync_sequential(), _next_sync_tasks(), _next_sync_sequential(),
           _cluster_to_entry_map(), _usage_computed(false)
     {
+        _post_order_computed[0] = _post_order_computed[1] = false;
 
         _graph = create_graph_node(NULL, nodecl, __ExtensibleGraph);
         _utils->_last_nodes = ObjectList<Node*>(1, _graph->get_graph_entry_node());
@@ -87,6 +89,7 @@ namespace Analysis {
         {
             if(!parent->has_child(child))
             {
+                invalidate_post_order();
                 edge = new Edge(parent, child, is_task_edge, etype, label, is_back_edge);
                 parent->set_exit_edge(edge);
                 child->set_entry_edge(edge);
@@ -218,6 +221,7 @@ namespace Analysis {
 
     void ExtensibleGraph::disconnect_nodes(Node *parent, Node *child)
     {
+        invalidate_post_order();
         parent->erase_exit_edge(child);
         child->erase_entry_edge(parent);
     }
@@ -266,6 +270,8 @@ namespace Analysis {
 
     void ExtensibleGraph::delete_node(Node* n)
     {
+        invalidate_post_order();
+
         // Delete the node from its parents
         ObjectList<Node*> entry_nodes = n->get_parents();
         for(ObjectList<Node*>::iterator it = entry_nodes.begin(); it != entry_nodes.end(); ++it)
@@ -809,6 +815,69 @@ namespace Analysis {
         }
     }
 
+    void ExtensibleGraph::invalidate_post_order()
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            if (_post_order_computed[i])
+            {
+                _post_order[i].clear();
+                _post_order_number[i].clear();
+                _post_order_computed[i] = false;
+            }
+        }
+    }
+
+    void ExtensibleGraph::compute_post_order_rec(Node* n, bool backwards,
+            std::set<Node*>& visited, ObjectList<Node*>& result)
+    {
+        if (!visited.insert(n).second)
+            return;
+
+        // Same traversal as the recursive solvers: the flow does not leave a graph
+        // through its exit (or its entry backwards), it continues from the graph node
+        if (!(backwards ? n->is_entry_node() : n->is_exit_node()))
+        {
+            const ObjectList<Node*>& next = backwards ? n->get_parents() : n->get_children();
+            for (ObjectList<Node*>::const_iterator it = next.begin(); it != next.end(); ++it)
+                compute_post_order_rec(*it, backwards, visited, result);
+        }
+        // The inner nodes go last, so in reverse post-order they come right after
+        // the graph node and before whatever follows it
+        if (n->is_graph_node())
+        {
+            compute_post_order_rec(backwards ? n->get_graph_exit_node() : n->get_graph_entry_node(),
+                                   backwards, visited, result);
+        }
+
+        result.append(n);
+    }
+
+    const ObjectList<Node*>& ExtensibleGraph::get_post_order(bool backwards)
+    {
+        if (!_post_order_computed[backwards])
+        {
+            std::set<Node*> visited;
+            ObjectList<Node*>& result = _post_order[backwards];
+            compute_post_order_rec(_graph, backwards, visited, result);
+            if (backwards && _post_sync != NULL)
+                compute_post_order_rec(_post_sync, backwards, visited, result);
+
+            std::map<Node*, int>& numbers = _post_order_number[backwards];
+            for (unsigned int i = 0; i < result.size(); ++i)
+                numbers[result[i]] = i;
+            _post_order_computed[backwards] = true;
+        }
+        return _post_order[backwards];
+    }
+
+    int ExtensibleGraph::get_post_order_number(Node* n, bool backwards)
+    {
+        get_post_order(backwards);
+        std::map<Node*, int>::const_iterator it = _post_order_number[backwards].find(n);
+        return (it == _post_order_number[backwards].end()) ? -1 : it->second;
+    }
+
     std::string ExtensibleGraph::get_name() const
     {
         return _name;
@@ -847,6 +916,7 @@ namespace Analysis {
     void ExtensibleGraph::set_post_sync(Node* post_sync)
     {
         _post_sync = post_sync;
+        invalidate_post_order();
     }
 
     void ExtensibleGraph::set_pointer_n_elems(const NBase& s, const NBase& size)
@@ -1579,5 +1649,68 @@ namespace Analysis {
 
     // ***** END Getters and setters for analyses built on top of the PCFG ***** //
 
+    // ******************************* Worklist solver ******************************** //
+
+    WorklistSolver::WorklistSolver(ExtensibleGraph* pcfg, bool backwards)
+        : _pcfg(pcfg), _backwards(backwards), _current(NULL), _readers(),
+          _num_nodes(0), _num_evaluations(0)
+    {}
+
+    WorklistSolver::~WorklistSolver()
+    {}
+
+    void WorklistSolver::add_dependency(Node* n)
+    {
+        if (_current != NULL && _current != n)
+            _readers[n].insert(_current);
+    }
+
+    void WorklistSolver::solve()
+    {
+        const ObjectList<Node*>& post_order = _pcfg->get_post_order(_backwards);
+        _num_nodes = post_order.size();
+
+        // The worklist holds post-order numbers, highest first, so nodes are taken in reverse post-order
+        std::set<int, std::greater<int> > worklist;
+        for (unsigned int i = 0; i < post_order.size(); ++i)
+            worklist.insert(i);
+
+        while (!worklist.empty())
+        {
+            Node* n = post_order[*worklist.begin()];
+            worklist.erase(worklist.begin());
+
+            _current = n;
+            bool changed = evaluate(n);
+            _current = NULL;
+            _num_evaluations++;
+
+            if (!changed)
+                continue;
+
+            std::map<Node*, std::set<Node*> >::iterator readers = _readers.find(n);
+            if (readers == _readers.end())
+                continue;
+            for (std::set<Node*>::iterator it = readers->second.begin(); it != readers->second.end(); ++it)
+            {
+                int number = _pcfg->get_post_order_number(*it, _backwards);
+                if (number >= 0)
+                    worklist.insert(number);
+            }
+        }
+        _readers.clear();
+    }
+
+    unsigned int WorklistSolver::get_num_nodes() const
+    {
+        return _num_nodes;
+    }
+
+    unsigned int WorklistSolver::get_num_evaluations() const
+    {
+        return _num_evaluations;
+    }
+
+    // ***************************** END worklist solver ****************************** //
 }
 }
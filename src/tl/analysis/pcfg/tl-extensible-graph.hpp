@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <map>
+#include <set>
 #include <stack>
 
 #include "cxx-codegen.h"
@@ -114,6 +115,12 @@ namespace Analysis {
         // *** Variables storing info about analyses built on top of the PCFG *** //
         bool _usage_computed;
 
+        //! Nodes in post-order following the flow forwards [0] and backwards [1], and the
+        //! position of each node in them. They are computed on demand and dropped when the graph changes
+        ObjectList<Node*> _post_order[2];
+        std::map<Node*, int> _post_order_number[2];
+        bool _post_order_computed[2];
+
     private:
         //! We don't want to allow this kind of constructions
         ExtensibleGraph(const ExtensibleGraph& graph);
@@ -138,6 +145,9 @@ namespace Analysis {
 
         void erase_jump_nodes(Node* current);
 
+        void invalidate_post_order();
+        void compute_post_order_rec(Node* n, bool backwards, std::set<Node*>& visited, ObjectList<Node*>& result);
+
         //! Structurally looks for nodecl 'n' in 'current' and its successors
         Node* find_nodecl_rec(Node* current, const NBase& n);
         
@@ -457,9 +467,61 @@ namespace Analysis {
         bool usage_is_computed() const;
         void set_usage_computed();
 
+        // *** Node orderings for data-flow analyses *** //
+        //! Returns the nodes of the graph in post-order.
+        /*!
+         * Forwards, the traversal starts at the entry of the graph and enters graph nodes through their entry.
+         * Backwards, it starts at the exit of the graph (and the post-sync node, if any)
+         * and enters graph nodes through their exit.
+         * Nodes are numbered once and the numbering is kept until the graph is modified.
+         */
+        const ObjectList<Node*>& get_post_order(bool backwards = false);
+        //! Returns the position of \n in #get_post_order, or -1 if it is not reachable
+        int get_post_order_number(Node* n, bool backwards = false);
+
     friend class PCFGVisitor;
     };
 
+    //! Worklist solver for data-flow analyses over a PCFG
+    /*!
+     * Nodes are evaluated in reverse post-order of the direction of the analysis, so
+     * predecessors (or successors when going backwards) are evaluated before.
+     * Afterwards, only the nodes whose evaluation read the information of a node that
+     * has changed are evaluated again, until no node changes.
+     */
+    class LIBTL_CLASS WorklistSolver
+    {
+    private:
+        ExtensibleGraph* _pcfg;
+        bool _backwards;
+
+        //! Node being evaluated, if any
+        Node* _current;
+        //! Nodes whose evaluation read the information of each node
+        std::map<Node*, std::set<Node*> > _readers;
+
+        unsigned int _num_nodes;
+        unsigned int _num_evaluations;
+
+    protected:
+        //! Computes the information of \n from the information of other nodes
+        //! Returns whether the information of \n has changed
+        virtual bool evaluate(Node* n) = 0;
+
+        //! Analyses must call this whenever an evaluation reads the information of \n
+        void add_dependency(Node* n);
+
+        //! Evaluates all the nodes until a fixed point is reached
+        void solve();
+
+        unsigned int get_num_nodes() const;
+        unsigned int get_num_evaluations() const;
+
+    public:
+        WorklistSolver(ExtensibleGraph* pcfg, bool backwards);
+        virtual ~WorklistSolver();
+    };
+
 }
 }
 
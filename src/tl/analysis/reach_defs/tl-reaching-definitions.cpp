@@ -33,7 +33,9 @@ namespace Analysis {
     // ************************** Class implementing reaching definition analysis ************************* //
 
     ReachingDefinitions::ReachingDefinitions(ExtensibleGraph* graph)
-        : _graph(graph), _unknown_reach_defs()
+        : WorklistSolver(graph, /*backwards*/ false),
+          _graph(graph), _unknown_reach_defs(), _vars(), _defs(), _defs_index(),
+          _var_defs(), _unknown_defs(), _rd_sets()
     {}
 
     void ReachingDefinitions::compute_reaching_definitions()
@@ -48,8 +50,82 @@ namespace Analysis {
         ExtensibleGraph::clear_visits(graph);
 
         // Common Reaching Definitions analysis
-        solve_reaching_definition_equations(graph);
-        ExtensibleGraph::clear_visits(graph);
+        solve();
+        if (ANALYSIS_PERFORMANCE_MEASURE)
+            fprintf(stderr, "ANALYSIS: REACHING DEFINITIONS of '%s': %u nodes, %u evaluations\n",
+                    _graph->get_name().c_str(), get_num_nodes(), get_num_evaluations());
+
+        commit_rd_sets();
+    }
+
+    BitVector ReachingDefinitions::to_bit_vector(const NodeclMap& m)
+    {
+        BitVector result;
+        for (NodeclMap::const_iterator it = m.begin(); it != m.end(); ++it)
+        {
+            unsigned int var = _vars.get_index(it->first);
+            DefinitionKey key(var, std::make_pair(nodecl_get_ast(it->second.first.get_internal_nodecl()),
+                                                  nodecl_get_ast(it->second.second.get_internal_nodecl())));
+            std::pair<DefinitionIndexMap::iterator, bool> def_it =
+                _defs_index.insert(std::make_pair(key, (unsigned int)_defs.size()));
+            if (def_it.second)
+            {
+                _defs.push_back(Definition(var, it->first, it->second));
+                if (var >= _var_defs.size())
+                    _var_defs.resize(var + 1);
+                _var_defs[var].set(def_it.first->second);
+            }
+            result.set(def_it.first->second);
+        }
+        return result;
+    }
+
+    NodeclMap ReachingDefinitions::to_nodecl_map(const BitVector& b) const
+    {
+        NodeclMap result;
+        for (unsigned int i = b.find_next(0); i != BitVector::npos; i = b.find_next(i + 1))
+            result.insert(std::pair<NBase, NodeclPair>(_defs[i]._key, _defs[i]._value));
+        return result;
+    }
+
+    ReachingDefinitions::ReachDefsSets& ReachingDefinitions::get_rd_sets(Node* n)
+    {
+        add_dependency(n);
+
+        ReachDefsSetsMap::iterator it = _rd_sets.find(n);
+        if (it != _rd_sets.end())
+            return it->second;
+
+        ReachDefsSets& sets = _rd_sets[n];
+        sets._gen = to_bit_vector(n->get_generated_stmts());
+        sets._rd_in = to_bit_vector(n->get_reaching_definitions_in());
+        sets._rd_out = to_bit_vector(n->get_reaching_definitions_out());
+        if (n->is_omp_task_creation_node())
+        {   // Variables from non-task children nodes do not count here
+            Node* created_task = ExtensibleGraph::get_task_from_task_creation(n);
+            ERROR_CONDITION(created_task==NULL, 
+                            "Task created by task creation node %d not found.\n", 
+                            n->get_id());
+            sets._killed = _vars.to_bit_vector(created_task->get_killed_vars());
+            sets._killed.intersection_with(_vars.to_bit_vector(created_task->get_all_shared_accesses()));
+        }
+        else
+        {
+            sets._killed = _vars.to_bit_vector(n->get_killed_vars());
+        }
+        return sets;
+    }
+
+    void ReachingDefinitions::commit_rd_sets()
+    {
+        for (ReachDefsSetsMap::iterator it = _rd_sets.begin(); it != _rd_sets.end(); ++it)
+        {
+            if (!it->second._modified)
+                continue;
+            it->first->set_reaching_definitions_in(to_nodecl_map(it->second._rd_in));
+            it->first->set_reaching_definitions_out(to_nodecl_map(it->second._rd_out));
+        }
+        _rd_sets.clear();
     }
 
     void ReachingDefinitions::generate_unknown_reaching_definitions()
@@ -68,6 +144,7 @@ namespace Analysis {
                     std::pair<NBase, NodeclPair>(
                             s, NodeclPair(Nodecl::Unknown::make(), Nodecl::Unknown::make())));
         }
+        _unknown_defs = to_bit_vector(_unknown_reach_defs);
     }
     
     void ReachingDefinitions::gather_reaching_definitions_initial_information(Node* current)
@@ -104,145 +181,95 @@ namespace Analysis {
         }
     }
 
-    void ReachingDefinitions::solve_reaching_definition_equations(Node* current)
+    bool ReachingDefinitions::evaluate(Node* current)
     {
-        bool changed = true;
-        while(changed)
-        {
-            changed = false;
-            solve_reaching_definition_equations_rec(current, changed);
-            ExtensibleGraph::clear_visits(current);
-        }
-    }
+        if (current->is_entry_node() || current->is_exit_node())
+            return false;
 
-    void ReachingDefinitions::solve_reaching_definition_equations_rec(Node* current, bool& changed)
-    {
-        if (!current->is_visited())
-        {
-            current->set_visited(true);
+        if (current->is_graph_node())
+            return set_graph_node_reaching_definitions(current);
+
+        BitVector rd_in;
 
-            if(!current->is_exit_node())
+        // Computing Reach Defs In
+        const ObjectList<Node*>& parents = current->get_parents();
+        for(ObjectList<Node*>::const_iterator it = parents.begin(); it != parents.end(); ++it)
+        {
+            bool parent_is_entry = (*it)->is_entry_node();
+            if(parent_is_entry)
             {
-                if(current->is_graph_node())
+                // Iterate over outer parents while we found an ENTRY node
+                Node* entry_outer_node = (*it)->get_outer_node();
+                ObjectList<Node*> outer_parents;
+                while(parent_is_entry)
                 {
-                    solve_reaching_definition_equations_rec(current->get_graph_entry_node(), changed);
-                    set_graph_node_reaching_definitions(current);
+                    outer_parents = entry_outer_node->get_parents();
+                    parent_is_entry = (outer_parents.size() == 1) && outer_parents[0]->is_entry_node();
+                    entry_outer_node = (parent_is_entry ? outer_parents[0]->get_outer_node() : NULL);
                 }
-                else if(!current->is_entry_node())
-                {
-                    const NodeclMap& old_rd_in = current->get_reaching_definitions_in();
-                    const NodeclMap& old_rd_out = current->get_reaching_definitions_out();
-                    NodeclMap rd_out, rd_in, pred_rd_out;
-
-                    // Computing Reach Defs In
-                    const ObjectList<Node*>& parents = current->get_parents();
-                    for(ObjectList<Node*>::const_iterator it = parents.begin(); it != parents.end(); ++it)
-                    {
-                        bool parent_is_entry = (*it)->is_entry_node();
-                        if(parent_is_entry)
-                        {
-                            // Iterate over outer parents while we found an ENTRY node
-                            Node* entry_outer_node = (*it)->get_outer_node();
-                            ObjectList<Node*> outer_parents;
-                            while(parent_is_entry)
-                            {
-                                outer_parents = entry_outer_node->get_parents();
-                                parent_is_entry = (outer_parents.size() == 1) && outer_parents[0]->is_entry_node();
-                                entry_outer_node = (parent_is_entry ? outer_parents[0]->get_outer_node() : NULL);
-                            }
-                            // Get the Reach Def Out of the current predecessors
-                            for(ObjectList<Node*>::iterator itop = outer_parents.begin(); itop != outer_parents.end(); ++itop)
-                            {
-                                const NodeclMap& outer_rd_out = (*itop)->get_reaching_definitions_out();
-                                pred_rd_out.insert(outer_rd_out.begin(), outer_rd_out.end());
-                            }
-                        }
-                        else
-                        {
-                            pred_rd_out = (*it)->get_reaching_definitions_out();
-                        }
-                        rd_in = Utils::nodecl_map_union(rd_in, pred_rd_out);
-                        if(_graph->is_first_statement_node(current))
-                            rd_in = Utils::nodecl_map_union(rd_in, _unknown_reach_defs);
-                    }
-
-                    // Computing Reach Defs Out
-                    NodeclSet killed;
-                    if(current->is_omp_task_creation_node())
-                    {   // Variables from non-task children nodes do not count here
-                        Node* created_task = ExtensibleGraph::get_task_from_task_creation(current);
-                        ERROR_CONDITION(created_task==NULL, 
-                                        "Task created by task creation node %d not found.\n", 
-                                        current->get_id());
-                        const NodeclSet& task_killed = created_task->get_killed_vars();
-                        const NodeclSet& shared_vars = created_task->get_all_shared_accesses();
-                        for(NodeclSet::const_iterator it = task_killed.begin(); it != task_killed.end(); ++it)
-                        {
-                            if(shared_vars.find(*it) != shared_vars.end())
-                                killed.insert(*it);
-                        }
-                    }
-                    else
-                    {
-                        killed = current->get_killed_vars();
-                    }
-                    NodeclMap diff = Utils::nodecl_map_minus_nodecl_set(rd_in, killed);
+                // Get the Reach Def Out of the current predecessors
+                for(ObjectList<Node*>::iterator itop = outer_parents.begin(); itop != outer_parents.end(); ++itop)
+                    rd_in.union_with(get_rd_sets(*itop)._rd_out);
+            }
+            else
+            {
+                rd_in.union_with(get_rd_sets(*it)._rd_out);
+            }
+            if(_graph->is_first_statement_node(current))
+                rd_in.union_with(_unknown_defs);
+        }
 
-                    const NodeclMap& gen = current->get_generated_stmts();
-                    rd_out = Utils::nodecl_map_union(gen, diff);
+        // Computing Reach Defs Out: RDO(x) = Gen(x) U ( RDI(x) - Killed(x) )
+        ReachDefsSets& sets = get_rd_sets(current);
+        BitVector rd_out = rd_in;
+        for (unsigned int i = sets._killed.find_next(0); i != BitVector::npos; i = sets._killed.find_next(i + 1))
+        {
+            if (i < _var_defs.size())
+                rd_out.difference_with(_var_defs[i]);
+        }
+        rd_out.union_with(sets._gen);
 
-                    if (!Utils::nodecl_map_equivalence(old_rd_in, rd_in) || 
-                        !Utils::nodecl_map_equivalence(old_rd_out, rd_out))
-                    {
-                        current->set_reaching_definitions_in(rd_in);
-                        current->set_reaching_definitions_out(rd_out);
-                        changed = true;
-                    }
-                }
+        if (rd_in == sets._rd_in && rd_out == sets._rd_out)
+            return false;
 
-                ObjectList<Node*> children = current->get_children();
-                for(ObjectList<Node*>::iterator it = children.begin(); it != children.end(); ++it)
-                {
-                    solve_reaching_definition_equations_rec(*it, changed);
-                }
-            }
-        }
+        sets._rd_in = rd_in;
+        sets._rd_out = rd_out;
+        sets._modified = true;
+        return true;
     }
 
-    void ReachingDefinitions::set_graph_node_reaching_definitions(Node* current)
+    bool ReachingDefinitions::set_graph_node_reaching_definitions(Node* current)
     {
         if(current->is_graph_node())
         {
             // RDI(graph) = U RDI(inner entries)
-            NodeclMap graph_rdi;
+            BitVector graph_rdi;
             ObjectList<Node*> entries = current->get_graph_entry_node()->get_children();
             for(ObjectList<Node*>::iterator it = entries.begin(); it != entries.end(); ++it)
             {
                 if(!(*it)->is_labeled_node())
                 {
-                    graph_rdi = Utils::nodecl_map_union(graph_rdi, (*it)->get_reaching_definitions_in());
+                    graph_rdi.union_with(get_rd_sets(*it)._rd_in);
                 }
                 else
                 {   // Remove those definitions coming from any goto to this labeled node
-                    ObjectList<Node*> parents = (*it)->get_parents();
                     for(ObjectList<Node*>::iterator itt = entries.begin(); itt != entries.end(); ++itt)
                     {
                         if(!(*itt)->is_goto_node())
                         {
-                            graph_rdi = Utils::nodecl_map_union(graph_rdi, (*it)->get_reaching_definitions_in());
+                            graph_rdi.union_with(get_rd_sets(*it)._rd_in);
+                            break;
                         }
                     }
                 }
             }
-            
-            current->set_reaching_definitions_in(graph_rdi);
 
             // RDO(graph) = U RDO(inner exits)
-            NodeclMap graph_rdo;
+            BitVector graph_rdo;
             ObjectList<Node*> exits = current->get_graph_exit_node()->get_parents();
             for(ObjectList<Node*>::iterator it = exits.begin(); it != exits.end(); ++it)
             {
-                graph_rdo = Utils::nodecl_map_union(graph_rdo, (*it)->get_reaching_definitions_out());
+                graph_rdo.union_with(get_rd_sets(*it)._rd_out);
             }
             if(graph_rdo.empty())
             {   // This may happen when no Reaching Defintion has been computed inside the graph or
@@ -251,8 +278,17 @@ namespace Analysis {
                 // In this case, we propagate the Reaching Definition Out from the parents
                 graph_rdo = graph_rdi;
             }
-            current->set_reaching_definitions_out(graph_rdo);
+
+            ReachDefsSets& sets = get_rd_sets(current);
+            sets._modified = true;
+            if (graph_rdi == sets._rd_in && graph_rdo == sets._rd_out)
+                return false;
+
+            sets._rd_in = graph_rdi;
+            sets._rd_out = graph_rdo;
+            return true;
         }
+        return false;
     }
 
     // *********************** End class implementing reaching definitions analysis *********************** //
@@ -27,6 +27,7 @@
 #ifndef TL_REACHING_DEFINITIONS_HPP
 #define TL_REACHING_DEFINITIONS_HPP
 
+#include "tl-dataflow-sets.hpp"
 #include "tl-extensible-graph.hpp"
 #include "tl-nodecl-visitor.hpp"
 
@@ -37,28 +38,77 @@ namespace Analysis {
     // ************************** Class implementing reaching definition analysis ************************* //
 
     //! Class implementing Reaching Definitions Analysis
-    class LIBTL_CLASS ReachingDefinitions
+    class LIBTL_CLASS ReachingDefinitions : private WorklistSolver
     {
     private:
+        //! A definition is a variable together with the value and the statement defining it
+        //! Definitions of the same variable are told apart by the nodecls of the value and the statement
+        struct Definition
+        {
+            unsigned int _var;
+            NBase _key;
+            NodeclPair _value;
+
+            Definition(unsigned int var, const NBase& key, const NodeclPair& value)
+                : _var(var), _key(key), _value(value)
+            {}
+        };
+        typedef std::pair<unsigned int, std::pair<AST, AST> > DefinitionKey;
+        typedef std::map<DefinitionKey, unsigned int> DefinitionIndexMap;
+
+        //! Reaching definitions sets of a node while the equations are solved
+        struct ReachDefsSets
+        {
+            BitVector _gen;
+            //! Variables, not definitions
+            BitVector _killed;
+            BitVector _rd_in;
+            BitVector _rd_out;
+            bool _modified;
+
+            ReachDefsSets()
+                : _modified(false)
+            {}
+        };
+        typedef std::map<Node*, ReachDefsSets> ReachDefsSetsMap;
+
         ExtensibleGraph* _graph;
         NodeclMap _unknown_reach_defs;
 
+        //! Variables and definitions of the graph, numbered when they are first found
+        NodeclUniverse _vars;
+        std::vector<Definition> _defs;
+        DefinitionIndexMap _defs_index;
+        //! Definitions of each variable
+        std::vector<BitVector> _var_defs;
+        BitVector _unknown_defs;
+        ReachDefsSetsMap _rd_sets;
+
+        BitVector to_bit_vector(const NodeclMap& m);
+        NodeclMap to_nodecl_map(const BitVector& b) const;
+
+        //! Returns the sets of \n, converting them from the node the first time
+        ReachDefsSets& get_rd_sets(Node* n);
+
+        //! Stores into each node the reaching definitions sets that have changed
+        void commit_rd_sets();
+
         void generate_unknown_reaching_definitions( );
         
         //!Computes the reaching definitions of each node regarding only its inner statements
         //!Reach Out (X) = Gen (X)
         void gather_reaching_definitions_initial_information( Node* current );
 
-        //!Computes reaching definition equations for a given node and calls recursively to its children
+        //!Computes reaching definition equations for a given node
         /*!
          * Reach in (X) = Union of all Reach Out (Y), for all Y predecessors of X
          * Reach out (X) = Gen (X) + ( Reach In (X) - Killed (X) )
          */
-        void solve_reaching_definition_equations( Node* current );
-        void solve_reaching_definition_equations_rec( Node* current, bool& changed );
+        bool evaluate( Node* current );
 
         //! Propagates reaching definitions information from inner to outer nodes
-        void set_graph_node_reaching_definitions( Node* current );
+        //! Returns whether the sets of \current have changed
+        bool set_graph_node_reaching_definitions( Node* current );
 
         NodeclMap combine_generated_statements(Node* current);
 
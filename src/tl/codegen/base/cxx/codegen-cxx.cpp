@@ -112,6 +112,51 @@ void CxxBase::codegen_cleanup()
     _codegen_status.clear();
 }
 
+bool CxxBase::is_independent_definition(const Nodecl::NodeclBase& n)
+{
+    if (!n.is<Nodecl::FunctionCode>())
+        return false;
+
+    TL::Symbol symbol = n.get_symbol();
+
+    // These are not emitted at all or are emitted along with their class
+    return get_codegen_status(symbol) != CODEGEN_STATUS_DEFINED
+        && state.classes_being_defined.empty()
+        && !symbol.is_defined_inside_class();
+}
+
+void CxxBase::codegen_definition_prologue(const Nodecl::NodeclBase& n)
+{
+    bool must_be_defined = define_function_code_prologue(n.as<Nodecl::FunctionCode>(),
+            _independent_definition_old_status);
+    ERROR_CONDITION(!must_be_defined, "Independent definition is not going to be defined", 0);
+}
+
+bool CxxBase::codegen_definition_body(const Nodecl::NodeclBase& n)
+{
+    // Emitting the body in another process is only correct if its effects
+    // on the state are not seen by the following top level definitions
+    State old_state = state;
+
+    _tracking_independent_definition = true;
+    _independent_definition_has_nonlocal_effects = false;
+
+    define_function_code_body(n.as<Nodecl::FunctionCode>(),
+            _independent_definition_old_status);
+
+    _tracking_independent_definition = false;
+
+    return !_independent_definition_has_nonlocal_effects
+        && state.opened_namespace == old_state.opened_namespace
+        && state._indent_level == old_state._indent_level
+        && state._inline_comment_nest == old_state._inline_comment_nest
+        && state.classes_being_defined == old_state.classes_being_defined
+        && state.pending_nested_types_to_define == old_state.pending_nested_types_to_define
+        && state.walked_symbols == old_state.walked_symbols
+        && state.must_be_object_init == old_state.must_be_object_init
+        && state.friend_function_declared_but_not_defined == old_state.friend_function_declared_but_not_defined;
+}
+
 void CxxBase::handle_parameter(int n, void* data)
 {
      switch (n)
@@ -2564,6 +2609,18 @@ TL::Type CxxBase::coerce_parameter_types_of_function_type(TL::Symbol sym)
 }
 
 CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
+{
+    codegen_status_t old_status = CODEGEN_STATUS_NONE;
+    if (!define_function_code_prologue(node, old_status))
+        return;
+
+    define_function_code_body(node, old_status);
+}
+
+// Emits everything required before the definition of the function and
+// marks it as defined. Returns false if the function must not be defined
+bool CxxBase::define_function_code_prologue(const Nodecl::FunctionCode& node,
+        codegen_status_t& old_status)
 {
     if (_prune_saved_variables)
     {
@@ -2574,7 +2631,6 @@ CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
     //Only independent code
     Nodecl::Context context = node.get_statements().as<Nodecl::Context>();
     Nodecl::List statement_seq = context.get_in_context().as<Nodecl::List>();
-    Nodecl::NodeclBase initializers = node.get_initializers();
 
     if (statement_seq.size() != 1)
     {
@@ -2587,7 +2643,7 @@ CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
 
     // We don't define twice a symbol
     if (get_codegen_status(symbol) == CODEGEN_STATUS_DEFINED)
-        return;
+        return false;
 
     // Two return cases for C++:
     //  - The symbol is defined inside a certain class and we are not defining this class yet
@@ -2598,7 +2654,7 @@ CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
                         || state.classes_being_defined.back() != symbol.get_class_type().get_symbol()))
                 || (!symbol.is_defined_inside_class()
                     && !state.classes_being_defined.empty())))
-        return;
+        return false;
 
     TL::Type symbol_type = symbol.get_type();
 
@@ -2611,36 +2667,17 @@ CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
                 &CxxBase::define_nonlocal_nonprototype_entities_in_trees);
     }
 
-    TL::Scope symbol_scope = symbol.get_scope();
-
     state.friend_function_declared_but_not_defined.erase(symbol);
 
     ERROR_CONDITION(!symbol.is_function()
             && !symbol.is_dependent_friend_function(), "Invalid symbol", 0);
 
-    bool is_template_specialized = symbol_type.is_template_specialized_type();
-
-    bool is_primary = false;
-    if (!symbol.get_class_type().is_valid()
-            || !is_friend_of_class(symbol, symbol.get_class_type().get_symbol()))
-    {
-        if (!symbol.is_member()
-                && is_template_specialized)
-        {
-            TL::Type template_type = symbol_type.get_related_template_type();
-            TL::Type primary_type = template_type.get_primary_template();
-            TL::Symbol primary_symbol = primary_type.get_symbol();
-
-            is_primary = (primary_symbol == symbol);
-        }
-    }
-
     state.current_symbol = symbol;
 
     // At this point, we mark the function as defined. It must be done here to
     // avoid the useless declaration of the function being defined and other
     // related problems.
-    codegen_status_t old_status = get_codegen_status(symbol);
+    old_status = get_codegen_status(symbol);
     set_codegen_status(symbol, CODEGEN_STATUS_DEFINED);
 
     C_LANGUAGE()
@@ -2663,6 +2700,37 @@ CxxBase::Ret CxxBase::visit(const Nodecl::FunctionCode& node)
 
     move_to_namespace_of_symbol(symbol);
 
+    return true;
+}
+
+// Emits the definition of the function itself
+void CxxBase::define_function_code_body(const Nodecl::FunctionCode& node,
+        codegen_status_t old_status)
+{
+    Nodecl::Context context = node.get_statements().as<Nodecl::Context>();
+    Nodecl::NodeclBase initializers = node.get_initializers();
+
+    TL::Symbol symbol = node.get_symbol();
+    TL::Type symbol_type = symbol.get_type();
+    TL::Scope symbol_scope = symbol.get_scope();
+
+    bool is_template_specialized = symbol_type.is_template_specialized_type();
+
+    bool is_primary = false;
+    if (!symbol.get_class_type().is_valid()
+            || !is_friend_of_class(symbol, symbol.get_class_type().get_symbol()))
+    {
+        if (!symbol.is_member()
+                && is_template_specialized)
+        {
+            TL::Type template_type = symbol_type.get_related_template_type();
+            TL::Type primary_type = template_type.get_primary_template();
+            TL::Symbol primary_symbol = primary_type.get_symbol();
+
+            is_primary = (primary_symbol == symbol);
+        }
+    }
+
     // We may need zero or more empty template headers
     bool emit_default_arguments = true;
     TL::TemplateParameters tpl = symbol_scope.get_template_parameters();
@@ -4355,7 +4423,7 @@ CxxBase::Ret CxxBase::visit(const Nodecl::Throw& node)
 
 CxxBase::Ret CxxBase::visit(const Nodecl::TopLevel& node)
 {
-    walk(node.get_top_level());
+    codegen_top_level_list(node.get_top_level());
 }
 
 CxxBase::Ret CxxBase::visit(const Nodecl::TryBlock& node)
@@ -8089,6 +8157,12 @@ void CxxBase::walk_type_for_symbols(TL::Type t,
 
 void CxxBase::set_codegen_status(TL::Symbol sym, codegen_status_t status)
 {
+    if (_tracking_independent_definition
+            && is_nonlocal_symbol(sym)
+            && get_codegen_status(sym) != status)
+    {
+        _independent_definition_has_nonlocal_effects = true;
+    }
     _codegen_status[sym] = status;
 }
 
@@ -9569,6 +9643,9 @@ bool CxxBase::cuda_emit_always_extern_linkage()
 }
 
 CxxBase::CxxBase()
+    : _independent_definition_old_status(CODEGEN_STATUS_NONE),
+    _tracking_independent_definition(false),
+    _independent_definition_has_nonlocal_effects(false)
 {
     set_phase_name("C/C++ codegen");
     set_phase_description("This phase emits in C/C++ the intermediate representation of the compiler");
@@ -41,6 +41,10 @@ namespace Codegen
         protected:
             virtual void codegen(const Nodecl::NodeclBase&, std::ostream* out);
 
+            virtual bool is_independent_definition(const Nodecl::NodeclBase& n);
+            virtual void codegen_definition_prologue(const Nodecl::NodeclBase& n);
+            virtual bool codegen_definition_body(const Nodecl::NodeclBase& n);
+
         public:
             CxxBase();
 
@@ -488,6 +492,16 @@ namespace Codegen
 
             std::map<TL::Symbol, codegen_status_t> _codegen_status;
 
+            // Parallel codegen of independent definitions
+            codegen_status_t _independent_definition_old_status;
+            bool _tracking_independent_definition;
+            bool _independent_definition_has_nonlocal_effects;
+
+            bool define_function_code_prologue(const Nodecl::FunctionCode& node,
+                    codegen_status_t& old_status);
+            void define_function_code_body(const Nodecl::FunctionCode& node,
+                    codegen_status_t old_status);
+
             void codegen_fill_namespace_list_rec(
                     scope_entry_t* namespace_sym,
                     scope_entry_t** list,
@@ -0,0 +1,282 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "codegen-buffer.hpp"
+
+#include <cstring>
+
+namespace Codegen
+{
+
+OutputBuffer::OutputBuffer()
+    : _chunks(), _current(0), _size(0), _sink(NULL), _sink_failed(false)
+{
+}
+
+OutputBuffer::OutputBuffer(FILE* sink)
+    : _chunks(), _current(0), _size(0), _sink(sink), _sink_failed(false)
+{
+}
+
+OutputBuffer::~OutputBuffer()
+{
+    flush();
+
+    for (std::vector<Chunk>::iterator it = _chunks.begin();
+            it != _chunks.end();
+            it++)
+    {
+        delete[] it->data;
+    }
+}
+
+void OutputBuffer::next_chunk(size_t min_capacity)
+{
+    if (_sink != NULL
+            && !_chunks.empty())
+    {
+        // Only one chunk is needed when there is a sink
+        flush();
+        if (_chunks[_current].capacity >= min_capacity)
+            return;
+
+        delete[] _chunks[_current].data;
+        _chunks[_current].data = new char[min_capacity];
+        _chunks[_current].capacity = min_capacity;
+        return;
+    }
+
+    if (!_chunks.empty())
+        _current++;
+
+    if (_current < _chunks.size()
+            && _chunks[_current].capacity >= min_capacity)
+    {
+        // Reuse a chunk kept by clear
+        return;
+    }
+
+    Chunk chunk;
+    chunk.capacity = (min_capacity > chunk_size) ? min_capacity : chunk_size;
+    chunk.data = new char[chunk.capacity];
+    chunk.used = 0;
+
+    _chunks.insert(_chunks.begin() + _current, chunk);
+}
+
+void OutputBuffer::append(const char* str, size_t length)
+{
+    while (length > 0)
+    {
+        size_t available = 0;
+        char* p = reserve(available);
+
+        size_t n = (length < available) ? length : available;
+        memcpy(p, str, n);
+        commit(n);
+
+        str += n;
+        length -= n;
+    }
+}
+
+char* OutputBuffer::reserve(size_t& available)
+{
+    if (_chunks.empty()
+            || _chunks[_current].used == _chunks[_current].capacity)
+    {
+        next_chunk(chunk_size);
+    }
+
+    Chunk& chunk = _chunks[_current];
+    available = chunk.capacity - chunk.used;
+    return chunk.data + chunk.used;
+}
+
+void OutputBuffer::commit(size_t length)
+{
+    if (length == 0)
+        return;
+
+    _chunks[_current].used += length;
+    _size += length;
+}
+
+void OutputBuffer::clear()
+{
+    for (std::vector<Chunk>::iterator it = _chunks.begin();
+            it != _chunks.end();
+            it++)
+    {
+        it->used = 0;
+    }
+    _current = 0;
+    _size = 0;
+}
+
+bool OutputBuffer::flush()
+{
+    if (_sink == NULL
+            || _chunks.empty())
+        return !_sink_failed;
+
+    Chunk& chunk = _chunks[_current];
+    if (chunk.used > 0
+            && fwrite(chunk.data, chunk.used, 1, _sink) != 1)
+    {
+        _sink_failed = true;
+    }
+    chunk.used = 0;
+
+    return !_sink_failed;
+}
+
+std::string OutputBuffer::str() const
+{
+    std::string result;
+    result.reserve(_size);
+
+    for (size_t i = 0; i < _chunks.size() && i <= _current; i++)
+    {
+        result.append(_chunks[i].data, _chunks[i].used);
+    }
+
+    return result;
+}
+
+void OutputBuffer::write_range(std::ostream& out, size_t begin, size_t end) const
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < _chunks.size() && i <= _current && offset < end; i++)
+    {
+        const Chunk& chunk = _chunks[i];
+
+        size_t chunk_begin = offset;
+        size_t chunk_end = offset + chunk.used;
+        offset = chunk_end;
+
+        if (chunk_end <= begin)
+            continue;
+
+        size_t from = (begin > chunk_begin) ? begin - chunk_begin : 0;
+        size_t to = (end < chunk_end) ? end - chunk_begin : chunk.used;
+
+        out.write(chunk.data + from, to - from);
+    }
+}
+
+bool OutputBuffer::write(FILE* out) const
+{
+    for (size_t i = 0; i < _chunks.size() && i <= _current; i++)
+    {
+        if (_chunks[i].used > 0
+                && fwrite(_chunks[i].data, _chunks[i].used, 1, out) != 1)
+            return false;
+    }
+    return true;
+}
+
+OutputBufferStreambuf::OutputBufferStreambuf(OutputBuffer& buffer)
+    : _buffer(buffer)
+{
+    // The put area is requested lazily in overflow
+    setp(NULL, NULL);
+}
+
+OutputBufferStreambuf::~OutputBufferStreambuf()
+{
+    commit_put_area();
+}
+
+void OutputBufferStreambuf::commit_put_area()
+{
+    _buffer.commit(pptr() - pbase());
+    setp(pptr(), epptr());
+}
+
+void OutputBufferStreambuf::reset_put_area()
+{
+    size_t available = 0;
+    char* p = _buffer.reserve(available);
+    setp(p, p + available);
+}
+
+OutputBufferStreambuf::int_type OutputBufferStreambuf::overflow(int_type c)
+{
+    commit_put_area();
+    reset_put_area();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize OutputBufferStreambuf::xsputn(const char* str, std::streamsize length)
+{
+    if (length <= (epptr() - pptr()))
+    {
+        memcpy(pptr(), str, length);
+        pbump(length);
+    }
+    else
+    {
+        commit_put_area();
+        _buffer.append(str, length);
+        setp(NULL, NULL);
+    }
+
+    return length;
+}
+
+int OutputBufferStreambuf::sync()
+{
+    commit_put_area();
+    if (!_buffer.flush())
+        return -1;
+
+    // Flushing may have reused the memory of the put area
+    setp(NULL, NULL);
+    return 0;
+}
+
+OutputBufferStreambuf::pos_type OutputBufferStreambuf::seekoff(off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which)
+{
+    // Only tellp is supported
+    if (off != 0
+            || dir != std::ios_base::cur
+            || !(which & std::ios_base::out))
+        return pos_type(off_type(-1));
+
+    return pos_type(off_type(_buffer.size() + (pptr() - pbase())));
+}
+
+}
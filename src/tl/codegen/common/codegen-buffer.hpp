@@ -0,0 +1,138 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef CODEGEN_BUFFER_HPP
+#define CODEGEN_BUFFER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+
+namespace Codegen
+{
+    //! Append-only buffer made of fixed size chunks
+    /*!
+     * Growing never moves what has already been written, unlike std::string
+     * or std::stringstream. Chunks are kept by clear, so a buffer that is
+     * reused stops allocating once it reaches its largest size.
+     *
+     * If a sink file is given every full chunk is written to it and reused,
+     * so the buffer only holds the last chunk_size bytes.
+     */
+    class OutputBuffer
+    {
+        public:
+            static const size_t chunk_size = 64 * 1024;
+
+        private:
+            struct Chunk
+            {
+                char* data;
+                size_t capacity;
+                size_t used;
+            };
+
+            std::vector<Chunk> _chunks;
+            // Chunk currently being filled
+            size_t _current;
+            // Bytes appended since the last clear, including flushed ones
+            size_t _size;
+
+            FILE* _sink;
+            bool _sink_failed;
+
+            void next_chunk(size_t min_capacity);
+
+            // Not copyable
+            OutputBuffer(const OutputBuffer&);
+            OutputBuffer& operator=(const OutputBuffer&);
+
+        public:
+            OutputBuffer();
+            explicit OutputBuffer(FILE* sink);
+            ~OutputBuffer();
+
+            void append(const char* str, size_t length);
+            void append(const std::string& str) { append(str.data(), str.size()); }
+            void append(char c) { append(&c, 1); }
+
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+            //! Discards the contents but keeps the allocated chunks
+            void clear();
+
+            //! Writes the pending contents to the sink file
+            /*!
+             * Returns false if writing to the sink has failed at any point
+             */
+            bool flush();
+
+            // These are only valid without a sink file
+            std::string str() const;
+            void write_range(std::ostream& out, size_t begin, size_t end) const;
+            void write(std::ostream& out) const { write_range(out, 0, _size); }
+            bool write(FILE* out) const;
+
+            //! Returns free space in the current chunk, allocating if there is none
+            /*!
+             * Use commit to append what has been written there. Used by
+             * OutputBufferStreambuf to write directly into the chunks
+             */
+            char* reserve(size_t& available);
+            void commit(size_t length);
+    };
+
+    //! Adaptor to emit into an OutputBuffer through an std::ostream
+    /*!
+     * The put area of this streambuf is the free space of the current chunk
+     * of the buffer, so characters are written in place. Do not append to
+     * the buffer directly while this streambuf has not been synchronized.
+     */
+    class OutputBufferStreambuf : public std::streambuf
+    {
+        private:
+            OutputBuffer& _buffer;
+
+            void commit_put_area();
+            void reset_put_area();
+
+        protected:
+            virtual int_type overflow(int_type c);
+            virtual std::streamsize xsputn(const char* str, std::streamsize length);
+            virtual int sync();
+            virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                    std::ios_base::openmode which = std::ios_base::out);
+
+        public:
+            OutputBufferStreambuf(OutputBuffer& buffer);
+            virtual ~OutputBufferStreambuf();
+    };
+}
+
+#endif // CODEGEN_BUFFER_HPP
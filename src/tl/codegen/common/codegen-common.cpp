@@ -25,18 +25,511 @@
 --------------------------------------------------------------------*/
 
 #include "codegen-common.hpp"
+#include "cxx-driver-utils.h"
+#include "fortran03-split.h"
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <map>
+#include <algorithm>
 
-// This is a g++ extension
-#include <ext/stdio_filebuf.h>
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+#include <signal.h>
+#include <sys/wait.h>
+#endif
 
 namespace Codegen
 {
 
+// Bookkeeping of a parallel codegen of the top level
+//
+// Every worker is a child process forked right before emitting the top level
+// list. Parent and workers run the same sequence of prologues and dependent
+// definitions, so they go through the same codegen states, but only workers
+// emit bodies: the k-th independent definition is emitted by worker
+// k % num_workers. The parent records where every body goes in its output and
+// merges them once all the workers have finished.
+//
+// Diagnostics are held back until the merge: the parent captures its own
+// stderr and workers send what bodies write to stderr along with them. They
+// are replayed in the order of a sequential codegen if the merge succeeds and
+// dropped otherwise, since the sequential codegen will emit them again. If the
+// parent exits or is killed before the merge, what it has held back is
+// written to stderr right away.
+struct CodegenVisitor::ParallelTopLevel
+{
+    int num_workers;
+    std::vector<pid_t> workers;
+    std::vector<FILE*> result_files;
+
+    // Offsets of the parent output where bodies go
+    std::vector<std::streamoff> body_offsets;
+
+    // Captured stderr of the parent and offsets in it where diagnostics of
+    // bodies go
+    FILE* diagnostics;
+    std::vector<off_t> diagnostic_offsets;
+
+    ParallelTopLevel(int n, FILE* diagnostics_)
+        : num_workers(n), workers(), result_files(), body_offsets(),
+        diagnostics(diagnostics_), diagnostic_offsets() { }
+
+    // Writes to out the parent output with the bodies in place and to
+    // stderr the diagnostics. Returns false if any worker failed, nothing
+    // is written in that case
+    bool merge(const OutputBuffer& parent_output, std::ostream& out);
+};
+
+// Bytes emitted and time taken by the codegen of a file, per nodecl kind and
+// per locus. Both are exclusive: a node is only accounted what it emits and
+// takes itself, not what its children do.
+//
+// Only nodes emitted directly into the output stream are accounted. Nodes
+// emitted into temporary streams are accounted to the node that copies them
+// into the output. What is emitted outside of every node is reported apart,
+// so the bytes reported add up to the size of the output
+struct CodegenVisitor::CodegenStats
+{
+    struct Entry
+    {
+        size_t bytes;
+        double time_us;
+        size_t num_nodes;
+
+        Entry()
+            : bytes(0), time_us(0), num_nodes(0) { }
+    };
+
+    struct Frame
+    {
+        std::streamoff start_offset;
+        double start_us;
+        size_t children_bytes;
+        double children_us;
+    };
+
+    typedef std::pair<const char*, unsigned int> locus_key_t;
+
+    std::ostream* out;
+    std::streamoff start_offset;
+    std::map<node_t, Entry> kinds;
+    std::map<locus_key_t, Entry> loci;
+    std::vector<Frame> frames;
+
+    CodegenStats(std::ostream* out_)
+        : out(out_), start_offset(out_->tellp()), kinds(), loci(), frames() { }
+
+    static double now_us()
+    {
+        struct timespec tp;
+        clock_gettime(CLOCK_MONOTONIC, &tp);
+        return tp.tv_sec * 1e6 + tp.tv_nsec / 1e3;
+    }
+
+    void enter()
+    {
+        Frame frame;
+        frame.start_offset = out->tellp();
+        frame.children_bytes = 0;
+        frame.children_us = 0;
+        frame.start_us = now_us();
+
+        frames.push_back(frame);
+    }
+
+    void leave(const Nodecl::NodeclBase& n)
+    {
+        double end_us = now_us();
+        std::streamoff end_offset = out->tellp();
+
+        Frame frame = frames.back();
+        frames.pop_back();
+
+        size_t bytes = 0;
+        if (frame.start_offset >= 0
+                && end_offset >= frame.start_offset)
+            bytes = end_offset - frame.start_offset;
+        double time_us = end_us - frame.start_us;
+
+        if (!frames.empty())
+        {
+            frames.back().children_bytes += bytes;
+            frames.back().children_us += time_us;
+        }
+
+        size_t self_bytes = (bytes > frame.children_bytes) ? bytes - frame.children_bytes : 0;
+        double self_us = (time_us > frame.children_us) ? time_us - frame.children_us : 0;
+
+        const locus_t* locus = nodecl_get_locus(n.get_internal_nodecl());
+        locus_key_t locus_key(locus != NULL ? locus_get_filename(locus) : NULL,
+                locus != NULL ? locus_get_line(locus) : 0);
+
+        Entry* entries[] = { &kinds[n.get_kind()], &loci[locus_key] };
+        for (unsigned int i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+        {
+            entries[i]->bytes += self_bytes;
+            entries[i]->time_us += self_us;
+            entries[i]->num_nodes++;
+        }
+    }
+
+    template <typename Key>
+    static bool more_bytes(const std::pair<Key, Entry>& a, const std::pair<Key, Entry>& b)
+    {
+        return a.second.bytes > b.second.bytes;
+    }
+
+    template <typename Key>
+    static void print_top(const char* title, const std::map<Key, Entry>& entries,
+            std::string (*key_name)(const Key&),
+            unsigned int num_top, const Entry& total)
+    {
+        std::vector<std::pair<Key, Entry> > sorted(entries.begin(), entries.end());
+        std::stable_sort(sorted.begin(), sorted.end(), more_bytes<Key>);
+
+        fprintf(stderr, "\nTop %s by bytes emitted\n\n", title);
+        fprintf(stderr, "%12s %6s %10s %6s %10s  %s\n",
+                "Bytes", "%", "Time (s)", "%", "Nodes", title);
+        for (unsigned int i = 0; i < sorted.size() && i < num_top; i++)
+        {
+            const Entry& e = sorted[i].second;
+            fprintf(stderr, "%12zu %6.2f %10.3f %6.2f %10zu  %s\n",
+                    e.bytes,
+                    total.bytes > 0 ? 100.0 * e.bytes / total.bytes : 0.0,
+                    e.time_us / 1e6,
+                    total.time_us > 0 ? 100.0 * e.time_us / total.time_us : 0.0,
+                    e.num_nodes,
+                    key_name(sorted[i].first).c_str());
+        }
+    }
+
+    static std::string kind_name(const node_t& kind)
+    {
+        return ast_print_node_type(kind);
+    }
+
+    static std::string locus_name(const locus_key_t& locus)
+    {
+        if (locus.first == NULL)
+            return "<unknown locus>";
+
+        std::stringstream ss;
+        ss << locus.first << ":" << locus.second;
+        return ss.str();
+    }
+
+    void report(const std::string& output_filename, unsigned int num_top) const
+    {
+        Entry total;
+        for (std::map<node_t, Entry>::const_iterator it = kinds.begin();
+                it != kinds.end();
+                it++)
+        {
+            total.bytes += it->second.bytes;
+            total.time_us += it->second.time_us;
+            total.num_nodes += it->second.num_nodes;
+        }
+
+        size_t outside_bytes = 0;
+        std::streamoff end_offset = out->tellp();
+        if (start_offset >= 0
+                && end_offset - start_offset >= (std::streamoff)total.bytes)
+        {
+            outside_bytes = (end_offset - start_offset) - total.bytes;
+            total.bytes += outside_bytes;
+        }
+
+        fprintf(stderr, "\nCodegen statistics of '%s': %zu bytes, %.3f s, %zu nodes\n",
+                output_filename.c_str(), total.bytes, total.time_us / 1e6, total.num_nodes);
+        fprintf(stderr, "Bytes emitted outside of any node: %zu\n", outside_bytes);
+
+        print_top("nodecl kinds", kinds, kind_name, num_top, total);
+        print_top("loci", loci, locus_name, num_top, total);
+        fprintf(stderr, "\n");
+    }
+};
+
+namespace
+{
+    // Used by workers to run prologues and dependent definitions
+    class NullStreambuf : public std::streambuf
+    {
+        protected:
+            virtual int_type overflow(int_type c) { return traits_type::not_eof(c); }
+            virtual std::streamsize xsputn(const char*, std::streamsize n) { return n; }
+    };
+
+    // Redirects stderr to fd while in scope. Nothing is done if fd is negative
+    class RedirectStderr
+    {
+        private:
+            int _saved_stderr;
+        public:
+            RedirectStderr(int fd)
+                : _saved_stderr(-1)
+            {
+                if (fd < 0)
+                    return;
+
+                fflush(stderr);
+                _saved_stderr = ::dup(2);
+                ::dup2(fd, 2);
+            }
+
+            ~RedirectStderr()
+            {
+                if (_saved_stderr < 0)
+                    return;
+
+                fflush(stderr);
+                ::dup2(_saved_stderr, 2);
+                ::close(_saved_stderr);
+            }
+    };
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // While the parent holds back its diagnostics, the real stderr and the
+    // temporary file where they go. If the parent exits or is killed before
+    // the merge, e.g. by a fatal_error, what was held back is written to the
+    // real stderr so the error is not lost
+    int held_stderr = -1;
+    int held_diagnostics = -1;
+
+    const int held_signals[] = { SIGSEGV, SIGBUS, SIGABRT, SIGTERM, SIGINT, SIGQUIT };
+    const int num_held_signals = sizeof(held_signals) / sizeof(held_signals[0]);
+    struct sigaction previous_actions[num_held_signals];
+
+    // Only uses async-signal-safe functions
+    void release_held_diagnostics()
+    {
+        if (held_stderr < 0)
+            return;
+
+        ::dup2(held_stderr, 2);
+        ::close(held_stderr);
+        held_stderr = -1;
+
+        char buffer[4096];
+        off_t offset = 0;
+        ssize_t length;
+        while ((length = ::pread(held_diagnostics, buffer, sizeof(buffer), offset)) > 0
+                && ::write(2, buffer, length) == length)
+        {
+            offset += length;
+        }
+    }
+
+    void restore_held_signals()
+    {
+        for (int i = 0; i < num_held_signals; i++)
+        {
+            ::sigaction(held_signals[i], &previous_actions[i], NULL);
+        }
+    }
+
+    void release_held_diagnostics_at_exit()
+    {
+        fflush(stderr);
+        release_held_diagnostics();
+    }
+
+    void release_held_diagnostics_at_signal(int sig)
+    {
+        release_held_diagnostics();
+        restore_held_signals();
+        ::raise(sig);
+    }
+
+    // Holds back what is written to stderr in fd while in scope
+    class HoldStderr
+    {
+        public:
+            HoldStderr(int fd)
+            {
+                static bool at_exit_registered = false;
+                if (!at_exit_registered)
+                {
+                    ::atexit(release_held_diagnostics_at_exit);
+                    at_exit_registered = true;
+                }
+
+                fflush(stderr);
+                held_diagnostics = fd;
+                held_stderr = ::dup(2);
+                ::dup2(fd, 2);
+
+                struct sigaction action;
+                std::memset(&action, 0, sizeof(action));
+                action.sa_handler = release_held_diagnostics_at_signal;
+                sigfillset(&action.sa_mask);
+                for (int i = 0; i < num_held_signals; i++)
+                {
+                    ::sigaction(held_signals[i], &action, &previous_actions[i]);
+                }
+            }
+
+            ~HoldStderr()
+            {
+                if (held_stderr < 0)
+                    return;
+
+                restore_held_signals();
+
+                fflush(stderr);
+                ::dup2(held_stderr, 2);
+                ::close(held_stderr);
+                held_stderr = -1;
+            }
+
+            // Used by forked workers. They send their diagnostics along with
+            // the bodies, and must not write to the file of the parent
+            static void forget()
+            {
+                if (held_stderr < 0)
+                    return;
+
+                restore_held_signals();
+
+                int null_fd = ::open("/dev/null", O_WRONLY);
+                if (null_fd >= 0)
+                {
+                    ::dup2(null_fd, 2);
+                    ::close(null_fd);
+                }
+                ::close(held_stderr);
+                held_stderr = -1;
+            }
+    };
+#endif
+
+    // Current offset of stderr, when redirected to a file
+    off_t stderr_offset()
+    {
+        fflush(stderr);
+        return ::lseek(2, 0, SEEK_CUR);
+    }
+
+    // Reads the range [start, end) of a file
+    bool read_range(int fd, off_t start, off_t end, std::string& result)
+    {
+        result.resize(end - start);
+        if (end == start)
+            return true;
+
+        return (start >= 0
+                && end > start
+                && ::pread(fd, &result[0], end - start, start) == end - start);
+    }
+}
+
+bool CodegenVisitor::ParallelTopLevel::merge(const OutputBuffer& parent_output, std::ostream& out)
+{
+    bool ok = true;
+    std::vector<std::string> bodies(body_offsets.size());
+    std::vector<std::string> body_diagnostics(body_offsets.size());
+    std::vector<bool> received(body_offsets.size(), false);
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    for (unsigned int i = 0; i < workers.size(); i++)
+    {
+        int status = 0;
+        if (::waitpid(workers[i], &status, 0) < 0
+                || !WIFEXITED(status)
+                || WEXITSTATUS(status) != 0)
+        {
+            ok = false;
+        }
+
+        FILE* f = result_files[i];
+        ::rewind(f);
+
+        unsigned int index = 0;
+        unsigned int length = 0;
+        while (ok
+                && fread(&index, sizeof(index), 1, f) == 1)
+        {
+            if (fread(&length, sizeof(length), 1, f) != 1
+                    || index >= bodies.size()
+                    || received[index])
+            {
+                ok = false;
+                break;
+            }
+
+            bodies[index].resize(length);
+            if (length > 0
+                    && fread(&bodies[index][0], length, 1, f) != 1)
+            {
+                ok = false;
+                break;
+            }
+
+            if (fread(&length, sizeof(length), 1, f) != 1)
+            {
+                ok = false;
+                break;
+            }
+            body_diagnostics[index].resize(length);
+            if (length > 0
+                    && fread(&body_diagnostics[index][0], length, 1, f) != 1)
+            {
+                ok = false;
+                break;
+            }
+            received[index] = true;
+        }
+
+        fclose(f);
+    }
+#endif
+
+    for (unsigned int i = 0; i < received.size() && ok; i++)
+    {
+        ok = received[i];
+    }
+
+    if (!ok)
+        return false;
+
+    // Diagnostics of the parent between bodies
+    std::vector<std::string> parent_diagnostics(body_offsets.size() + 1);
+    off_t previous_diagnostic = 0;
+    for (unsigned int i = 0; i < body_offsets.size() && ok; i++)
+    {
+        ok = read_range(fileno(diagnostics), previous_diagnostic, diagnostic_offsets[i],
+                parent_diagnostics[i]);
+        previous_diagnostic = diagnostic_offsets[i];
+    }
+    ok = ok && read_range(fileno(diagnostics), previous_diagnostic,
+            ::lseek(fileno(diagnostics), 0, SEEK_END),
+            parent_diagnostics[body_offsets.size()]);
+
+    if (!ok)
+        return false;
+
+    std::streamoff previous = 0;
+    for (unsigned int i = 0; i < body_offsets.size(); i++)
+    {
+        parent_output.write_range(out, previous, body_offsets[i]);
+        out << bodies[i];
+        previous = body_offsets[i];
+
+        fputs(parent_diagnostics[i].c_str(), stderr);
+        fputs(body_diagnostics[i].c_str(), stderr);
+    }
+    parent_output.write_range(out, previous, parent_output.size());
+    fputs(parent_diagnostics[body_offsets.size()].c_str(), stderr);
+
+    return true;
+}
+
 CodegenVisitor::CodegenVisitor()
-: _is_file_output(false), _last_is_newline(true), _current_line(1), file(NULL)
+: _is_file_output(false), _last_is_newline(true), _current_line(1),
+    _parallel_top_level(NULL), _str_buffer(), _codegen_to_str_depth(0),
+    _codegen_stats(NULL), file(NULL)
 {
 }
 
@@ -55,18 +548,39 @@ std::string CodegenVisitor::codegen_to_str(const Nodecl::NodeclBase& n, TL::Scop
     bool prev_line_markers = CURRENT_CONFIGURATION->line_markers;
     CURRENT_CONFIGURATION->line_markers = 0;
 
-    std::stringstream out;
+    // Nested calls cannot reuse the buffer of the outermost one
+    OutputBuffer nested_buffer;
+    OutputBuffer& buffer = (_codegen_to_str_depth == 0) ? _str_buffer : nested_buffer;
+    buffer.clear();
 
-    this->push_scope(sc);
-    this->codegen(n, &out);
-    this->pop_scope();
+    // What is emitted here is accounted to the node that uses it
+    CodegenStats* codegen_stats = _codegen_stats;
+    _codegen_stats = NULL;
+
+    std::string result;
+    {
+        OutputBufferStreambuf buffer_streambuf(buffer);
+        std::ostream out(&buffer_streambuf);
+
+        _codegen_to_str_depth++;
+        this->push_scope(sc);
+        this->codegen(n, &out);
+        this->pop_scope();
+        _codegen_to_str_depth--;
+
+        out.flush();
+        result = buffer.str();
+    }
+
+    _codegen_stats = codegen_stats;
 
     CURRENT_CONFIGURATION->line_markers = prev_line_markers;
 
-    return out.str();
+    return result;
 }
 
-void CodegenVisitor::codegen_top_level(const Nodecl::NodeclBase& n, FILE* f, const std::string& output_filename_)
+void CodegenVisitor::codegen_top_level(const Nodecl::NodeclBase& n, FILE* f, const std::string& output_filename_,
+        int output_column_width)
 {
     this->set_is_file_output(true);
     this->set_output_filename(output_filename_);
@@ -78,27 +592,389 @@ void CodegenVisitor::codegen_top_level(const Nodecl::NodeclBase& n, FILE* f, con
     ERROR_CONDITION((acc_mode != O_WRONLY) && (acc_mode != O_RDWR),
             "Invalid file descriptor: must be opened for read/write or write", 0);
 
-    // g++ extension
-    __gnu_cxx::stdio_filebuf<char> filebuf(f, std::ios::out | std::ios::app);
+    OutputBuffer file_buffer(f);
+    OutputBufferStreambuf file_streambuf(file_buffer);
+
+    // Long lines are split on the fly, this way the output is not read
+    // back to split them
+    std::streambuf* split_streambuf = NULL;
+    if (output_column_width != 0)
+        split_streambuf = new FortranSplitStreambuf(&file_streambuf, output_column_width);
+
+    std::streambuf& filebuf = (split_streambuf != NULL) ? *split_streambuf : file_streambuf;
+
+    FILE* diagnostics = NULL;
 
     if (CURRENT_CONFIGURATION->line_markers)
     {
         CodegenStreambuf<char> codegen_streambuf(&filebuf, this);
         std::ostream out(&codegen_streambuf);
 
-        this->codegen(n, &out);
+        this->codegen_file(n, &out);
     }
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    else if (compilation_process.num_codegen_jobs > 1
+            && compilation_process.codegen_stats == 0
+            && (diagnostics = ::tmpfile()) != NULL)
+    {
+        // Line markers require knowing the current line and statistics
+        // are not gathered by workers, so both are only emitted
+        // sequentially
+        std::ostream out(&filebuf);
+
+        OutputBuffer parent_buffer;
+        OutputBufferStreambuf parent_streambuf(parent_buffer);
+        std::ostream parent_out(&parent_streambuf);
+        ParallelTopLevel parallel_top_level(compilation_process.num_codegen_jobs, diagnostics);
+
+        {
+            HoldStderr hold(fileno(diagnostics));
+
+            _parallel_top_level = &parallel_top_level;
+            this->codegen(n, &parent_out);
+            _parallel_top_level = NULL;
+            parent_out.flush();
+        }
+
+        bool merged = parallel_top_level.merge(parent_buffer, out);
+        fclose(diagnostics);
+
+        if (!merged)
+        {
+            // Some definition was not really independent, start again
+            if (CURRENT_CONFIGURATION->verbose)
+            {
+                fprintf(stderr, "Parallel codegen of '%s' failed, emitting it sequentially\n",
+                        output_filename_.c_str());
+            }
+            this->codegen_cleanup();
+            this->codegen(n, &out);
+        }
+    }
+#endif
     else
     {
         std::ostream out(&filebuf);
-        this->codegen(n, &out);
+        this->codegen_file(n, &out);
     }
 
+    // Emits the last line, if it has not been emitted yet
+    delete split_streambuf;
+
     this->pop_scope();
 
     this->set_is_file_output(false);
 }
 
+void CodegenVisitor::codegen_file(const Nodecl::NodeclBase& n, std::ostream* out)
+{
+    if (compilation_process.codegen_stats == 0)
+    {
+        this->codegen(n, out);
+        return;
+    }
+
+    CodegenStats codegen_stats(out);
+
+    _codegen_stats = &codegen_stats;
+    this->codegen(n, out);
+    _codegen_stats = NULL;
+
+    codegen_stats.report(output_filename, compilation_process.codegen_stats);
+}
+
+void CodegenVisitor::walk(const Nodecl::NodeclBase& n)
+{
+    if (_codegen_stats == NULL
+            || file != _codegen_stats->out
+            || n.is_null())
+    {
+        Nodecl::NodeclVisitor<void>::walk(n);
+        return;
+    }
+
+    if (n.is<Nodecl::List>())
+    {
+        // NodeclVisitor::walk would not come back here for the elements
+        Nodecl::List l = n.as<Nodecl::List>();
+        for (Nodecl::List::iterator it = l.begin();
+                it != l.end();
+                it++)
+        {
+            walk(*it);
+        }
+        return;
+    }
+
+    _codegen_stats->enter();
+    Nodecl::NodeclVisitor<void>::walk(n);
+    _codegen_stats->leave(n);
+}
+
+void CodegenVisitor::codegen_top_level_list(const Nodecl::NodeclBase& n)
+{
+    if (_parallel_top_level == NULL
+            || n.is_null())
+    {
+        walk(n);
+        return;
+    }
+
+    ParallelTopLevel& parallel = *_parallel_top_level;
+    // Nested top levels are emitted sequentially
+    _parallel_top_level = NULL;
+
+    Nodecl::List items = n.as<Nodecl::List>();
+
+    int num_function_codes = 0;
+    for (Nodecl::List::iterator it = items.begin();
+            it != items.end();
+            it++)
+    {
+        if (it->is<Nodecl::FunctionCode>())
+            num_function_codes++;
+    }
+
+    if (num_function_codes < 2)
+    {
+        // Not worth forking
+        walk(n);
+        _parallel_top_level = &parallel;
+        return;
+    }
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    file->flush();
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 0; i < parallel.num_workers; i++)
+    {
+        FILE* result_file = ::tmpfile();
+        pid_t pid = -1;
+        if (result_file != NULL)
+        {
+            pid = ::fork();
+        }
+
+        if (pid == 0)
+        {
+            codegen_top_level_list_in_worker(items, i, parallel.num_workers, result_file);
+            // Not reached
+        }
+        else if (pid < 0)
+        {
+            // Give up and let merge fail so everything is emitted sequentially
+            if (result_file != NULL)
+                fclose(result_file);
+
+            for (unsigned int j = 0; j < parallel.workers.size(); j++)
+            {
+                ::kill(parallel.workers[j], SIGKILL);
+            }
+            break;
+        }
+
+        parallel.workers.push_back(pid);
+        parallel.result_files.push_back(result_file);
+    }
+#endif
+
+    for (Nodecl::List::iterator it = items.begin();
+            it != items.end();
+            it++)
+    {
+        if (this->is_independent_definition(*it))
+        {
+            this->codegen_definition_prologue(*it);
+            parallel.body_offsets.push_back(file->tellp());
+            parallel.diagnostic_offsets.push_back(stderr_offset());
+        }
+        else
+        {
+            walk(*it);
+        }
+    }
+
+    _parallel_top_level = &parallel;
+}
+
+void CodegenVisitor::codegen_top_level_list_in_worker(const Nodecl::List& items,
+        int worker, int num_workers, FILE* result_file)
+{
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // Temporal files registered so far belong to the parent, and so do
+    // the diagnostics it holds back
+    temporal_files_detach();
+    HoldStderr::forget();
+
+    // Used to test the sequential fallback
+    if (debug_options.codegen_jobs_fail)
+        ::_exit(1);
+
+    NullStreambuf null_buf;
+    std::ostream null_out(&null_buf);
+
+    // Workers only report what happens in their bodies, otherwise messages
+    // of prologues would be repeated by every process
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    FILE* diagnostics = ::tmpfile();
+    if (null_fd < 0
+            || diagnostics == NULL)
+        ::_exit(1);
+
+    int status = 0;
+    unsigned int index = 0;
+    for (Nodecl::List::iterator it = items.begin();
+            it != items.end() && status == 0;
+            it++)
+    {
+        if (this->is_independent_definition(*it))
+        {
+            {
+                RedirectStderr silence(null_fd);
+                file = &null_out;
+                this->codegen_definition_prologue(*it);
+            }
+
+            if ((index % num_workers) == (unsigned int)worker)
+            {
+                OutputBuffer body;
+                OutputBufferStreambuf body_streambuf(body);
+                std::ostream body_out(&body_streambuf);
+                file = &body_out;
+
+                off_t diagnostics_start, diagnostics_end;
+                {
+                    RedirectStderr capture(fileno(diagnostics));
+                    diagnostics_start = stderr_offset();
+
+                    if (!this->codegen_definition_body(*it))
+                    {
+                        status = 1;
+                        break;
+                    }
+                    body_out.flush();
+
+                    diagnostics_end = stderr_offset();
+                }
+
+                std::string body_diagnostics;
+                unsigned int length = body.size();
+                if (!read_range(fileno(diagnostics), diagnostics_start, diagnostics_end,
+                            body_diagnostics)
+                        || fwrite(&index, sizeof(index), 1, result_file) != 1
+                        || fwrite(&length, sizeof(length), 1, result_file) != 1
+                        || !body.write(result_file))
+                {
+                    status = 1;
+                    break;
+                }
+
+                length = body_diagnostics.size();
+                if (fwrite(&length, sizeof(length), 1, result_file) != 1
+                        || (length > 0
+                            && fwrite(&body_diagnostics[0], length, 1, result_file) != 1))
+                {
+                    status = 1;
+                }
+            }
+            index++;
+        }
+        else
+        {
+            RedirectStderr silence(null_fd);
+            file = &null_out;
+            walk(*it);
+        }
+    }
+
+    if (fflush(result_file) != 0)
+        status = 1;
+
+    // Do not run any cleanup of the parent
+    ::_exit(status);
+#endif
+}
+
+FortranSplitStreambuf::FortranSplitStreambuf(std::streambuf* sb, int width)
+    : _sb(sb), _width(width), _line(), _num_bytes(0)
+{
+}
+
+FortranSplitStreambuf::~FortranSplitStreambuf()
+{
+    if (!_line.empty())
+        split_line();
+    _sb->pubsync();
+}
+
+void FortranSplitStreambuf::write_to_streambuf(const char* str, size_t length, void* data)
+{
+    std::streambuf* sb = reinterpret_cast<std::streambuf*>(data);
+    sb->sputn(str, length);
+}
+
+void FortranSplitStreambuf::split_line()
+{
+    // fortran_split_line modifies the line in place
+    fortran_split_line(&_line[0], _width, write_to_streambuf, _sb);
+    _line.clear();
+}
+
+FortranSplitStreambuf::int_type FortranSplitStreambuf::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+
+    _line += traits_type::to_char_type(c);
+    _num_bytes++;
+    if (c == '\n')
+        split_line();
+
+    return c;
+}
+
+std::streamsize FortranSplitStreambuf::xsputn(const char* str, std::streamsize length)
+{
+    _num_bytes += length;
+
+    const char* end = str + length;
+    while (str != end)
+    {
+        const char* newline = static_cast<const char*>(::memchr(str, '\n', end - str));
+        if (newline == NULL)
+        {
+            _line.append(str, end - str);
+            break;
+        }
+
+        _line.append(str, newline + 1 - str);
+        split_line();
+        str = newline + 1;
+    }
+
+    return length;
+}
+
+int FortranSplitStreambuf::sync()
+{
+    // An incomplete line cannot be split yet
+    return _sb->pubsync();
+}
+
+FortranSplitStreambuf::pos_type FortranSplitStreambuf::seekoff(off_type off,
+        std::ios_base::seekdir dir,
+        std::ios_base::openmode which)
+{
+    if (off != 0
+            || dir != std::ios_base::cur
+            || !(which & std::ios_base::out))
+        return pos_type(off_type(-1));
+
+    return pos_type(_num_bytes);
+}
+
 CodegenVisitor::Ret CodegenVisitor::unhandled_node(const Nodecl::NodeclBase & n)
 { 
     internal_error("Unhandled node %s\n", ast_print_node_type(n.get_kind()));
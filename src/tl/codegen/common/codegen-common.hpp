@@ -28,6 +28,7 @@
 #define CODEGEN_COMMON_HPP
 
 #include "tl-nodecl-visitor.hpp"
+#include "codegen-buffer.hpp"
 #include <string>
 #include <cstdio>
 #include <sstream>
@@ -50,12 +51,51 @@ namespace Codegen
             bool _is_file_output;
             bool _last_is_newline;
             int _current_line;
+
+            struct ParallelTopLevel;
+            ParallelTopLevel* _parallel_top_level;
+
+            // Reused by the outermost codegen_to_str so it does not
+            // allocate once it has grown enough
+            OutputBuffer _str_buffer;
+            int _codegen_to_str_depth;
+
+            // Only set while emitting a file with --codegen-stats
+            struct CodegenStats;
+            CodegenStats* _codegen_stats;
+
+            // Emits the file n into out, gathering statistics if requested
+            void codegen_file(const Nodecl::NodeclBase& n, std::ostream* out);
+
+            void codegen_top_level_list_in_worker(const Nodecl::List& items,
+                    int worker, int num_workers, FILE* result_file);
         protected:
             std::ostream *file;
             std::string output_filename;
             virtual void codegen(const Nodecl::NodeclBase&, std::ostream *out) = 0;
             virtual void codegen_cleanup() = 0;
 
+            // Parallel codegen of top level definitions
+            //
+            // An independent definition is emitted in two steps. The
+            // prologue emits everything the definition requires and updates
+            // the codegen state as if the definition had been emitted. The
+            // body emits the definition itself and only changes state local
+            // to it, so bodies can be emitted by other processes.
+
+            //! States whether \a n can be emitted by another process
+            virtual bool is_independent_definition(const Nodecl::NodeclBase& n) { return false; }
+            //! Emits everything required by the independent definition \a n
+            virtual void codegen_definition_prologue(const Nodecl::NodeclBase& n) { }
+            //! Emits the independent definition \a n after its prologue
+            /*!
+             * Returns false if emitting it changed state not local to \a n
+             */
+            virtual bool codegen_definition_body(const Nodecl::NodeclBase& n) { return false; }
+
+            //! Emits the top level list \a n, in parallel if it has been enabled
+            void codegen_top_level_list(const Nodecl::NodeclBase& n);
+
         public:
             CodegenVisitor();
 
@@ -71,9 +111,23 @@ namespace Codegen
             int get_current_line() const { return _current_line; }
             void set_current_line(int n) { _current_line = n; }
 
-            void codegen_top_level(const Nodecl::NodeclBase& n, FILE* f, const std::string& output_filename);
+            //! Emits \a n into \a f
+            /*!
+             * If \a output_column_width is not zero, Fortran lines longer than
+             * it are split
+             */
+            void codegen_top_level(const Nodecl::NodeclBase& n, FILE* f, const std::string& output_filename,
+                    int output_column_width = 0);
             std::string codegen_to_str(const Nodecl::NodeclBase& n, TL::Scope sc);
 
+            //! Walks \a n accounting the bytes it emits and the time it takes
+            /*!
+             * This hides NodeclVisitor::walk. Accounting is only done when
+             * emitting a file with --codegen-stats, otherwise this is
+             * NodeclVisitor::walk
+             */
+            void walk(const Nodecl::NodeclBase& n);
+
             virtual Ret unhandled_node(const Nodecl::NodeclBase & n);
 
             virtual void push_scope(TL::Scope sc) { }
@@ -109,10 +163,52 @@ namespace Codegen
                 return _sb->pubsync();
             }
 
+            // Only tellp is supported
+            virtual typename traits::pos_type seekoff(typename traits::off_type off,
+                    std::ios_base::seekdir dir,
+                    std::ios_base::openmode which = std::ios_base::out)
+            {
+                if (off != 0
+                        || dir != std::ios_base::cur)
+                    return typename traits::pos_type(typename traits::off_type(-1));
+
+                return _sb->pubseekoff(off, dir, which);
+            }
+
         private:
             std::basic_streambuf<char_type, traits> * _sb;
             CodegenVisitor* _v;
     };
+
+    //! Splits the Fortran lines longer than a width while they are emitted
+    /*!
+     * Lines are passed to the next streambuf once they are complete. The
+     * last line, if it does not end with a newline, is passed when this
+     * streambuf is destroyed
+     */
+    class FortranSplitStreambuf : public std::streambuf
+    {
+        public:
+            FortranSplitStreambuf(std::streambuf* sb, int width);
+            virtual ~FortranSplitStreambuf();
+
+        private:
+            virtual int_type overflow(int_type c);
+            virtual std::streamsize xsputn(const char* str, std::streamsize length);
+            virtual int sync();
+            // Only tellp is supported, it returns the bytes before splitting
+            virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                    std::ios_base::openmode which = std::ios_base::out);
+
+            void split_line();
+
+            static void write_to_streambuf(const char* str, size_t length, void* data);
+
+            std::streambuf* _sb;
+            int _width;
+            std::string _line;
+            std::streamoff _num_bytes;
+    };
 }
 
 #endif // CODEGEN_COMMON_HPP
@@ -38,7 +38,13 @@ namespace Codegen
 
         Nodecl::NodeclBase n = *std::static_pointer_cast<Nodecl::NodeclBase>(dto["nodecl"]);
 
-        this->codegen_top_level(n, f, output_filename_);
+        int output_column_width = 0;
+        std::shared_ptr<TL::Integer> output_column_width_p
+            = std::dynamic_pointer_cast<TL::Integer>(dto["output_column_width"]);
+        if (output_column_width_p)
+            output_column_width = *output_column_width_p;
+
+        this->codegen_top_level(n, f, output_filename_, output_column_width);
     }
     void CodegenPhase::handle_parameter(int n, void* data)
     {}
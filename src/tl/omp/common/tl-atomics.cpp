@@ -27,6 +27,7 @@
 #include"tl-atomics.hpp"
 #include"tl-nodecl-utils.hpp"
 #include"tl-counters.hpp"
+#include"tl-source-template.hpp"
 
 namespace TL {
 
@@ -373,7 +374,6 @@ namespace TL {
     Nodecl::NodeclBase builtin_atomic_int_op(Nodecl::NodeclBase expr)
     {
         node_t op_kind = expr.get_kind();
-        Source critical_source;
         if (op_kind == NODECL_PREINCREMENT  // ++x
                 || op_kind == NODECL_POSTINCREMENT // x++
                 || op_kind == NODECL_PREDECREMENT // --x
@@ -404,8 +404,15 @@ namespace TL {
             Source op_size;
             op_size << expr.as<Nodecl::Preincrement>().get_rhs().get_type().no_ref().get_size();
 
-            critical_source << intrinsic_function_name << "_" << op_size << "(&(" << as_expression(expr.as<Nodecl::Preincrement>().get_rhs()) << "), 1);"
-                ;
+            // Only the builtin changes between atomic constructs, so each
+            // pattern is parsed once per translation unit
+            SourceTemplate atomic_op(SourceTemplate::STATEMENT,
+                    intrinsic_function_name + "_" + op_size.get_source()
+                    + "(&(" + SourceTemplate::hole("lhs") + "), 1);");
+
+            return atomic_op.instantiate(expr,
+                    SourceTemplateArgs()
+                    .expression("lhs", expr.as<Nodecl::Preincrement>().get_rhs()));
         }
         // No need to check the other case as allowed_expression_atomic
         // already did this for us
@@ -470,15 +477,18 @@ namespace TL {
             Source op_size;
             op_size << expr.as<Nodecl::AddAssignment>().get_rhs().get_type().no_ref().get_size();
 
-            critical_source
-                << "{"
-                << as_type(expr.as<Nodecl::AddAssignment>().get_rhs().get_type()) << "__tmp = "
-                << as_expression(expr.as<Nodecl::AddAssignment>().get_rhs()) << ";"
-                << intrinsic_function_name << "_" << op_size << "(&(" << as_expression(expr.as<Nodecl::AddAssignment>().get_lhs()) << "), __tmp);"
-                << "}"
-                ;
+            SourceTemplate atomic_op(SourceTemplate::STATEMENT,
+                    "{"
+                    + SourceTemplate::hole("type") + " __tmp = " + SourceTemplate::hole("rhs") + ";"
+                    + intrinsic_function_name + "_" + op_size.get_source()
+                    + "(&(" + SourceTemplate::hole("lhs") + "), __tmp);"
+                    + "}");
+
+            return atomic_op.instantiate(expr,
+                    SourceTemplateArgs()
+                    .type("type", expr.as<Nodecl::AddAssignment>().get_rhs().get_type())
+                    .expression("rhs", expr.as<Nodecl::AddAssignment>().get_rhs())
+                    .expression("lhs", expr.as<Nodecl::AddAssignment>().get_lhs()));
         }
-
-        return critical_source.parse_statement(expr);
     }
 }
@@ -778,6 +778,15 @@ namespace Nodecl
         }
         */
 
+        // Different cached hashes mean different trees
+        if (!nodecl_is_null(n1_) && !nodecl_is_null(n2_))
+        {
+            unsigned int h1 = ast_get_structural_hash(nodecl_get_ast(n1_));
+            unsigned int h2 = ast_get_structural_hash(nodecl_get_ast(n2_));
+            if (h1 != 0 && h2 != 0 && h1 != h2)
+                return false;
+        }
+
         bool equals = equal_trees_rec(n1_, n2_, skip_conversion_nodecls);
         return equals;
     }
@@ -813,6 +822,16 @@ namespace Nodecl
         return structurally_less_nodecls(n1, n2, /*skip_conversion_nodes*/true);
     }
 
+    size_t Utils::Nodecl_structural_hash::operator() (const Nodecl::NodeclBase& n) const
+    {
+        return nodecl_structural_hash(n.get_internal_nodecl());
+    }
+
+    bool Utils::Nodecl_structural_equal_skip_conv::operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const
+    {
+        return structurally_equal_nodecls(n1, n2, /*skip_conversion_nodes*/true);
+    }
+
     Nodecl::List Utils::get_all_list_from_list_node(Nodecl::List n)
     {
         while (n.get_parent().is<Nodecl::List>())
@@ -88,6 +88,19 @@ namespace Utils {
         bool operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const;
     };
 
+    // Hash-based containers of nodecls. The hash is cached in the nodes,
+    // so hashing a tree again is O(1) until the tree is modified. It
+    // depends on symbol addresses, so iteration order is not stable
+    // across runs
+    struct Nodecl_structural_hash {
+        size_t operator() (const Nodecl::NodeclBase& n) const;
+    };
+
+    // Same equivalence as Nodecl_structural_less
+    struct Nodecl_structural_equal_skip_conv {
+        bool operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const;
+    };
+
     // Basic replacement
     //
     // After this operation dest will be updated to have the same contents
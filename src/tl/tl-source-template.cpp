@@ -0,0 +1,557 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#include "tl-source-template.hpp"
+#include "tl-nodecl-utils.hpp"
+#include "tl-scope.hpp"
+
+#include "cxx-utils.h"
+#include "cxx-scope.h"
+#include "cxx-nodecl.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace TL
+{
+    SourceTemplateArgs& SourceTemplateArgs::add(const std::string& name, const Argument& arg)
+    {
+        if (_args.find(name) != _args.end())
+        {
+            internal_error("Hole '%s' has already been given an argument", name.c_str());
+        }
+        _args[name] = arg;
+        return *this;
+    }
+
+    SourceTemplateArgs& SourceTemplateArgs::expression(const std::string& name, Nodecl::NodeclBase n)
+    {
+        ERROR_CONDITION(n.is_null(), "Invalid null expression for hole '%s'", name.c_str());
+
+        Argument arg;
+        arg.kind = HOLE_EXPRESSION;
+        arg.tree = n;
+        arg.type = n.get_type();
+        ERROR_CONDITION(!arg.type.is_valid(), "Expression for hole '%s' has no type", name.c_str());
+
+        return add(name, arg);
+    }
+
+    SourceTemplateArgs& SourceTemplateArgs::symbol(const std::string& name, TL::Symbol s)
+    {
+        ERROR_CONDITION(!s.is_valid(), "Invalid symbol for hole '%s'", name.c_str());
+        ERROR_CONDITION(!(s.is_variable() || s.is_function())
+                || s.is_member(),
+                "Symbol '%s' for hole '%s' is not a nonmember variable or function",
+                s.get_name().c_str(), name.c_str());
+
+        Argument arg;
+        arg.kind = HOLE_SYMBOL;
+        arg.sym = s;
+        arg.type = s.get_type();
+
+        return add(name, arg);
+    }
+
+    SourceTemplateArgs& SourceTemplateArgs::statement(const std::string& name, Nodecl::NodeclBase n)
+    {
+        ERROR_CONDITION(n.is_null(), "Invalid null statement for hole '%s'", name.c_str());
+
+        Argument arg;
+        arg.kind = HOLE_STATEMENT;
+        arg.tree = n;
+
+        return add(name, arg);
+    }
+
+    SourceTemplateArgs& SourceTemplateArgs::type(const std::string& name, TL::Type t)
+    {
+        ERROR_CONDITION(!t.is_valid(), "Invalid type for hole '%s'", name.c_str());
+
+        Argument arg;
+        arg.kind = HOLE_TYPE;
+        arg.type = t;
+
+        return add(name, arg);
+    }
+
+    const SourceTemplateArgs::Argument& SourceTemplateArgs::get(const std::string& name) const
+    {
+        std::map<std::string, Argument>::const_iterator it = _args.find(name);
+        if (it == _args.end())
+        {
+            internal_error("No argument has been given for hole '%s'", name.c_str());
+        }
+        return it->second;
+    }
+
+    namespace
+    {
+        // The kind of every hole and the type it has been checked with.
+        // Two instantiations with the same signature can share the same
+        // compiled tree
+        struct HoleSignature
+        {
+            int kind;
+            int symbol_kind;
+            type_t* type;
+
+            bool operator<(const HoleSignature& h) const
+            {
+                if (kind != h.kind)
+                    return kind < h.kind;
+                if (symbol_kind != h.symbol_kind)
+                    return symbol_kind < h.symbol_kind;
+                return type < h.type;
+            }
+        };
+
+        struct TemplateKey
+        {
+            std::string pattern;
+            int kind;
+            int language;
+            // Trees and symbols of a translation unit cannot be used in another one
+            const scope_t* global_scope;
+            std::vector<HoleSignature> holes;
+
+            bool operator<(const TemplateKey& k) const
+            {
+                if (kind != k.kind)
+                    return kind < k.kind;
+                if (language != k.language)
+                    return language < k.language;
+                if (global_scope != k.global_scope)
+                    return global_scope < k.global_scope;
+                if (pattern != k.pattern)
+                    return pattern < k.pattern;
+                return holes < k.holes;
+            }
+        };
+
+        // Where a hole appears in the compiled tree, as a sequence of
+        // child indexes from the root
+        struct HoleSite
+        {
+            std::string name;
+            std::vector<int> path;
+        };
+    }
+
+    struct SourceTemplate::CompiledTemplate
+    {
+        Nodecl::NodeclBase tree;
+        std::vector<HoleSite> sites;
+    };
+
+    typedef std::map<TemplateKey, SourceTemplate::CompiledTemplate*> template_cache_t;
+    static template_cache_t _template_cache;
+
+    static unsigned int _template_cache_hits = 0;
+    static unsigned int _template_cache_misses = 0;
+
+    static const char* hole_prefix = "$(";
+    static const char* hole_suffix = ")";
+
+    SourceTemplate::SourceTemplate(Kind kind, const std::string& pattern)
+        : _kind(kind), _pattern(pattern), _segments(), _holes()
+    {
+        split_pattern();
+    }
+
+    std::string SourceTemplate::hole(const std::string& name)
+    {
+        ERROR_CONDITION(name.empty(), "Invalid empty hole name", 0);
+        for (std::string::const_iterator it = name.begin();
+                it != name.end();
+                it++)
+        {
+            ERROR_CONDITION(!isalnum(*it) && *it != '_',
+                    "Invalid hole name '%s'", name.c_str());
+        }
+
+        return hole_prefix + name + hole_suffix;
+    }
+
+    void SourceTemplate::split_pattern()
+    {
+        std::string::size_type current = 0;
+        while (current < _pattern.size())
+        {
+            std::string::size_type start = _pattern.find(hole_prefix, current);
+            if (start == std::string::npos)
+                break;
+
+            std::string::size_type name_start = start + strlen(hole_prefix);
+            std::string::size_type end = _pattern.find(hole_suffix, name_start);
+            ERROR_CONDITION(end == std::string::npos, "Unterminated hole in template pattern", 0);
+
+            Segment seg;
+            seg.text = _pattern.substr(current, start - current);
+            seg.hole = _pattern.substr(name_start, end - name_start);
+            ERROR_CONDITION(seg.hole.empty(), "Invalid empty hole in template pattern", 0);
+            _segments.push_back(seg);
+
+            if (std::find(_holes.begin(), _holes.end(), seg.hole) == _holes.end())
+            {
+                _holes.push_back(seg.hole);
+            }
+
+            current = end + strlen(hole_suffix);
+        }
+
+        if (current < _pattern.size())
+        {
+            Segment seg;
+            seg.text = _pattern.substr(current);
+            _segments.push_back(seg);
+        }
+    }
+
+    static void collect_hole_sites(nodecl_t n,
+            std::vector<int>& path,
+            const std::map<scope_entry_t*, std::string>& hole_symbols,
+            const std::map<scope_entry_t*, std::string>& hole_calls,
+            const std::map<AST, std::string>& hole_statements,
+            std::vector<HoleSite>& sites)
+    {
+        if (nodecl_is_null(n))
+            return;
+
+        std::string name;
+        if (nodecl_get_kind(n) == NODECL_FUNCTION_CALL
+                && nodecl_get_kind(nodecl_get_child(n, 0)) == NODECL_SYMBOL)
+        {
+            // The whole call stands for the argument
+            std::map<scope_entry_t*, std::string>::const_iterator it
+                = hole_calls.find(nodecl_get_symbol(nodecl_get_child(n, 0)));
+            if (it != hole_calls.end())
+                name = it->second;
+        }
+        else if (nodecl_get_kind(n) == NODECL_SYMBOL)
+        {
+            std::map<scope_entry_t*, std::string>::const_iterator it
+                = hole_symbols.find(nodecl_get_symbol(n));
+            if (it != hole_symbols.end())
+                name = it->second;
+        }
+        else
+        {
+            std::map<AST, std::string>::const_iterator it
+                = hole_statements.find(nodecl_get_ast(n));
+            if (it != hole_statements.end())
+                name = it->second;
+        }
+
+        if (!name.empty())
+        {
+            HoleSite site;
+            site.name = name;
+            site.path = path;
+            sites.push_back(site);
+            return;
+        }
+
+        for (int i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            path.push_back(i);
+            collect_hole_sites(nodecl_get_child(n, i), path, hole_symbols, hole_calls, hole_statements, sites);
+            path.pop_back();
+        }
+    }
+
+    SourceTemplate::CompiledTemplate* SourceTemplate::compile(ReferenceScope ref_scope,
+            const SourceTemplateArgs& args) const
+    {
+        // Placeholder variables live in a block scope of their own so they
+        // never clash with the names of the reference scope
+        Scope hole_scope(new_block_context(ref_scope.get_scope().get_decl_context()));
+
+        std::map<std::string, TL::Symbol> hole_vars;
+        // Holes written as a call to their placeholder function
+        std::map<std::string, TL::Symbol> hole_funcs;
+        std::map<std::string, Nodecl::NodeclBase> hole_placeholders;
+
+        Source src;
+        for (std::vector<Segment>::const_iterator it = _segments.begin();
+                it != _segments.end();
+                it++)
+        {
+            src << it->text;
+            if (it->hole.empty())
+                continue;
+
+            const SourceTemplateArgs::Argument& arg = args.get(it->hole);
+            switch (arg.kind)
+            {
+                case SourceTemplateArgs::HOLE_EXPRESSION:
+                case SourceTemplateArgs::HOLE_SYMBOL:
+                    {
+                        // The placeholder has the value category of the argument.
+                        // Lvalues (and symbols) are denoted by a variable but
+                        // prvalues and xvalues by a call to a function returning
+                        // them, so the pattern cannot assign them or take their
+                        // address. Fortran has no such distinction
+                        bool is_call = (arg.kind == SourceTemplateArgs::HOLE_EXPRESSION
+                                && !arg.type.is_lvalue_reference()
+                                && Source::source_language.get_language() != SourceLanguage::Fortran);
+
+                        std::map<std::string, TL::Symbol>& holes = is_call ? hole_funcs : hole_vars;
+                        std::map<std::string, TL::Symbol>::iterator var = holes.find(it->hole);
+                        if (var == holes.end())
+                        {
+                            // Fortran names are lowercase
+                            std::string name = "mcc_hole_" + it->hole;
+                            for (std::string::iterator c = name.begin(); c != name.end(); c++)
+                                *c = tolower(*c);
+
+                            scope_entry_t* entry = ::new_symbol(hole_scope.get_decl_context(),
+                                    hole_scope.get_decl_context()->current_scope,
+                                    uniquestr(name.c_str()));
+                            if (arg.kind == SourceTemplateArgs::HOLE_SYMBOL
+                                    && arg.sym.is_function())
+                            {
+                                entry->kind = SK_FUNCTION;
+                                entry->type_information = arg.type.get_internal_type();
+                            }
+                            else if (is_call)
+                            {
+                                entry->kind = SK_FUNCTION;
+                                entry->type_information = arg.type.get_function_returning(
+                                        TL::ObjectList<TL::Type>()).get_internal_type();
+                            }
+                            else
+                            {
+                                entry->kind = SK_VARIABLE;
+                                entry->type_information = arg.type.no_ref().get_internal_type();
+                            }
+                            entry->do_not_print = 1;
+                            entry->defined = 1;
+
+                            var = holes.insert(std::make_pair(it->hole, TL::Symbol(entry))).first;
+                        }
+                        src << var->second.get_name();
+                        if (is_call)
+                            src << "()";
+                        break;
+                    }
+                case SourceTemplateArgs::HOLE_STATEMENT:
+                    {
+                        if (hole_placeholders.find(it->hole) != hole_placeholders.end())
+                        {
+                            internal_error("Statement hole '%s' appears more than once in the pattern",
+                                    it->hole.c_str());
+                        }
+                        src << statement_placeholder(hole_placeholders[it->hole]);
+                        break;
+                    }
+                case SourceTemplateArgs::HOLE_TYPE:
+                    {
+                        src << as_type(arg.type);
+                        break;
+                    }
+                default:
+                    internal_error("Code unreachable", 0);
+            }
+        }
+
+        CompiledTemplate* compiled = new CompiledTemplate;
+        switch (_kind)
+        {
+            case EXPRESSION:
+                {
+                    ERROR_CONDITION(!hole_placeholders.empty(),
+                            "Statement holes are not valid in expression templates", 0);
+                    compiled->tree = src.parse_expression(hole_scope);
+                    break;
+                }
+            case STATEMENT:
+                {
+                    compiled->tree = src.parse_statement(hole_scope);
+                    break;
+                }
+            default:
+                internal_error("Code unreachable", 0);
+        }
+
+        // Entities declared in the hole scope would be shared by all the
+        // instantiations, deep copy only duplicates those of inner contexts.
+        // Placeholder variables are hidden
+        if (!hole_scope.get_all_symbols(/* include_hidden */ false).empty())
+        {
+            fatal_error("%s: error: statement template declares entities outside a compound statement\n\n%s\n",
+                    compiled->tree.get_locus_str().c_str(),
+                    Source::format_source(_pattern).c_str());
+        }
+
+        std::map<scope_entry_t*, std::string> hole_symbols;
+        for (std::map<std::string, TL::Symbol>::iterator it = hole_vars.begin();
+                it != hole_vars.end();
+                it++)
+        {
+            hole_symbols[it->second.get_internal_symbol()] = it->first;
+        }
+        std::map<scope_entry_t*, std::string> hole_calls;
+        for (std::map<std::string, TL::Symbol>::iterator it = hole_funcs.begin();
+                it != hole_funcs.end();
+                it++)
+        {
+            hole_calls[it->second.get_internal_symbol()] = it->first;
+        }
+        std::map<AST, std::string> hole_statements;
+        for (std::map<std::string, Nodecl::NodeclBase>::iterator it = hole_placeholders.begin();
+                it != hole_placeholders.end();
+                it++)
+        {
+            hole_statements[it->second.get_internal_nodecl().tree] = it->first;
+        }
+
+        std::vector<int> path;
+        collect_hole_sites(compiled->tree.get_internal_nodecl(),
+                path, hole_symbols, hole_calls, hole_statements, compiled->sites);
+
+        // Every hole not filled textually must have survived parsing
+        for (std::vector<std::string>::const_iterator it = _holes.begin();
+                it != _holes.end();
+                it++)
+        {
+            if (args.get(*it).kind == SourceTemplateArgs::HOLE_TYPE)
+                continue;
+
+            bool found = false;
+            for (std::vector<HoleSite>::iterator site = compiled->sites.begin();
+                    site != compiled->sites.end() && !found;
+                    site++)
+            {
+                found = (site->name == *it);
+            }
+            if (!found)
+            {
+                internal_error("Hole '%s' has not been preserved in the parsed template\n\n%s\n",
+                        it->c_str(),
+                        Source::format_source(_pattern).c_str());
+            }
+        }
+
+        return compiled;
+    }
+
+    Nodecl::NodeclBase SourceTemplate::instantiate(ReferenceScope ref_scope,
+            const SourceTemplateArgs& args) const
+    {
+        TemplateKey key;
+        key.pattern = _pattern;
+        key.kind = _kind;
+        key.language = Source::source_language.get_language();
+        key.global_scope = ref_scope.get_scope().get_decl_context()->global_scope;
+
+        for (std::vector<std::string>::const_iterator it = _holes.begin();
+                it != _holes.end();
+                it++)
+        {
+            const SourceTemplateArgs::Argument& arg = args.get(*it);
+
+            HoleSignature signature;
+            signature.kind = arg.kind;
+            signature.symbol_kind = arg.sym.is_valid() ? arg.sym.get_internal_symbol()->kind : 0;
+            signature.type = arg.type.get_internal_type();
+            key.holes.push_back(signature);
+        }
+
+        CompiledTemplate* compiled = NULL;
+        template_cache_t::iterator it_cache = _template_cache.find(key);
+        if (it_cache == _template_cache.end())
+        {
+            compiled = compile(ref_scope, args);
+            _template_cache[key] = compiled;
+            _template_cache_misses++;
+        }
+        else
+        {
+            compiled = it_cache->second;
+            _template_cache_hits++;
+        }
+
+        Nodecl::NodeclBase result = Nodecl::Utils::deep_copy(compiled->tree, ref_scope);
+
+        // Locate all the sites before filling any of them, since replacing
+        // a statement by a list changes the shape of the tree
+        std::vector<Nodecl::NodeclBase> site_nodes;
+        for (std::vector<HoleSite>::iterator it = compiled->sites.begin();
+                it != compiled->sites.end();
+                it++)
+        {
+            nodecl_t n = result.get_internal_nodecl();
+            for (std::vector<int>::iterator child = it->path.begin();
+                    child != it->path.end();
+                    child++)
+            {
+                n = nodecl_get_child(n, *child);
+            }
+            ERROR_CONDITION(nodecl_is_null(n), "Invalid hole site in copied template", 0);
+            site_nodes.push_back(n);
+        }
+
+        for (unsigned int i = 0; i < compiled->sites.size(); i++)
+        {
+            const SourceTemplateArgs::Argument& arg = args.get(compiled->sites[i].name);
+            Nodecl::NodeclBase& node = site_nodes[i];
+
+            switch (arg.kind)
+            {
+                case SourceTemplateArgs::HOLE_EXPRESSION:
+                    {
+                        node.replace(arg.tree.shallow_copy());
+                        break;
+                    }
+                case SourceTemplateArgs::HOLE_SYMBOL:
+                    {
+                        node.set_symbol(arg.sym);
+                        break;
+                    }
+                case SourceTemplateArgs::HOLE_STATEMENT:
+                    {
+                        node.replace(arg.tree);
+                        break;
+                    }
+                default:
+                    internal_error("Code unreachable", 0);
+            }
+        }
+
+        return result;
+    }
+
+    void SourceTemplate::get_cache_stats(unsigned int& num_hits, unsigned int& num_misses)
+    {
+        num_hits = _template_cache_hits;
+        num_misses = _template_cache_misses;
+    }
+}
@@ -0,0 +1,175 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef TL_SOURCE_TEMPLATE_HPP
+#define TL_SOURCE_TEMPLATE_HPP
+
+#include "tl-common.hpp"
+#include "tl-source.hpp"
+#include "tl-nodecl.hpp"
+#include "tl-symbol.hpp"
+#include "tl-type.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace TL
+{
+    //! Arguments used to instantiate a SourceTemplate
+    /*!
+     * Every hole of the template must be given exactly one argument
+     */
+    class LIBTL_CLASS SourceTemplateArgs
+    {
+        public:
+            enum HoleKind
+            {
+                HOLE_INVALID = 0,
+                HOLE_EXPRESSION,
+                HOLE_SYMBOL,
+                HOLE_STATEMENT,
+                HOLE_TYPE,
+            };
+
+            struct Argument
+            {
+                HoleKind kind;
+                Nodecl::NodeclBase tree;
+                TL::Symbol sym;
+                TL::Type type;
+
+                Argument()
+                    : kind(HOLE_INVALID), tree(), sym(), type() { }
+            };
+
+        private:
+            std::map<std::string, Argument> _args;
+
+            SourceTemplateArgs& add(const std::string& name, const Argument& arg);
+
+        public:
+            //! Fills the hole \a name with a copy of the expression \a n
+            /*!
+             * The template is checked with the type and the value category of
+             * \a n, so instantiations with expressions of different types use
+             * different compilations of the template. In C and C++ a hole
+             * filled with a prvalue or an xvalue cannot be assigned nor have
+             * its address taken in the pattern
+             */
+            SourceTemplateArgs& expression(const std::string& name, Nodecl::NodeclBase n);
+
+            //! Fills the hole \a name with a reference to the variable or function \a s
+            SourceTemplateArgs& symbol(const std::string& name, TL::Symbol s);
+
+            //! Fills the statement hole \a name with \a n
+            /*!
+             * \a n is moved into the instantiated tree, it is not copied
+             */
+            SourceTemplateArgs& statement(const std::string& name, Nodecl::NodeclBase n);
+
+            //! Fills the hole \a name with the type \a t
+            /*!
+             * Types are substituted textually, so every different type gives a
+             * different compilation of the template
+             */
+            SourceTemplateArgs& type(const std::string& name, TL::Type t);
+
+            const Argument& get(const std::string& name) const;
+    };
+
+    //! A Source pattern that is parsed once and instantiated many times
+    /*!
+     * Holes are written in the pattern using SourceTemplate::hole. The first
+     * time a template is instantiated it is parsed and checked once with
+     * every expression and symbol hole replaced by a placeholder of the type
+     * and value category of its argument and every statement hole replaced
+     * by a statement placeholder. Later instantiations with arguments of the
+     * same kinds and types only deep copy the checked tree and fill the holes.
+     *
+     * Compiled templates are cached per pattern, template kind, source
+     * language, translation unit and signature of the arguments.
+     *
+     * Names in the pattern that are not holes are looked up only when the
+     * template is compiled, so they must refer to the same entity wherever
+     * the template is instantiated (e.g. runtime functions and types).
+     * Local entities must be passed as holes. Statement templates declaring
+     * variables must enclose them in a compound statement.
+     */
+    class LIBTL_CLASS SourceTemplate
+    {
+        public:
+            enum Kind
+            {
+                EXPRESSION = 0,
+                STATEMENT,
+            };
+
+            //! A parsed and checked pattern, opaque to the users of this class
+            struct CompiledTemplate;
+
+        private:
+            // A pattern is a sequence of text chunks and holes.
+            // Holes have a nonempty name
+            struct Segment
+            {
+                std::string text;
+                std::string hole;
+            };
+
+            Kind _kind;
+            std::string _pattern;
+            std::vector<Segment> _segments;
+            // Names of the holes in order of first appearance
+            std::vector<std::string> _holes;
+
+            CompiledTemplate* compile(ReferenceScope ref_scope,
+                    const SourceTemplateArgs& args) const;
+
+            void split_pattern();
+
+        public:
+            SourceTemplate(Kind kind, const std::string& pattern);
+
+            //! Returns the text used to denote the hole \a name in a pattern
+            /*!
+             * \a name can only contain letters, digits and underscores
+             */
+            static std::string hole(const std::string& name);
+
+            //! Instantiates the template in \a ref_scope
+            Nodecl::NodeclBase instantiate(ReferenceScope ref_scope,
+                    const SourceTemplateArgs& args) const;
+
+            //! Number of instantiations that did and did not parse the pattern
+            static void get_cache_stats(unsigned int& num_hits, unsigned int& num_misses);
+    };
+}
+
+#endif // TL_SOURCE_TEMPLATE_HPP
@@ -46,6 +46,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <cstdio>
 
 namespace TL
 {
@@ -106,9 +107,9 @@ namespace TL
 
     Source& Source::operator<<(int num)
     {
-        std::stringstream ss;
-        ss << num;
-        append_text_chunk(ss.str());
+        char c[32];
+        snprintf(c, sizeof(c), "%d", num);
+        append_text_chunk(c);
         return *this;
     }
     
@@ -847,13 +848,12 @@ namespace TL
 
     std::string as_statement(const Nodecl::NodeclBase& n)
     {
-        std::stringstream ss;
-        ss << nodecl_stmt_to_source(n.get_internal_nodecl());
+        std::string result = nodecl_stmt_to_source(n.get_internal_nodecl());
 
         if (IS_FORTRAN_LANGUAGE)
-            ss << "\n";
+            result += "\n";
 
-        return ss.str();
+        return result;
     }
 
     std::string as_type(TL::Type t)
@@ -31,6 +31,7 @@
 #include "tl-scope.hpp"
 #include "tl-type.hpp"
 #include "tl-nodecl.hpp"
+#include "cxx-instantiation.h"
 
 namespace TL
 {
@@ -733,6 +734,11 @@ namespace TL
         return symbol_entity_specs_get_is_defined_inside_class_specifier(_symbol);
     }
 
+    void Symbol::instantiate_member_if_needed() const
+    {
+        ::instantiate_member_if_needed(_symbol, _symbol->locus);
+    }
+
     bool Symbol::not_to_be_printed() const
     {
         return _symbol->do_not_print;
@@ -578,6 +578,14 @@ namespace TL
             // States whether the symbol is defined inside a class specifier
             bool is_defined_inside_class() const;
 
+            //! Instantiates this member of a class template specialization if it was not instantiated yet
+            /*!
+              For member functions this instantiates the body, for nested classes their
+              definition and for static data members their in-class initializer.
+              It does nothing for other symbols
+             */
+            void instantiate_member_if_needed() const;
+
             //! Do not use unless told to do so
             scope_entry_t* get_internal_symbol() const
             {
@@ -0,0 +1,48 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+</testinfo>
+*/
+// A thousand identifiers that only differ in a few characters are different
+// names, and so are identifiers that are prefixes of others or differ only in
+// their last character
+#include <stdlib.h>
+#include <string.h>
+
+#define DECL(a, b, c) int v_##a##b##c = a * 100 + b * 10 + c;
+#define ADD(a, b, c) s += v_##a##b##c;
+
+#define ROW(X, a, b) X(a, b, 0) X(a, b, 1) X(a, b, 2) X(a, b, 3) X(a, b, 4) \
+    X(a, b, 5) X(a, b, 6) X(a, b, 7) X(a, b, 8) X(a, b, 9)
+#define BLOCK(X, a) ROW(X, a, 0) ROW(X, a, 1) ROW(X, a, 2) ROW(X, a, 3) ROW(X, a, 4) \
+    ROW(X, a, 5) ROW(X, a, 6) ROW(X, a, 7) ROW(X, a, 8) ROW(X, a, 9)
+#define ALL(X) BLOCK(X, 0) BLOCK(X, 1) BLOCK(X, 2) BLOCK(X, 3) BLOCK(X, 4) \
+    BLOCK(X, 5) BLOCK(X, 6) BLOCK(X, 7) BLOCK(X, 8) BLOCK(X, 9)
+
+ALL(DECL)
+
+int v_0 = -1, v_00 = -2, v_12 = -12, v_99 = -99;
+
+int a_rather_long_identifier_that_only_differs_from_the_next_one_at_its_very_last_character_a = 1;
+int a_rather_long_identifier_that_only_differs_from_the_next_one_at_its_very_last_character_b = 2;
+
+int main(int argc, char *argv[])
+{
+    long s = 0;
+    ALL(ADD)
+
+    if (s != 499500)
+        abort();
+
+    if (v_0 + v_00 + v_12 + v_99 != -114)
+        abort();
+
+    if (a_rather_long_identifier_that_only_differs_from_the_next_one_at_its_very_last_character_a
+            == a_rather_long_identifier_that_only_differs_from_the_next_one_at_its_very_last_character_b)
+        abort();
+
+    if (strcmp("v_123", "v_12") == 0)
+        abort();
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+</testinfo>
+*/
+// Scopes with a few names are kept inline in their table and move to the
+// array once they have more than four. Names in nested scopes must hide
+// those of the enclosing ones on both sides of that threshold
+#include <stdlib.h>
+
+int a = 1, b = 2, c = 3, d = 4, e = 5, f = 6;
+
+static int four(void)
+{
+    int a = 10, b = 20, c = 30, d = 40;
+    return a + b + c + d + e + f;
+}
+
+static int five(void)
+{
+    int a = 10, b = 20, c = 30, d = 40;
+    int e = 50;
+    {
+        int f = 60;
+        return a + b + c + d + e + f;
+    }
+}
+
+static int six(void)
+{
+    int r = a + b + c + d + e + f;
+    {
+        int a = 100, b = 200, c = 300, d = 400, e = 500, f = 600;
+        r += a + b + c + d + e + f;
+        {
+            int a = 1000, b = 2000, c = 3000, d = 4000;
+            r += a + b + c + d + e + f;
+        }
+        r += a + b;
+    }
+    return r + a + b;
+}
+
+struct members
+{
+    int m0, m1, m2, m3, m4, m5, m6, m7, m8, m9;
+};
+
+int main(int argc, char *argv[])
+{
+    struct members s = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+    if (four() != 111)
+        abort();
+    if (five() != 210)
+        abort();
+    if (six() != 21 + 2100 + 11100 + 300 + 3)
+        abort();
+    if (s.m0 + s.m4 + s.m5 + s.m9 != 18)
+        abort();
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Lookups filtering by symbol kind must not be answered with the
+// result of an unfiltered lookup of the same name in the same scope, and
+// vice versa
+struct A { int x; };
+void A(int);
+
+enum E { e0, e1 };
+int E;
+
+struct S { static int v; };
+int S;
+
+void f()
+{
+    struct A a1;
+    A(1);
+    struct A a2;
+    A(2);
+    a1.x = a2.x;
+
+    enum E x1 = e1;
+    E = 1;
+    enum E x2 = x1;
+    E = x2;
+
+    S = 1;
+    S::v = 2;
+    S = 3;
+    S::v = 4;
+}
@@ -0,0 +1,43 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// A name found in an enclosing scope must be looked up again once it is
+// declared in a nearer scope, even if it was found through a lookup nested
+// in another one
+typedef char one;
+typedef int four;
+
+four v;
+
+namespace N
+{
+    struct B
+    {
+        typedef char check1[sizeof(v) == sizeof(four) ? 1 : -1];
+    };
+
+    typedef char check2[sizeof(v) == sizeof(four) ? 1 : -1];
+
+    one v;
+
+    typedef char check3[sizeof(v) == sizeof(one) ? 1 : -1];
+
+    struct C
+    {
+        typedef char check4[sizeof(v) == sizeof(one) ? 1 : -1];
+    };
+
+    namespace M
+    {
+        typedef char check5[sizeof(v) == sizeof(one) ? 1 : -1];
+    }
+
+    namespace M
+    {
+        struct v { char c[16]; };
+
+        typedef char check6[sizeof(v) == 16 ? 1 : -1];
+    }
+}
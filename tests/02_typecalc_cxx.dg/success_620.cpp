@@ -0,0 +1,35 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Comparing template arguments while looking up the canonical type of a
+// template-id computes the canonical types of the arguments. Use enough of
+// them to grow the table of canonical types in the middle of lookups
+template <int N>
+struct I { };
+
+template <typename T>
+struct W { };
+
+template <typename T, typename S>
+struct same { enum { value = 0 }; };
+
+template <typename T>
+struct same<T, T> { enum { value = 1 }; };
+
+#define CHECK(n) \
+    typedef I<n> ti_##n; \
+    typedef char check_##n[same<W<I<n> >, W<ti_##n> >::value \
+        && same<W<W<ti_##n> > , W<W<I<n> > > >::value \
+        && !same<W<I<n> >, W<I<n + 1> > >::value ? 1 : -1];
+
+#define CHECK10(n) CHECK(n##0) CHECK(n##1) CHECK(n##2) CHECK(n##3) CHECK(n##4) \
+    CHECK(n##5) CHECK(n##6) CHECK(n##7) CHECK(n##8) CHECK(n##9)
+#define CHECK100(n) CHECK10(n##0) CHECK10(n##1) CHECK10(n##2) CHECK10(n##3) CHECK10(n##4) \
+    CHECK10(n##5) CHECK10(n##6) CHECK10(n##7) CHECK10(n##8) CHECK10(n##9)
+#define CHECK1000(n) CHECK100(n##0) CHECK100(n##1) CHECK100(n##2) CHECK100(n##3) CHECK100(n##4) \
+    CHECK100(n##5) CHECK100(n##6) CHECK100(n##7) CHECK100(n##8) CHECK100(n##9)
+
+CHECK1000(1)
+CHECK1000(2)
@@ -0,0 +1,52 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Repeated overload resolutions whose viable functions change due to
+// default arguments and explicit template arguments
+void f(int, int, int);
+char f(char);
+
+void g1()
+{
+    f(1, 2, 3);
+    f('a');
+}
+
+void f(int, int, int = 3);
+
+void g2()
+{
+    f(1, 2, 3);
+    f(1, 2);
+    f('a');
+}
+
+void f(int, int = 2, int);
+
+void g3()
+{
+    f(1, 2);
+    f(1);
+    typedef char check[sizeof(f('a')) == sizeof(char) ? 1 : -1];
+}
+
+template <typename T>
+T h(T);
+
+template <typename T>
+T h(T, int);
+
+char h(char, int, int = 0);
+
+void g4()
+{
+    int (*p1)(int) = h<int>;
+    int (*p2)(int, int) = h<int>;
+    char c = h('a', 1);
+    c = h('a', 1, 2);
+    typedef char check1[sizeof(h<short>((short)1, 1)) == sizeof(short) ? 1 : -1];
+    typedef char check2[sizeof(h<long>(1)) == sizeof(long) ? 1 : -1];
+    typedef char check3[sizeof(h<short>(1)) == sizeof(short) ? 1 : -1];
+}
@@ -0,0 +1,81 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Template arguments spelled differently but identical or equivalent must
+// name the same specialization, and different ones must not
+template <bool B>
+struct check;
+
+template <>
+struct check<true> { };
+
+template <typename T, typename S>
+struct is_same { enum { value = 0 }; };
+
+template <typename T>
+struct is_same<T, T> { enum { value = 1 }; };
+
+template <typename T, int N>
+struct A
+{
+    enum { value = N };
+    void f();
+};
+
+typedef int myint;
+typedef const int cint;
+const int two = 2;
+
+check<is_same<A<int, 2>, A<myint, 1 + 1> >::value> c1;
+check<is_same<A<int, 2>, A<signed int, two> >::value> c2;
+check<!is_same<A<int, 2>, A<int, 3> >::value> c3;
+check<!is_same<A<int, 2>, A<cint, 2> >::value> c4;
+check<!is_same<A<int, 2>, A<long, 2> >::value> c5;
+check<!is_same<A<int*, 2>, A<int&, 2> >::value> c6;
+
+template <typename T, int N>
+void A<T, N>::f() { }
+
+// Equivalent dependent arguments in a partial specialization and in the
+// out-of-class definition of its member
+template <typename T, int N>
+struct B;
+
+template <typename T, int N>
+struct B<T*, N>
+{
+    void g();
+};
+
+template <typename U, int M>
+void B<U*, M>::g() { }
+
+template <typename T>
+struct B<T, 0>
+{
+    enum { value = 0 };
+};
+
+check<B<char, 0>::value == 0> c7;
+
+// Template template arguments
+template <template <typename, int> class TT>
+struct C { enum { value = 1 }; };
+
+template <>
+struct C<B> { enum { value = 2 }; };
+
+check<C<A>::value == 1> c8;
+check<C<B>::value == 2> c9;
+
+// Many specializations of the same template
+template <int N>
+struct D { enum { value = D<N - 1>::value + N }; };
+
+template <>
+struct D<0> { enum { value = 0 }; };
+
+check<D<40>::value == 820> c10;
+check<is_same<D<40>, D<20 * 2> >::value> c11;
@@ -0,0 +1,50 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+test_CXXFLAGS="--line-markers"
+</testinfo>
+*/
+// Nodes with three and four children keep them out of line and the rest
+// inline. Emitting line markers reads back the locus of every statement
+#include <stdlib.h>
+
+static int classify(int x)
+{
+    return x < 0 ? -1 : x == 0 ? 0 : x < 10 ? 1 : 2;
+}
+
+int main()
+{
+    int s = 0;
+    for (int i = 0, j = 10; i < j; i++, j--)
+    {
+        if (i % 2 == 0)
+            s += classify(i - 3);
+        else if (i % 3 == 0)
+            s += 10 * classify(j);
+        else
+            s -= classify(-i);
+    }
+
+    int k = 0;
+    while (k < 5)
+    {
+        do
+        {
+            k++;
+        } while (k % 2 != 0);
+    }
+
+    switch (s)
+    {
+        case 0:
+            abort();
+        default:
+            break;
+    }
+
+    if (s != 10 || k != 6)
+        abort();
+
+    return 0;
+}
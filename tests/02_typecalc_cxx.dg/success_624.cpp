@@ -0,0 +1,51 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+</testinfo>
+*/
+// Ambiguous statements and expressions build several trees of which only
+// one is kept; the discarded ones are released back to the AST arena
+#include <stdlib.h>
+
+struct A
+{
+    int v;
+    A(int x = 1) : v(x) { }
+    int operator()(int x) const { return v + x; }
+};
+
+template <typename T>
+struct B
+{
+    static int get(T t) { return t.v * 2; }
+};
+
+int b = 3, c = 4;
+
+int f(A a) { return a.v; }
+
+int main()
+{
+    int s = 0;
+
+    A(b);               // declaration of a local b
+    s += b.v;
+
+    s += f(A(c));       // expression
+    s += A(c)(5);       // expression
+
+    int (x) = 6;        // declaration
+    s += x;
+
+    s += sizeof(A) == sizeof(int);
+    s += B<A>::get(A(7));
+
+    int d = 2, e = 1;
+    bool lt = d < e > (c);   // not a template-id
+    s += lt;
+
+    if (s != 1 + 4 + 9 + 6 + 1 + 14 + 0)
+        abort();
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// A name looked up in a block scope before a local declaration hides it must
+// be looked up again after that declaration
+int x;
+
+void f()
+{
+    x;
+    typedef char check1[sizeof(x) == sizeof(int) ? 1 : -1];
+
+    char x;
+    typedef char check2[sizeof(x) == 1 ? 1 : -1];
+
+    {
+        x;
+        typedef char check3[sizeof(x) == 1 ? 1 : -1];
+
+        double x;
+        typedef char check4[sizeof(x) == sizeof(double) ? 1 : -1];
+    }
+
+    typedef char check5[sizeof(x) == 1 ? 1 : -1];
+}
@@ -0,0 +1,40 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Specializations of a class template are equivalent only if their template
+// arguments are, however these are spelled
+template <typename T, int N>
+struct A { };
+
+template <typename T, typename U>
+struct same { enum { value = 0 }; };
+
+template <typename T>
+struct same<T, T> { enum { value = 1 }; };
+
+typedef int my_int;
+typedef const my_int my_const_int;
+enum { THREE = 3 };
+
+typedef char check1[same<A<int, 3>, A<my_int, 1 + 2> >::value ? 1 : -1];
+typedef char check2[same<A<const int, 3>, A<my_const_int, THREE> >::value ? 1 : -1];
+typedef char check3[same<A<int*, 3>, A<my_int*, 3L> >::value ? 1 : -1];
+typedef char check4[same<A<A<int, 1>, 2>, A<A<my_int, 1>, 2> >::value ? 1 : -1];
+
+typedef char check5[!same<A<int, 3>, A<int, 4> >::value ? 1 : -1];
+typedef char check6[!same<A<int, 3>, A<const int, 3> >::value ? 1 : -1];
+typedef char check7[!same<A<int, 3>, A<long, 3> >::value ? 1 : -1];
+typedef char check8[!same<A<A<int, 1>, 2>, A<A<int, 2>, 2> >::value ? 1 : -1];
+
+void f(A<int, 3>);
+void f(A<int, 4>);
+
+void g()
+{
+    A<my_int, THREE> a;
+    f(a);
+    A<my_int, 4> b;
+    f(b);
+}
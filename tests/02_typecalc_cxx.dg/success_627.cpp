@@ -0,0 +1,63 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+// Overloads resolved again once a redeclaration adds default arguments or a
+// using-declaration adds overloads must take them into account
+char f(double);
+int f(int, int);
+
+void g1()
+{
+    typedef char check1[sizeof(f(1)) == sizeof(char) ? 1 : -1];
+}
+
+int f(int, int = 0);
+
+void g2()
+{
+    typedef char check2[sizeof(f(1)) == sizeof(int) ? 1 : -1];
+}
+
+namespace N
+{
+    char h(double);
+}
+
+using N::h;
+
+void g3()
+{
+    typedef char check3[sizeof(h(1)) == sizeof(char) ? 1 : -1];
+}
+
+namespace N
+{
+    int h(int);
+}
+
+using N::h;
+
+void g4()
+{
+    typedef char check4[sizeof(h(1)) == sizeof(int) ? 1 : -1];
+}
+
+struct A
+{
+    char m(double);
+    int m(int, int);
+
+    void g5()
+    {
+        typedef char check5[sizeof(m(1)) == sizeof(char) ? 1 : -1];
+    }
+};
+
+int A::m(int, int = 0) { return 0; }
+
+void g6(A& a)
+{
+    typedef char check6[sizeof(a.m(1)) == sizeof(int) ? 1 : -1];
+}
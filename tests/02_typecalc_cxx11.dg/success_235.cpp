@@ -0,0 +1,55 @@
+/*
+<testinfo>
+test_generator=config/mercurium-cxx11
+test_CXXFLAGS="--lazy-instantiation"
+</testinfo>
+*/
+// Deferred initializers of static data members must be available as soon
+// as their value is needed in a constant expression
+template <typename T>
+struct A
+{
+    static constexpr int size = sizeof(T);
+    static const int twice = 2 * size;
+    static constexpr T zero = T();
+};
+
+template <typename T>
+struct B
+{
+    // Refers to deferred members of another specialization
+    static constexpr int value = A<T>::twice + A<T*>::size;
+    int array[A<T>::size];
+};
+
+static_assert(A<char>::size == 1, "");
+static_assert(A<int>::twice == 2 * sizeof(int), "");
+static_assert(A<long>::zero == 0L, "");
+static_assert(B<short>::value == 2 * sizeof(short) + sizeof(short*), "");
+static_assert(sizeof(B<double>) == sizeof(int) * sizeof(double), "");
+
+template <int N>
+struct C
+{
+    static constexpr int value = C<N - 1>::value + N;
+};
+
+template <>
+struct C<0>
+{
+    static constexpr int value = 0;
+};
+
+static_assert(C<10>::value == 55, "");
+
+template <typename T>
+void f()
+{
+    int local[A<T>::twice];
+    static_assert(sizeof(local) == 2 * sizeof(T) * sizeof(int), "");
+}
+
+void g()
+{
+    f<float>();
+}
@@ -0,0 +1,58 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx11 run"
+test_CXXFLAGS="--lazy-instantiation"
+</testinfo>
+*/
+// Deferred initializers of static data members that are odr-used, or only
+// needed at the end of the translation unit, must be emitted
+template <typename T>
+struct A
+{
+    static constexpr int size = sizeof(T);
+    static const int twice = 2 * size;
+    static int counter;
+};
+
+template <typename T>
+constexpr int A<T>::size;
+
+template <typename T>
+const int A<T>::twice;
+
+template <typename T>
+int A<T>::counter = A<T>::twice;
+
+template <typename T>
+const int* address_of_size()
+{
+    return &A<T>::size;
+}
+
+template <typename T>
+struct B
+{
+    static constexpr int value = A<T>::twice + 1;
+};
+
+template <typename T>
+constexpr int B<T>::value;
+
+int use(const int& x)
+{
+    return x;
+}
+
+int main(int, char**)
+{
+    if (A<int>::counter != 2 * sizeof(int))
+        return 1;
+    if (*address_of_size<char>() != 1)
+        return 1;
+    if (use(A<short>::twice) != 2 * sizeof(short))
+        return 1;
+    if (use(B<long>::value) != 2 * sizeof(long) + 1)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+<testinfo>
+test_generator=config/mercurium-cxx11
+</testinfo>
+*/
+// Repeated deductions of the same function template with the same argument
+// types. A substitution failure may turn into a success once a later
+// declaration is visible, and deductions in different contexts are distinct
+namespace N
+{
+    struct X { };
+}
+
+template <typename T>
+auto f(T t) -> decltype(g(t), char());
+int f(...);
+
+static_assert(sizeof(f(N::X())) == sizeof(int), "");
+static_assert(sizeof(f(N::X())) == sizeof(int), "");
+
+namespace N
+{
+    void g(X);
+}
+
+static_assert(sizeof(f(N::X())) == sizeof(char), "");
+
+template <typename T>
+struct Outer
+{
+    template <typename U>
+    static T k(U, T);
+
+    static_assert(sizeof(k(1, T())) == sizeof(T), "");
+};
+
+template struct Outer<char>;
+template struct Outer<double>;
+
+template <typename T>
+typename T::type h(T);
+long h(...);
+
+void a()
+{
+    struct L { typedef char type; };
+    static_assert(sizeof(h(L())) == sizeof(char), "");
+}
+
+void b()
+{
+    struct L { };
+    static_assert(sizeof(h(L())) == sizeof(long), "");
+}
@@ -0,0 +1,64 @@
+/*
+<testinfo>
+test_generator=config/mercurium-cxx11
+</testinfo>
+*/
+// Function types that share a prefix of their parameters, or only differ in
+// their variadic ellipsis, trailing return, ref-qualifier or cv-qualifier,
+// are different types. Spelling the same type twice gives the same type
+template <typename T, typename S>
+struct is_same
+{
+    static const bool value = false;
+};
+
+template <typename T>
+struct is_same<T, T>
+{
+    static const bool value = true;
+};
+
+typedef int f0();
+typedef int f1(int);
+typedef int f2(int, int);
+typedef int f3(int, int, int);
+typedef int fv(int, ...);
+typedef auto ft(int) -> int;
+typedef int f1c(const int);
+typedef long f1l(int);
+
+static_assert(!is_same<f0, f1>::value, "");
+static_assert(!is_same<f1, f2>::value, "");
+static_assert(!is_same<f2, f3>::value, "");
+static_assert(!is_same<f1, fv>::value, "");
+static_assert(!is_same<f1, f1l>::value, "");
+static_assert(is_same<f1, ft>::value, "");
+static_assert(is_same<f1, f1c>::value, "");
+static_assert(is_same<f2, int(int, int)>::value, "");
+static_assert(is_same<fv, int(int, ...)>::value, "");
+
+struct A
+{
+    int g(int);
+    int g(int) const;
+    int h(int) &;
+    int h(int) &&;
+    int k(int, int) volatile;
+};
+
+static_assert(!is_same<decltype(static_cast<int (A::*)(int)>(&A::g)),
+        decltype(static_cast<int (A::*)(int) const>(&A::g))>::value, "");
+static_assert(!is_same<decltype(static_cast<int (A::*)(int) &>(&A::h)),
+        decltype(static_cast<int (A::*)(int) &&>(&A::h))>::value, "");
+static_assert(is_same<decltype(&A::k), int (A::*)(int, int) volatile>::value, "");
+
+// Overloads whose parameters are sequences with a common prefix
+char p(int);
+short p(int, int);
+long p(int, int, int);
+int p(int, int, int, int, ...);
+
+static_assert(sizeof(p(1)) == sizeof(char), "");
+static_assert(sizeof(p(1, 2)) == sizeof(short), "");
+static_assert(sizeof(p(1, 2, 3)) == sizeof(long), "");
+static_assert(sizeof(p(1, 2, 3, 4)) == sizeof(int), "");
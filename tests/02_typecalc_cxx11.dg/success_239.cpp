@@ -0,0 +1,48 @@
+/*
+<testinfo>
+test_generator=config/mercurium-cxx11
+</testinfo>
+*/
+// Deductions are shared by calls from different function bodies, but a
+// substitution failure that depends on a function found by argument dependent
+// lookup must be checked again once that function is declared
+namespace N
+{
+    struct A { };
+}
+
+template <typename T>
+T* first(T* p, int) { return p; }
+
+template <typename T>
+auto g(T t) -> decltype(h(t), 1);
+char g(...);
+
+void f1()
+{
+    N::A a;
+    typedef char check1[sizeof(first(&a, 1)) == sizeof(N::A*) ? 1 : -1];
+    typedef char check2[sizeof(g(a)) == sizeof(char) ? 1 : -1];
+}
+
+struct B
+{
+    void f2()
+    {
+        N::A a;
+        typedef char check3[sizeof(first(&a, 1)) == sizeof(N::A*) ? 1 : -1];
+        typedef char check4[sizeof(g(a)) == sizeof(char) ? 1 : -1];
+    }
+};
+
+namespace N
+{
+    void h(A);
+}
+
+void f3()
+{
+    N::A a;
+    typedef char check5[sizeof(first(&a, 1)) == sizeof(N::A*) ? 1 : -1];
+    typedef char check6[sizeof(g(a)) == sizeof(int) ? 1 : -1];
+}
@@ -1,5 +1,5 @@
 /*--------------------------------------------------------------------
-  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
                           Centro Nacional de Supercomputacion
   
   This file is part of Mercurium C/C++ source-to-source compiler.
@@ -24,23 +24,29 @@
   Cambridge, MA 02139, USA.
 --------------------------------------------------------------------*/
 
-
-
-
-#ifndef CXX_TYPE_TRIE_H
-#define CXX_TYPE_TRIE_H
-
-#include "cxx-type-decls.h"
-
-MCXX_BEGIN_DECLS
-
-typedef struct type_trie_tag type_trie_t;
-
-type_trie_t* allocate_type_trie(void);
-
-const type_t* lookup_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types);
-void insert_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types, const type_t* funct_type);
-
-MCXX_END_DECLS
-
-#endif // CXX_TYPE_TRIE_H
+/*
+<testinfo>
+test_generator=config/mercurium-analysis
+test_nolink=yes
+</testinfo>
+*/
+
+// Structurally equal trees in different statements must be found equal
+// once their structural hashes are cached, and different once a tree
+// has been modified
+int f(int a, int b)
+{
+    int x, y, z;
+
+    x = a + b;
+    y = a + b;
+    if (a > b)
+    {
+        #pragma analysis_check assert reaching_definition_in(x: a + b; y: a + b) live_in(a, b, y) dead(x, z)
+        x = a + b;
+    }
+    z = a - b;
+
+    #pragma analysis_check assert reaching_definition_in(x: a + b; y: a + b; z: a - b) live_in(x, y, z)
+    return x + y + z;
+}
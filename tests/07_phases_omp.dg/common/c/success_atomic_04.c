@@ -0,0 +1,114 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+/*
+<testinfo>
+test_generator=config/mercurium-omp
+</testinfo>
+*/
+
+// Atomic builtins of several sizes, with lvalue and rvalue operands. The
+// constructs of the same size and operation share one parsed pattern
+#include <stdlib.h>
+#include <stdio.h>
+#include "omp.h"
+
+#define NUM_ITERS 1000
+
+int main(int argc, char* argv[])
+{
+    int num_threads = omp_get_max_threads();
+
+    int i = 0;
+    long l = 0;
+    short s = 0;
+    unsigned int mask = 0;
+    int a[2] = { 0, 0 };
+    int two = 2;
+
+#pragma omp parallel
+    {
+        int j;
+        for (j = 0; j < NUM_ITERS; j++)
+        {
+#pragma omp atomic
+            i += two;
+#pragma omp atomic
+            i += j - j + 1;
+#pragma omp atomic
+            i -= 2;
+#pragma omp atomic
+            i++;
+
+#pragma omp atomic
+            l += two;
+#pragma omp atomic
+            --l;
+
+#pragma omp atomic
+            s++;
+#pragma omp atomic
+            s--;
+
+#pragma omp atomic
+            mask |= 1u << (j % 4);
+
+#pragma omp atomic
+            a[j % 2] += 1;
+#pragma omp atomic
+            ++a[1];
+        }
+    }
+
+    if (i != 2 * NUM_ITERS * num_threads)
+    {
+        fprintf(stderr, "i: %d != %d\n", i, 2 * NUM_ITERS * num_threads);
+        abort();
+    }
+    if (l != (long)NUM_ITERS * num_threads)
+    {
+        fprintf(stderr, "l: %ld != %ld\n", l, (long)NUM_ITERS * num_threads);
+        abort();
+    }
+    if (s != 0)
+    {
+        fprintf(stderr, "s: %d != 0\n", s);
+        abort();
+    }
+    if (mask != 0xfu)
+    {
+        fprintf(stderr, "mask: %x != f\n", mask);
+        abort();
+    }
+    if (a[0] != NUM_ITERS / 2 * num_threads
+            || a[1] != 3 * NUM_ITERS / 2 * num_threads)
+    {
+        fprintf(stderr, "a: %d %d\n", a[0], a[1]);
+        abort();
+    }
+
+    return 0;
+}
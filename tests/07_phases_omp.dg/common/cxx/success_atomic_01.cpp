@@ -0,0 +1,84 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+/*
+<testinfo>
+test_generator=config/mercurium-omp
+</testinfo>
+*/
+
+// Atomic builtins on references and on the results of calls, in several
+// instantiations of a template
+#include <stdlib.h>
+#include "omp.h"
+
+#define NUM_ITERS 1000
+
+template <typename T>
+T one()
+{
+    return 1;
+}
+
+template <typename T>
+void increment(T& x, const T& step)
+{
+#pragma omp atomic
+    x += step;
+#pragma omp atomic
+    x += one<T>();
+#pragma omp atomic
+    x -= one<T>();
+#pragma omp atomic
+    x++;
+}
+
+template <typename T>
+void check()
+{
+    int num_threads = omp_get_max_threads();
+    T x = 0;
+
+#pragma omp parallel
+    {
+        for (int j = 0; j < NUM_ITERS; j++)
+        {
+            increment(x, T(2));
+        }
+    }
+
+    if (x != T(3) * NUM_ITERS * num_threads)
+        abort();
+}
+
+int main(int argc, char* argv[])
+{
+    check<int>();
+    check<long>();
+    check<unsigned int>();
+
+    return 0;
+}
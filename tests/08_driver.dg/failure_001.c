@@ -0,0 +1,27 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+test_CFLAGS="--pp-stream"
+test_compile_fail=yes
+</testinfo>
+*/
+// The parser stops at the error below while the preprocessor still has a
+// lot of output to write. The driver must not wait for it forever
+int a = ;
+
+#define D(n) int v_##n[100];
+#define D10(n) D(n##0) D(n##1) D(n##2) D(n##3) D(n##4) \
+    D(n##5) D(n##6) D(n##7) D(n##8) D(n##9)
+#define D100(n) D10(n##0) D10(n##1) D10(n##2) D10(n##3) D10(n##4) \
+    D10(n##5) D10(n##6) D10(n##7) D10(n##8) D10(n##9)
+#define D1000(n) D100(n##0) D100(n##1) D100(n##2) D100(n##3) D100(n##4) \
+    D100(n##5) D100(n##6) D100(n##7) D100(n##8) D100(n##9)
+
+D1000(1)
+D1000(2)
+D1000(3)
+D1000(4)
+D1000(5)
+D1000(6)
+D1000(7)
+D1000(8)
@@ -0,0 +1,14 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+test_CFLAGS="--pp-stream"
+test_compile_fail=yes
+</testinfo>
+*/
+// The preprocessor fails and its output is incomplete
+#include "this-header-does-not-exist.h"
+
+int f(void)
+{
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --pp-stream"
+</testinfo>
+*/
+// Parsing while the file is being preprocessed gives the same output
+#include <stddef.h>
+#include <limits.h>
+
+#define SQUARE(x) ((x) * (x))
+
+namespace N
+{
+    template <typename T>
+    T square(T t)
+    {
+        return SQUARE(t);
+    }
+}
+
+int f(int x)
+{
+#if INT_MAX > 32767
+    return N::square(x) + (int)sizeof(size_t);
+#else
+    return x;
+#endif
+}
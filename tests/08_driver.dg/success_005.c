@@ -0,0 +1,31 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --result-cache-dir=%TMPDIR%/cache"
+</testinfo>
+*/
+// The second run takes the generated source from the result cache entry
+// created by the first one, after checking that the stored key and input
+// are those of this compilation
+struct list
+{
+    int value;
+    struct list* next;
+};
+
+int sum(struct list* l)
+{
+    int s = 0;
+    for (; l != 0; l = l->next)
+        s += l->value;
+    return s;
+}
+
+static int twice(int x)
+{
+    return 2 * x;
+}
+
+int sum_twice(struct list* l)
+{
+    return twice(sum(l));
+}
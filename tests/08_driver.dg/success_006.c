@@ -0,0 +1,64 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --codegen-jobs=4"
+</testinfo>
+*/
+// Function definitions are emitted by several workers and merged back in
+// order. Declarations between them are emitted by the parent
+#include <stddef.h>
+
+struct node
+{
+    int value;
+    struct node* next;
+};
+
+static int helper(int x);
+
+#define DEFINE_FUNCTIONS(n) \
+int f_##n(struct node* l) \
+{ \
+    int s = n; \
+    for (; l != NULL; l = l->next) \
+    { \
+        if (l->value % (n + 1) == 0) \
+            s += helper(l->value); \
+        else \
+            s -= l->value; \
+    } \
+    return s; \
+} \
+struct type_##n { int a[n + 1]; }; \
+static double g_##n(struct type_##n* t) \
+{ \
+    static int calls = 0; \
+    calls++; \
+    return t->a[n] * 0.5 + calls; \
+}
+
+DEFINE_FUNCTIONS(0)
+DEFINE_FUNCTIONS(1)
+DEFINE_FUNCTIONS(2)
+DEFINE_FUNCTIONS(3)
+DEFINE_FUNCTIONS(4)
+DEFINE_FUNCTIONS(5)
+DEFINE_FUNCTIONS(6)
+DEFINE_FUNCTIONS(7)
+DEFINE_FUNCTIONS(8)
+DEFINE_FUNCTIONS(9)
+DEFINE_FUNCTIONS(10)
+DEFINE_FUNCTIONS(11)
+DEFINE_FUNCTIONS(12)
+DEFINE_FUNCTIONS(13)
+DEFINE_FUNCTIONS(14)
+DEFINE_FUNCTIONS(15)
+
+static int helper(int x)
+{
+    return x * 2;
+}
+
+double use_all(struct type_15* t)
+{
+    return g_15(t) + f_0(NULL);
+}
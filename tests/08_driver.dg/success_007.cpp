@@ -0,0 +1,73 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --codegen-jobs=4"
+</testinfo>
+*/
+// Function definitions in namespaces, member functions and template
+// specializations are emitted by several workers and merged back in order
+namespace N
+{
+    template <typename T>
+    struct Box
+    {
+        T value;
+        T get() const { return value; }
+        void set(const T& t);
+    };
+
+    template <typename T>
+    void Box<T>::set(const T& t)
+    {
+        value = t;
+    }
+
+    template <typename T>
+    int weight(const T&)
+    {
+        return 0;
+    }
+}
+
+#define DEFINE_FUNCTIONS(n) \
+namespace N \
+{ \
+    struct A_##n \
+    { \
+        int x; \
+        int twice() const; \
+    }; \
+    int A_##n::twice() const \
+    { \
+        return 2 * x + n; \
+    } \
+    template <> \
+    int weight<A_##n>(const A_##n& a) \
+    { \
+        return a.twice(); \
+    } \
+} \
+int f_##n(int k) \
+{ \
+    N::Box<int> b; \
+    b.set(k + n); \
+    N::A_##n a = { b.get() }; \
+    return N::weight(a); \
+}
+
+DEFINE_FUNCTIONS(0)
+DEFINE_FUNCTIONS(1)
+DEFINE_FUNCTIONS(2)
+DEFINE_FUNCTIONS(3)
+DEFINE_FUNCTIONS(4)
+DEFINE_FUNCTIONS(5)
+DEFINE_FUNCTIONS(6)
+DEFINE_FUNCTIONS(7)
+DEFINE_FUNCTIONS(8)
+DEFINE_FUNCTIONS(9)
+DEFINE_FUNCTIONS(10)
+DEFINE_FUNCTIONS(11)
+
+int main()
+{
+    return f_0(1) + f_11(2) - 39;
+}
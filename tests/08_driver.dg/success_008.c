@@ -0,0 +1,30 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --codegen-jobs=4 --debug-flags=codegen_jobs_fail"
+</testinfo>
+*/
+// Every worker fails, so the file is emitted again sequentially
+struct point
+{
+    int x, y;
+};
+
+static int dot(struct point a, struct point b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+int norm2(struct point p)
+{
+    return dot(p, p);
+}
+
+int area(struct point a, struct point b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+int perimeter(struct point a, struct point b)
+{
+    return 2 * (a.x + a.y + b.x + b.y);
+}
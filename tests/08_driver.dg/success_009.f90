@@ -0,0 +1,32 @@
+! <testinfo>
+! test_generator="config/mercurium-compare-output --debug-flags=fortran_split_after_codegen"
+! test_FFLAGS="--width=40"
+! </testinfo>
+
+! Long lines are split while emitting them and the result must be the same
+! as splitting the whole output once codegen has finished
+MODULE LONG_LINES
+    IMPLICIT NONE
+    INTEGER, PARAMETER :: FIRST_PARAMETER = 1, SECOND_PARAMETER = 2, THIRD_PARAMETER = 3
+    CHARACTER(LEN=*), PARAMETER :: MESSAGE = "This string literal is long enough to be split in several lines"
+CONTAINS
+    FUNCTION WEIGHTED_SUM(FIRST_VALUE, SECOND_VALUE, THIRD_VALUE, FOURTH_VALUE) RESULT(TOTAL)
+        INTEGER, INTENT(IN) :: FIRST_VALUE, SECOND_VALUE, THIRD_VALUE, FOURTH_VALUE
+        INTEGER :: TOTAL
+
+        TOTAL = FIRST_VALUE * FIRST_PARAMETER + SECOND_VALUE * SECOND_PARAMETER + THIRD_VALUE * THIRD_PARAMETER + FOURTH_VALUE
+    END FUNCTION WEIGHTED_SUM
+END MODULE LONG_LINES
+
+PROGRAM MAIN
+    USE LONG_LINES
+    IMPLICIT NONE
+    INTEGER :: ARRAY_WITH_A_LONG_NAME(10), I
+
+    DO I = 1, 10
+        ARRAY_WITH_A_LONG_NAME(I) = WEIGHTED_SUM(I, I + 1, I + 2, I + 3) + WEIGHTED_SUM(I - 1, I - 2, I - 3, I - 4)
+    END DO
+
+    IF (ARRAY_WITH_A_LONG_NAME(1) /= WEIGHTED_SUM(1, 2, 3, 4) + WEIGHTED_SUM(0, -1, -2, -3)) STOP 1
+    PRINT *, MESSAGE, " and this one is appended to it in the same statement", ARRAY_WITH_A_LONG_NAME(10)
+END PROGRAM MAIN
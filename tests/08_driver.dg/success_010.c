@@ -0,0 +1,46 @@
+/*
+<testinfo>
+test_generator="config/mercurium-codegen-stats"
+</testinfo>
+*/
+// Gathering codegen statistics does not change the output and every byte of
+// it is accounted
+#include <stdio.h>
+
+struct point
+{
+    int x, y;
+    double w[4];
+};
+
+enum color { RED, GREEN = 4, BLUE };
+
+static int sum(struct point *p, int n)
+{
+    int i, s = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (p[i].x > p[i].y)
+            s += p[i].x * 3 - (p[i].y >> 2);
+        else
+            s -= (int)(p[i].w[i % 4] / 2.5);
+    }
+    return s;
+}
+
+int main(int argc, char *argv[])
+{
+    struct point p[2] = { { 1, 2, { 0.5, 1.5 } }, { .x = 3, .y = 1 } };
+    enum color c = argc > 1 ? BLUE : RED;
+
+    switch (c)
+    {
+        case RED:
+            printf("%d\n", sum(p, 2));
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+<testinfo>
+test_generator="config/mercurium-codegen-stats"
+</testinfo>
+*/
+// Templates and classes are partly emitted into temporary strings, which are
+// accounted to the node that copies them into the output
+namespace N
+{
+    template <typename T>
+    struct Box
+    {
+        T value;
+        T get() const { return value; }
+        void set(const T& t);
+    };
+
+    template <typename T>
+    void Box<T>::set(const T& t)
+    {
+        value = t;
+    }
+
+    struct A
+    {
+        int x;
+        A() : x(1) { }
+        virtual ~A() { }
+        virtual int f() const { return x; }
+    };
+
+    struct B : A
+    {
+        int f() const { return x + 1; }
+    };
+}
+
+int main()
+{
+    N::Box<int> b;
+    b.set(3);
+
+    N::B obj;
+    const N::A& a = obj;
+
+    return b.get() + a.f() - 5;
+}
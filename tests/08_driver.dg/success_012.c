@@ -0,0 +1,41 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-jobs --jobs=4"
+</testinfo>
+*/
+// Translation units compiled in parallel processes emit the same sources as
+// when they are compiled one after the other
+#include <stdlib.h>
+
+struct list
+{
+    int value;
+    struct list *next;
+};
+
+static struct list *push(struct list *l, int value)
+{
+    struct list *n = malloc(sizeof(*n));
+    n->value = value;
+    n->next = l;
+    return n;
+}
+
+int sum_list(int n)
+{
+    struct list *l = NULL;
+    int i, s = 0;
+
+    for (i = 0; i < n; i++)
+        l = push(l, i);
+
+    while (l != NULL)
+    {
+        struct list *next = l->next;
+        s += l->value;
+        free(l);
+        l = next;
+    }
+
+    return s;
+}
@@ -0,0 +1,23 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-jobs --native-jobs=2"
+</testinfo>
+*/
+// Native compilations run in background while the next files are compiled,
+// and all of them must have finished when the driver exits
+struct matrix
+{
+    double m[4][4];
+};
+
+void multiply(const struct matrix *a, const struct matrix *b, struct matrix *c)
+{
+    int i, j, k;
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < 4; j++)
+        {
+            c->m[i][j] = 0;
+            for (k = 0; k < 4; k++)
+                c->m[i][j] += a->m[i][k] * b->m[k][j];
+        }
+}
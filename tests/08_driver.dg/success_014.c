@@ -0,0 +1,28 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --profile-phases=%TMPDIR%/trace.json"
+</testinfo>
+*/
+// Profiling the compiler phases does not change the output
+struct node
+{
+    int key;
+    struct node *left, *right;
+};
+
+struct node *find(struct node *n, int key)
+{
+    while (n != 0 && n->key != key)
+        n = (key < n->key) ? n->left : n->right;
+    return n;
+}
+
+int depth(const struct node *n)
+{
+    int l, r;
+    if (n == 0)
+        return 0;
+    l = depth(n->left);
+    r = depth(n->right);
+    return 1 + (l > r ? l : r);
+}
@@ -0,0 +1,49 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+</testinfo>
+*/
+// The output is several times larger than a chunk of the codegen buffer, so
+// statements are split across chunk boundaries
+#include <stdlib.h>
+
+#define S(i) s += a[(i) % 16] * (i) - (a[((i) + 3) % 16] >> 1);
+#define S4(i) S(i) S((i) + 1) S((i) + 2) S((i) + 3)
+#define S16(i) S4(i) S4((i) + 4) S4((i) + 8) S4((i) + 12)
+#define S64(i) S16(i) S16((i) + 16) S16((i) + 32) S16((i) + 48)
+#define S256(i) S64(i) S64((i) + 64) S64((i) + 128) S64((i) + 192)
+#define S1024(i) S256(i) S256((i) + 256) S256((i) + 512) S256((i) + 768)
+
+static long unrolled(const int *a)
+{
+    long s = 0;
+    S1024(0)
+    S1024(1024)
+    S1024(2048)
+    S1024(3072)
+    return s;
+}
+
+static long rolled(const int *a)
+{
+    long s = 0;
+    int i;
+    for (i = 0; i < 4096; i++)
+    {
+        s += a[i % 16] * i - (a[(i + 3) % 16] >> 1);
+    }
+    return s;
+}
+
+int main(int argc, char *argv[])
+{
+    int a[16];
+    int i;
+    for (i = 0; i < 16; i++)
+        a[i] = i * 7 - 20;
+
+    if (unrolled(a) != rolled(a))
+        abort();
+
+    return 0;
+}
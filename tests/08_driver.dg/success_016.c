@@ -0,0 +1,16 @@
+/*
+<testinfo>
+test_generator="config/mercurium-compare-output --result-cache-dir=%TMPDIR%/cache"
+</testinfo>
+*/
+// Compiling this file emits a warning, so its result is not stored in the
+// result cache and the second run emits the warning again
+int f(int x)
+{
+    return g(x) + 1;
+}
+
+int g(int x)
+{
+    return 2 * x;
+}